@@ -1,8 +1,93 @@
 #pragma once
 
+#include <cstring>
+#include <type_traits>
+
+#include "Ranges.h"
+#include "Metaprogramming.h"
+
 // Common algorithms operating on ranges
 namespace mu
 {
+	namespace details
+	{
+		template<typename RANGE>
+		using RangeElementType = std::remove_reference_t<decltype(std::declval<RANGE&>().Front())>;
+
+		// Pairs of contiguous ranges which can be copied with memcpy instead of per-element construction
+		template<typename DEST_RANGE, typename SOURCE_RANGE, typename = void>
+		struct IsBitwiseCopyable : std::false_type {};
+
+		template<typename DEST_RANGE, typename SOURCE_RANGE>
+		struct IsBitwiseCopyable<DEST_RANGE, SOURCE_RANGE,
+			std::enable_if_t<ranges::IsContiguousRange<DEST_RANGE>::value && ranges::IsContiguousRange<SOURCE_RANGE>::value>>
+			: std::integral_constant<bool,
+				std::is_same<RangeElementType<DEST_RANGE>, std::remove_const_t<RangeElementType<SOURCE_RANGE>>>::value
+				&& std::is_trivially_copyable<RangeElementType<DEST_RANGE>>::value>
+		{
+		};
+
+		template<typename DEST_RANGE, typename SOURCE_RANGE, typename = void>
+		struct IsBitwiseRelocatable : std::false_type {};
+
+		template<typename DEST_RANGE, typename SOURCE_RANGE>
+		struct IsBitwiseRelocatable<DEST_RANGE, SOURCE_RANGE,
+			std::enable_if_t<ranges::IsContiguousRange<DEST_RANGE>::value && ranges::IsContiguousRange<SOURCE_RANGE>::value>>
+			: std::integral_constant<bool,
+				std::is_same<RangeElementType<DEST_RANGE>, RangeElementType<SOURCE_RANGE>>::value
+				&& meta::IsTriviallyRelocatable<RangeElementType<DEST_RANGE>>::value>
+		{
+		};
+
+		template<typename DEST_RANGE, typename SOURCE_RANGE>
+		DEST_RANGE MemCopy(DEST_RANGE dest, SOURCE_RANGE source)
+		{
+			const size_t num = dest.Size() < source.Size() ? dest.Size() : source.Size();
+			if (num > 0)
+			{
+				memcpy(dest.Data(), source.Data(), sizeof(RangeElementType<DEST_RANGE>) * num);
+			}
+			dest.AdvanceBy(num);
+			return dest;
+		}
+
+		template<typename DEST_RANGE, typename SOURCE_RANGE>
+		DEST_RANGE MoveConstruct(DEST_RANGE dest, SOURCE_RANGE source, std::true_type)
+		{
+			return MemCopy(dest, source);
+		}
+
+		template<typename DEST_RANGE, typename SOURCE_RANGE>
+		DEST_RANGE MoveConstruct(DEST_RANGE dest, SOURCE_RANGE source, std::false_type)
+		{
+			typedef std::remove_reference<decltype(dest.Front())>::type ELEMENT_TYPE;
+			for (; !dest.IsEmpty() && !source.IsEmpty(); dest.Advance(), source.Advance())
+			{
+				new(&dest.Front()) ELEMENT_TYPE(std::move(source.Front()));
+			}
+			return dest;
+		}
+
+		template<typename DEST_RANGE, typename SOURCE_RANGE>
+		DEST_RANGE RelocateConstruct(DEST_RANGE dest, SOURCE_RANGE source, std::true_type)
+		{
+			return MemCopy(dest, source);
+		}
+
+		template<typename DEST_RANGE, typename SOURCE_RANGE>
+		DEST_RANGE RelocateConstruct(DEST_RANGE dest, SOURCE_RANGE source, std::false_type)
+		{
+			typedef std::remove_reference<decltype(dest.Front())>::type ELEMENT_TYPE;
+			typedef std::remove_reference<decltype(source.Front())>::type SOURCE_TYPE;
+			for (; !dest.IsEmpty() && !source.IsEmpty(); dest.Advance(), source.Advance())
+			{
+				new(&dest.Front()) ELEMENT_TYPE(std::move(source.Front()));
+				source.Front().~SOURCE_TYPE();
+			}
+			return dest;
+		}
+	}
+
 	// Move assign elements from the source to the destination
 	template<typename DEST_RANGE, typename SOURCE_RANGE>
 	auto Move(DEST_RANGE&& in_dest, SOURCE_RANGE&& in_source)
@@ -19,17 +104,24 @@ namespace mu
 	// Move CONSTRUCT elements from the source into the destination.
 	// Assumes the destination is uninitialized or otherwise does not 
 	//	require destructors/assignment operators to be called.
+	// Contiguous ranges of trivially copyable elements are copied with a single memcpy.
 	template<typename DEST_RANGE, typename SOURCE_RANGE>
 	auto MoveConstruct(DEST_RANGE&& in_dest, SOURCE_RANGE&& in_source)
 	{
 		auto dest = Range(std::forward<DEST_RANGE>(in_dest));
 		auto source = Range(std::forward<SOURCE_RANGE>(in_source));
-		typedef std::remove_reference<decltype(dest.Front())>::type ELEMENT_TYPE;
-		for (; !dest.IsEmpty() && !source.IsEmpty(); dest.Advance(), source.Advance())
-		{
-			new(&dest.Front()) ELEMENT_TYPE(std::move(source.Front()));
-		}
-		return dest;
+		return details::MoveConstruct(dest, source, details::IsBitwiseCopyable<decltype(dest), decltype(source)>{});
+	}
+
+	// Move CONSTRUCT elements from the source into the destination and destroy the source elements.
+	// Afterwards the relocated part of the source range is uninitialized.
+	// Contiguous ranges of trivially relocatable elements are moved with a single memcpy.
+	template<typename DEST_RANGE, typename SOURCE_RANGE>
+	auto RelocateConstruct(DEST_RANGE&& in_dest, SOURCE_RANGE&& in_source)
+	{
+		auto dest = Range(std::forward<DEST_RANGE>(in_dest));
+		auto source = Range(std::forward<SOURCE_RANGE>(in_source));
+		return details::RelocateConstruct(dest, source, details::IsBitwiseRelocatable<decltype(dest), decltype(source)>{});
 	}
 
 	template<typename RANGE, typename FUNC>
@@ -0,0 +1,337 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Prototype of an allocator:
+//	class Allocator
+//	{
+//		void* Allocate(size_t size, size_t alignment);
+//		void* Reallocate(void* ptr, size_t old_size, size_t new_size, size_t alignment);
+//		void Free(void* ptr, size_t size);
+//		AllocatorStats GetStats() const;
+//	};
+//
+// Containers hold their allocator by value, so memory resources with state (arenas, pools)
+//	are used through an AllocatorRef which must not outlive the resource.
+
+namespace mu
+{
+	// Counters kept by every allocator so callers can check that a piece of code doesn't allocate
+	struct AllocatorStats
+	{
+		size_t m_num_allocations	= 0;
+		size_t m_num_frees			= 0;
+		size_t m_bytes_in_use		= 0;
+		size_t m_peak_bytes_in_use	= 0;
+
+		void OnAllocate(size_t size)
+		{
+			++m_num_allocations;
+			m_bytes_in_use += size;
+			m_peak_bytes_in_use = m_bytes_in_use > m_peak_bytes_in_use ? m_bytes_in_use : m_peak_bytes_in_use;
+		}
+
+		void OnFree(size_t size)
+		{
+			++m_num_frees;
+			m_bytes_in_use -= size;
+		}
+	};
+
+	namespace details
+	{
+		inline size_t AlignUp(size_t size, size_t alignment)
+		{
+			return (size + alignment - 1) & ~(alignment - 1);
+		}
+
+		inline uint8_t* AlignUp(uint8_t* ptr, size_t alignment)
+		{
+			return reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<uintptr_t>(ptr), alignment));
+		}
+	}
+
+	// The global heap. Stateless, so an Array using it costs nothing extra.
+	class HeapAllocator
+	{
+		struct Counters
+		{
+			std::atomic<size_t> m_num_allocations{ 0 };
+			std::atomic<size_t> m_num_frees{ 0 };
+			std::atomic<size_t> m_bytes_in_use{ 0 };
+			std::atomic<size_t> m_peak_bytes_in_use{ 0 };
+		};
+
+		static Counters& GetCounters()
+		{
+			static Counters counters;
+			return counters;
+		}
+
+		static void OnAllocate(size_t size)
+		{
+			Counters& c = GetCounters();
+			++c.m_num_allocations;
+			size_t in_use = c.m_bytes_in_use += size;
+			size_t peak = c.m_peak_bytes_in_use;
+			while (in_use > peak && !c.m_peak_bytes_in_use.compare_exchange_weak(peak, in_use)) {}
+		}
+
+		static void OnFree(size_t size)
+		{
+			Counters& c = GetCounters();
+			++c.m_num_frees;
+			c.m_bytes_in_use -= size;
+		}
+
+	public:
+		void* Allocate(size_t size, size_t /*alignment*/)
+		{
+			if (size == 0) { return nullptr; }
+			void* ptr = malloc(size);
+			if (!ptr) { throw std::bad_alloc(); }
+			OnAllocate(size);
+			return ptr;
+		}
+
+		void* Reallocate(void* ptr, size_t old_size, size_t new_size, size_t /*alignment*/)
+		{
+			void* new_ptr = realloc(ptr, new_size);
+			if (!new_ptr && new_size > 0) { throw std::bad_alloc(); }
+			if (ptr) { OnFree(old_size); }
+			OnAllocate(new_size);
+			return new_ptr;
+		}
+
+		void Free(void* ptr, size_t size)
+		{
+			if (ptr)
+			{
+				free(ptr);
+				OnFree(size);
+			}
+		}
+
+		// Counters are shared by every user of the heap
+		AllocatorStats GetStats() const
+		{
+			Counters& c = GetCounters();
+			AllocatorStats stats;
+			stats.m_num_allocations = c.m_num_allocations;
+			stats.m_num_frees = c.m_num_frees;
+			stats.m_bytes_in_use = c.m_bytes_in_use;
+			stats.m_peak_bytes_in_use = c.m_peak_bytes_in_use;
+			return stats;
+		}
+	};
+
+	// Bump allocator over a single fixed-size block.
+	// Frees are only reclaimed when they are the most recent allocation, so strictly nested
+	//	(stack-like) lifetimes such as local Arrays reuse memory. Everything else is reclaimed by Reset.
+	class LinearArena
+	{
+		uint8_t* m_start	= nullptr;
+		uint8_t* m_end		= nullptr;
+		uint8_t* m_top		= nullptr;
+		bool m_owns_memory	= false;
+		AllocatorStats m_stats;
+
+	public:
+		explicit LinearArena(size_t capacity)
+			: m_start(static_cast<uint8_t*>(HeapAllocator().Allocate(capacity, alignof(std::max_align_t))))
+			, m_end(m_start + capacity)
+			, m_top(m_start)
+			, m_owns_memory(true)
+		{
+		}
+
+		// Use caller provided memory, e.g. a stack buffer
+		LinearArena(void* buffer, size_t capacity)
+			: m_start(static_cast<uint8_t*>(buffer))
+			, m_end(m_start + capacity)
+			, m_top(m_start)
+		{
+		}
+
+		LinearArena(const LinearArena&) = delete;
+		LinearArena& operator=(const LinearArena&) = delete;
+
+		~LinearArena()
+		{
+			if (m_owns_memory)
+			{
+				HeapAllocator().Free(m_start, m_end - m_start);
+			}
+		}
+
+		void* Allocate(size_t size, size_t alignment)
+		{
+			uint8_t* ptr = details::AlignUp(m_top, alignment);
+			if (ptr + size > m_end) { throw std::bad_alloc(); }
+			m_top = ptr + size;
+			m_stats.OnAllocate(size);
+			return ptr;
+		}
+
+		void* Reallocate(void* ptr, size_t old_size, size_t new_size, size_t alignment)
+		{
+			if (ptr && static_cast<uint8_t*>(ptr) + old_size == m_top && static_cast<uint8_t*>(ptr) + new_size <= m_end)
+			{
+				// Most recent allocation, resize in place
+				m_top = static_cast<uint8_t*>(ptr) + new_size;
+				m_stats.OnFree(old_size);
+				m_stats.OnAllocate(new_size);
+				return ptr;
+			}
+
+			void* new_ptr = Allocate(new_size, alignment);
+			if (ptr)
+			{
+				memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+				m_stats.OnFree(old_size);
+			}
+			return new_ptr;
+		}
+
+		void Free(void* ptr, size_t size)
+		{
+			if (!ptr) { return; }
+			if (static_cast<uint8_t*>(ptr) + size == m_top)
+			{
+				m_top = static_cast<uint8_t*>(ptr);
+			}
+			m_stats.OnFree(size);
+		}
+
+		// Invalidates every allocation made from the arena
+		void Reset()
+		{
+			m_top = m_start;
+			m_stats.m_num_frees = m_stats.m_num_allocations;
+			m_stats.m_bytes_in_use = 0;
+		}
+
+		size_t Capacity() const { return m_end - m_start; }
+		size_t Used() const { return m_top - m_start; }
+
+		AllocatorStats GetStats() const { return m_stats; }
+	};
+
+	// A linear arena for scratch memory which only lives until the end of the frame.
+	// BeginFrame releases everything allocated during the previous frame.
+	class FrameArena : public LinearArena
+	{
+		AllocatorStats m_frame_start_stats;
+		size_t m_peak_frame_used = 0;
+
+	public:
+		explicit FrameArena(size_t capacity) : LinearArena(capacity)
+		{
+		}
+
+		void BeginFrame()
+		{
+			m_peak_frame_used = Used() > m_peak_frame_used ? Used() : m_peak_frame_used;
+			Reset();
+			m_frame_start_stats = GetStats();
+		}
+
+		// Number of allocations made since the last BeginFrame
+		size_t NumFrameAllocations() const { return GetStats().m_num_allocations - m_frame_start_stats.m_num_allocations; }
+
+		// Largest amount of memory used by a single completed frame
+		size_t PeakFrameUsed() const { return m_peak_frame_used; }
+	};
+
+	// Allocator for fixed-size blocks, with O(1) allocate and free through an intrusive free list.
+	// Requests larger than the block size fail, so Arrays using a pool should Reserve up front.
+	class PoolAllocator
+	{
+		uint8_t* m_memory		= nullptr;
+		void* m_free_list		= nullptr;
+		size_t m_block_size		= 0;
+		size_t m_num_blocks		= 0;
+		size_t m_num_free		= 0;
+		AllocatorStats m_stats;
+
+	public:
+		PoolAllocator(size_t block_size, size_t num_blocks)
+			: m_block_size(details::AlignUp(block_size < sizeof(void*) ? sizeof(void*) : block_size, alignof(std::max_align_t)))
+			, m_num_blocks(num_blocks)
+		{
+			m_memory = static_cast<uint8_t*>(HeapAllocator().Allocate(m_block_size * m_num_blocks, alignof(std::max_align_t)));
+			for (size_t i = m_num_blocks; i > 0; --i)
+			{
+				void* block = m_memory + (i - 1) * m_block_size;
+				*static_cast<void**>(block) = m_free_list;
+				m_free_list = block;
+			}
+			m_num_free = m_num_blocks;
+		}
+
+		PoolAllocator(const PoolAllocator&) = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+		~PoolAllocator()
+		{
+			HeapAllocator().Free(m_memory, m_block_size * m_num_blocks);
+		}
+
+		void* Allocate(size_t size, size_t alignment)
+		{
+			if (size > m_block_size || alignment > alignof(std::max_align_t) || !m_free_list)
+			{
+				throw std::bad_alloc();
+			}
+			void* block = m_free_list;
+			m_free_list = *static_cast<void**>(block);
+			--m_num_free;
+			m_stats.OnAllocate(m_block_size);
+			return block;
+		}
+
+		void* Reallocate(void* ptr, size_t /*old_size*/, size_t new_size, size_t alignment)
+		{
+			if (!ptr) { return Allocate(new_size, alignment); }
+			if (new_size > m_block_size) { throw std::bad_alloc(); }
+			return ptr;
+		}
+
+		void Free(void* ptr, size_t /*size*/)
+		{
+			if (!ptr) { return; }
+			*static_cast<void**>(ptr) = m_free_list;
+			m_free_list = ptr;
+			++m_num_free;
+			m_stats.OnFree(m_block_size);
+		}
+
+		size_t BlockSize() const { return m_block_size; }
+		size_t NumFreeBlocks() const { return m_num_free; }
+
+		AllocatorStats GetStats() const { return m_stats; }
+	};
+
+	// Handle for using an arena or pool as a container's allocator
+	template<typename RESOURCE>
+	class AllocatorRef
+	{
+		RESOURCE* m_resource = nullptr;
+
+	public:
+		AllocatorRef() {}
+		AllocatorRef(RESOURCE& resource) : m_resource(&resource) {}
+
+		void* Allocate(size_t size, size_t alignment) { return m_resource->Allocate(size, alignment); }
+		void* Reallocate(void* ptr, size_t old_size, size_t new_size, size_t alignment) { return m_resource->Reallocate(ptr, old_size, new_size, alignment); }
+		void Free(void* ptr, size_t size) { m_resource->Free(ptr, size); }
+		AllocatorStats GetStats() const { return m_resource->GetStats(); }
+
+		RESOURCE* GetResource() const { return m_resource; }
+	};
+}
@@ -2,26 +2,37 @@
 
 #include <initializer_list>
 #include <cstdint>
+#include <cstdlib>
+#include <type_traits>
 
 #include "Ranges.h"
 #include "Algorithms.h"
+#include "Metaprogramming.h"
+#include "Allocators.h"
 
 template<typename T>
 class ArrayView;
 
-template<typename T>
+template<typename T, typename ALLOCATOR = mu::HeapAllocator>
 class Array
 {
 	T* m_data		= nullptr;
 	size_t m_num	= 0;
 	size_t m_max	= 0;
+	ALLOCATOR m_allocator;
 
 public:
 	Array()
 	{
 	}
 
-	Array(std::initializer_list<T> init)
+	explicit Array(ALLOCATOR allocator)
+		: m_allocator(allocator)
+	{
+	}
+
+	Array(std::initializer_list<T> init, ALLOCATOR allocator = ALLOCATOR())
+		: m_allocator(allocator)
 	{
 		InitEmpty(init.size());
 		for (auto&& item : init)
@@ -30,8 +41,9 @@ public:
 		}
 	}
 
-	template<class RANGE>
-	Array(RANGE&& r)
+	template<class RANGE, typename = std::enable_if_t<!std::is_convertible<RANGE, ALLOCATOR>::value>>
+	Array(RANGE&& r, ALLOCATOR allocator = ALLOCATOR())
+		: m_allocator(allocator)
 	{
 		for (auto&& item : r)
 		{
@@ -40,11 +52,12 @@ public:
 	}
 
 	Array(const Array& other)
+		: m_allocator(other.m_allocator)
 	{
-		InitSize(other.m_num);
+		InitEmpty(other.m_num);
 		for (auto&& item : other)
 		{
-			Add(item);
+			AddSafe(item);
 		}
 	}
 
@@ -53,30 +66,39 @@ public:
 		*this = std::forward<Array>(other);
 	}
 
+	// Copies keep their own allocator
 	Array& operator=(const Array& other)
 	{
-		InitEmpty(other.Num());
-		for (const auto& item : other)
+		if (this != &other)
 		{
-			Add(item);
+			Release();
+			InitEmpty(other.Num());
+			for (const auto& item : other)
+			{
+				AddSafe(item);
+			}
 		}
 		return *this;
 	}
 
+	// Moves take the other array's allocator along with its storage
 	Array& operator=(Array&& other)
 	{
-		this->~Array();
+		if (this != &other)
+		{
+			Release();
 
-		std::swap(m_data, other.m_data);
-		std::swap(m_num, other.m_num);
-		std::swap(m_max, other.m_max);
+			std::swap(m_data, other.m_data);
+			std::swap(m_num, other.m_num);
+			std::swap(m_max, other.m_max);
+			m_allocator = other.m_allocator;
+		}
 		return *this;
 	}
 
 	~Array()
 	{
-		Destruct(0, m_num);
-		if (m_data) { free(m_data); }
+		Release();
 	}
 
 	void Reserve(size_t new_max)
@@ -87,12 +109,11 @@ public:
 		}
 	}
 
-	static Array MakeUninitialized(size_t num)
+	static Array MakeUninitialized(size_t num, ALLOCATOR allocator = ALLOCATOR())
 	{
-		Array ret{};
-		ret.m_data = (T*)malloc(sizeof(T)* num);
+		Array ret{ allocator };
+		ret.InitEmpty(num);
 		ret.m_num = num;
-		ret.m_max = num;
 		return std::move(ret);
 	}
 
@@ -172,6 +193,13 @@ public:
 		Append(mu::Range(items, count));
 	}
 
+	// Destroy all elements, keeping the current storage
+	void Clear()
+	{
+		Destruct(0, m_num);
+		m_num = 0;
+	}
+
 	T& operator[](size_t index)
 	{
 		return m_data[index];
@@ -185,6 +213,8 @@ public:
 	T* Data() { return m_data; }
 	const T* Data() const { return m_data; }
 
+	const ALLOCATOR& GetAllocator() const { return m_allocator; }
+
 	size_t Num() const { return m_num; }
 	size_t Max() const { return m_max; }
 	bool IsEmpty() const { return m_num == 0; }
@@ -210,11 +240,22 @@ public:
 private:
 	void InitEmpty(size_t num)
 	{
-		m_data = (T*)malloc(sizeof(T) * num);
+		m_data = (T*)m_allocator.Allocate(sizeof(T) * num, alignof(T));
 		m_num = 0;
 		m_max = num;
 	}
 
+	// Destroy all elements and give the storage back to the allocator
+	void Release()
+	{
+		if (!m_data) { return; }
+		Destruct(0, m_num);
+		m_allocator.Free(m_data, sizeof(T) * m_max);
+		m_data = nullptr;
+		m_num = 0;
+		m_max = 0;
+	}
+
 	void EnsureSpace(size_t num)
 	{
 		if (num > m_max)
@@ -225,10 +266,23 @@ private:
 
 	void Grow(size_t new_size)
 	{
-		T* new_data = (T*)malloc(sizeof(T) * new_size);
+		Grow(new_size, mu::meta::IsTriviallyRelocatable<T>{});
+	}
+
+	// Trivially relocatable elements move along with the allocation
+	void Grow(size_t new_size, std::true_type)
+	{
+		m_data = (T*)m_allocator.Reallocate(m_data, sizeof(T) * m_max, sizeof(T) * new_size, alignof(T));
+		m_max = new_size;
+	}
+
+	void Grow(size_t new_size, std::false_type)
+	{
+		T* new_data = (T*)m_allocator.Allocate(sizeof(T) * new_size, alignof(T));
 		auto from = mu::Range(m_data, m_num);
 		auto to = mu::Range(new_data, m_num);
-		mu::MoveConstruct(to, from);
+		mu::RelocateConstruct(to, from);
+		if (m_data) { m_allocator.Free(m_data, sizeof(T) * m_max); }
 		m_data = new_data;
 		m_max = new_size;
 	}
@@ -0,0 +1,482 @@
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define MU_ASYNC_FILE_READER_IO_URING 1
+#else
+#define MU_ASYNC_FILE_READER_IO_URING 0
+#endif
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "AsyncFileReader.h"
+#include "FileReader.h"
+#include "ThreadPool.h"
+
+#if MU_ASYNC_FILE_READER_IO_URING
+
+namespace
+{
+	// Minimal io_uring wrapper over the raw syscalls, only what reading files needs
+	class IoUring
+	{
+		int m_fd = -1;
+		void* m_sq_ring = nullptr;
+		size_t m_sq_ring_size = 0;
+		void* m_cq_ring = nullptr;
+		size_t m_cq_ring_size = 0;
+		io_uring_sqe* m_sqes = nullptr;
+		size_t m_sqes_size = 0;
+
+		unsigned* m_sq_tail = nullptr;
+		unsigned* m_sq_mask = nullptr;
+		unsigned* m_sq_array = nullptr;
+		unsigned* m_cq_head = nullptr;
+		unsigned* m_cq_tail = nullptr;
+		unsigned* m_cq_mask = nullptr;
+		io_uring_cqe* m_cqes = nullptr;
+
+		unsigned m_num_unsubmitted = 0;
+
+	public:
+		IoUring() {}
+		IoUring(const IoUring&) = delete;
+		IoUring& operator=(const IoUring&) = delete;
+
+		~IoUring()
+		{
+			if (m_sqes) { munmap(m_sqes, m_sqes_size); }
+			if (m_cq_ring && m_cq_ring != m_sq_ring) { munmap(m_cq_ring, m_cq_ring_size); }
+			if (m_sq_ring) { munmap(m_sq_ring, m_sq_ring_size); }
+			if (m_fd >= 0) { close(m_fd); }
+		}
+
+		// Fails when the kernel is too old or io_uring is disabled
+		bool Init(unsigned entries)
+		{
+			io_uring_params params;
+			memset(&params, 0, sizeof(params));
+			m_fd = int(syscall(__NR_io_uring_setup, entries, &params));
+			if (m_fd < 0)
+			{
+				return false;
+			}
+
+			m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (single_mmap)
+			{
+				m_sq_ring_size = m_sq_ring_size > m_cq_ring_size ? m_sq_ring_size : m_cq_ring_size;
+			}
+
+			void* sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+			if (sq_ring == MAP_FAILED)
+			{
+				return false;
+			}
+			m_sq_ring = sq_ring;
+
+			if (single_mmap)
+			{
+				m_cq_ring = m_sq_ring;
+			}
+			else
+			{
+				void* cq_ring = mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+				if (cq_ring == MAP_FAILED)
+				{
+					return false;
+				}
+				m_cq_ring = cq_ring;
+			}
+
+			m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+			void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+			if (sqes == MAP_FAILED)
+			{
+				return false;
+			}
+			m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+			uint8_t* sq = static_cast<uint8_t*>(m_sq_ring);
+			m_sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+			m_sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+			m_sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+			uint8_t* cq = static_cast<uint8_t*>(m_cq_ring);
+			m_cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+			m_cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+			m_cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+			m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+			return true;
+		}
+
+		// The caller keeps the number of reads in flight below the ring size
+		void QueueRead(int fd, iovec* iov, uint64_t offset, void* user_data)
+		{
+			const unsigned tail = *m_sq_tail;
+			const unsigned index = tail & *m_sq_mask;
+			io_uring_sqe& sqe = m_sqes[index];
+			memset(&sqe, 0, sizeof(sqe));
+			sqe.opcode = IORING_OP_READV;
+			sqe.fd = fd;
+			sqe.addr = reinterpret_cast<uint64_t>(iov);
+			sqe.len = 1;
+			sqe.off = offset;
+			sqe.user_data = reinterpret_cast<uint64_t>(user_data);
+			m_sq_array[index] = index;
+
+			// The kernel must see the entry before the new tail
+			__atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+			++m_num_unsubmitted;
+		}
+
+		// Submit queued reads and wait for at least min_complete completions
+		void SubmitAndWait(unsigned min_complete)
+		{
+			for (;;)
+			{
+				const long result = syscall(__NR_io_uring_enter, m_fd, m_num_unsubmitted, min_complete, IORING_ENTER_GETEVENTS, nullptr, 0);
+				if (result >= 0)
+				{
+					m_num_unsubmitted -= unsigned(result);
+					return;
+				}
+				if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					throw std::runtime_error("io_uring_enter failed");
+				}
+			}
+		}
+
+		// FUNC(void* user_data, int result), result is bytes read or a negative errno
+		template<typename FUNC>
+		void Reap(FUNC&& func)
+		{
+			unsigned head = *m_cq_head;
+			const unsigned tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+			for (; head != tail; ++head)
+			{
+				const io_uring_cqe& cqe = m_cqes[head & *m_cq_mask];
+				func(reinterpret_cast<void*>(cqe.user_data), cqe.res);
+			}
+			// Hand the entries back only after they have been read
+			__atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+		}
+	};
+}
+
+#endif
+
+struct AsyncFileReader::Impl
+{
+	struct Request
+	{
+		std::string m_path;
+		Callback m_on_complete;
+		Array<uint8_t> m_data;
+		size_t m_offset = 0;
+#if MU_ASYNC_FILE_READER_IO_URING
+		int m_fd = -1;
+		iovec m_iov;
+#endif
+	};
+
+	size_t m_queue_depth;
+	std::mutex m_mutex;
+	std::condition_variable m_idle;
+	size_t m_num_outstanding = 0;
+
+	mu::TaskGroup m_group;
+	std::unique_ptr<mu::ThreadPool> m_pool;
+
+#if MU_ASYNC_FILE_READER_IO_URING
+	IoUring m_ring;
+	bool m_use_ring = false;
+	bool m_stop = false;
+	std::condition_variable m_wake;
+	std::deque<std::unique_ptr<Request>> m_pending;
+	std::thread m_thread;
+#endif
+
+	explicit Impl(size_t queue_depth)
+		: m_queue_depth(queue_depth > 0 ? queue_depth : 1)
+	{
+#if MU_ASYNC_FILE_READER_IO_URING
+		m_use_ring = m_ring.Init(unsigned(m_queue_depth));
+		if (m_use_ring)
+		{
+			m_thread = std::thread([this]() { RingLoop(); });
+			return;
+		}
+#endif
+		// Blocking reads mostly wait on the disk, a few threads is enough to keep it busy
+		const size_t max_threads = 8;
+		m_pool.reset(new mu::ThreadPool(m_queue_depth < max_threads ? m_queue_depth : max_threads));
+	}
+
+	~Impl()
+	{
+#if MU_ASYNC_FILE_READER_IO_URING
+		if (m_use_ring)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_one();
+			m_thread.join();
+		}
+#endif
+	}
+
+	bool IsUsingIoUring() const
+	{
+#if MU_ASYNC_FILE_READER_IO_URING
+		return m_use_ring;
+#else
+		return false;
+#endif
+	}
+
+	void Submit(const char* path, Callback on_complete)
+	{
+#if MU_ASYNC_FILE_READER_IO_URING
+		if (m_use_ring)
+		{
+			std::unique_ptr<Request> request{ new Request };
+			request->m_path = path;
+			request->m_on_complete = std::move(on_complete);
+
+			bool was_empty;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				++m_num_outstanding;
+				was_empty = m_pending.empty();
+				m_pending.push_back(std::move(request));
+			}
+			// The ring thread takes the whole queue at once, so only the first read of a batch wakes it
+			if (was_empty)
+			{
+				m_wake.notify_one();
+			}
+			return;
+		}
+#endif
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++m_num_outstanding;
+		}
+
+		m_pool->Run(m_group, [this, file_path = std::string(path), on_complete]()
+		{
+			Array<uint8_t> data;
+			std::string error;
+			try
+			{
+				data = LoadFileToArray(file_path.c_str());
+			}
+			catch (const std::exception& e)
+			{
+				error = e.what();
+			}
+			on_complete(std::move(data), error.empty() ? nullptr : error.c_str());
+			Finished();
+		});
+	}
+
+	void WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this]() { return m_num_outstanding == 0; });
+	}
+
+	void Finished()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		FinishedLocked(1);
+	}
+
+	void FinishedLocked(size_t count)
+	{
+		m_num_outstanding -= count;
+		if (count > 0 && m_num_outstanding == 0)
+		{
+			m_idle.notify_all();
+		}
+	}
+
+#if MU_ASYNC_FILE_READER_IO_URING
+	// The ring thread counts completed reads and reports them once per loop, see RingLoop
+	void Complete(std::unique_ptr<Request> request, const char* error)
+	{
+		if (request->m_fd >= 0) { close(request->m_fd); }
+		if (error) { request->m_data = Array<uint8_t>(); }
+		request->m_on_complete(std::move(request->m_data), error);
+	}
+
+	void QueueRead(Request& request)
+	{
+		// A single read is capped by the kernel at just under 2GB, larger files take several
+		const size_t max_read = size_t(1) << 30;
+		const size_t remaining = request.m_data.Num() - request.m_offset;
+		request.m_iov.iov_base = request.m_data.Data() + request.m_offset;
+		request.m_iov.iov_len = remaining < max_read ? remaining : max_read;
+		m_ring.QueueRead(request.m_fd, &request.m_iov, request.m_offset, &request);
+	}
+
+	// Opening is synchronous, returns false if the request completed without a read
+	bool StartRead(std::unique_ptr<Request>& request)
+	{
+		request->m_fd = open(request->m_path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (request->m_fd < 0)
+		{
+			Complete(std::move(request), "Failed to open file");
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(request->m_fd, &info) != 0)
+		{
+			Complete(std::move(request), "Failed to get file size");
+			return false;
+		}
+
+		request->m_data = Array<uint8_t>::MakeUninitialized(size_t(info.st_size));
+		if (request->m_data.Num() == 0)
+		{
+			Complete(std::move(request), nullptr);
+			return false;
+		}
+
+		QueueRead(*request);
+		request.release();
+		return true;
+	}
+
+	void RingLoop()
+	{
+		size_t num_in_flight = 0;
+		size_t num_completed = 0;
+		std::deque<std::unique_ptr<Request>> starting;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				FinishedLocked(num_completed);
+				num_completed = 0;
+				if (num_in_flight == 0)
+				{
+					m_wake.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+					if (m_pending.empty())
+					{
+						return;
+					}
+				}
+				while (!m_pending.empty() && num_in_flight + starting.size() < m_queue_depth)
+				{
+					starting.push_back(std::move(m_pending.front()));
+					m_pending.pop_front();
+				}
+			}
+
+			for (std::unique_ptr<Request>& request : starting)
+			{
+				if (StartRead(request))
+				{
+					++num_in_flight;
+				}
+				else
+				{
+					++num_completed;
+				}
+			}
+			starting.clear();
+			if (num_in_flight == 0)
+			{
+				continue;
+			}
+
+			m_ring.SubmitAndWait(1);
+			m_ring.Reap([this, &num_in_flight, &num_completed](void* user_data, int result)
+			{
+				Request* request = static_cast<Request*>(user_data);
+				if (result > 0)
+				{
+					request->m_offset += size_t(result);
+					if (request->m_offset < request->m_data.Num())
+					{
+						QueueRead(*request);
+						return;
+					}
+				}
+
+				--num_in_flight;
+				++num_completed;
+				const char* error = result < 0 ? "Failed to read file" : result == 0 ? "Unexpected end of file" : nullptr;
+				Complete(std::unique_ptr<Request>(request), error);
+			});
+		}
+	}
+#endif
+};
+
+AsyncFileReader::AsyncFileReader(size_t queue_depth)
+	: m_impl(new Impl(queue_depth))
+{
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+	WaitIdle();
+}
+
+void AsyncFileReader::Read(const char* path, Callback on_complete)
+{
+	m_impl->Submit(path, std::move(on_complete));
+}
+
+std::future<Array<uint8_t>> AsyncFileReader::Read(const char* path)
+{
+	// std::function needs a copyable callback, so the promise is shared
+	auto promise = std::make_shared<std::promise<Array<uint8_t>>>();
+	std::future<Array<uint8_t>> future = promise->get_future();
+	Read(path, [promise](Array<uint8_t>&& data, const char* error)
+	{
+		if (error)
+		{
+			promise->set_exception(std::make_exception_ptr(std::runtime_error(error)));
+		}
+		else
+		{
+			promise->set_value(std::move(data));
+		}
+	});
+	return future;
+}
+
+void AsyncFileReader::WaitIdle()
+{
+	m_impl->WaitIdle();
+}
+
+bool AsyncFileReader::IsUsingIoUring() const
+{
+	return m_impl->IsUsingIoUring();
+}
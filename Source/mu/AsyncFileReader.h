@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+
+#include "Array.h"
+
+// Loads whole files in the background so a batch of reads can be issued at once and
+//	overlapped with other startup work.
+// On Linux the reads go through an io_uring serviced by one I/O thread, so the whole batch is in
+//	flight together without a thread per read. Elsewhere, or when the kernel won't create a ring,
+//	each read is a blocking LoadFileToArray on a small pool of I/O threads.
+class AsyncFileReader
+{
+public:
+	// Called on an I/O thread once the file is loaded, error is null on success.
+	// Callbacks must not throw.
+	typedef std::function<void(Array<uint8_t>&& data, const char* error)> Callback;
+
+	// At most queue_depth reads are in flight at once, more wait in a queue
+	explicit AsyncFileReader(size_t queue_depth = 64);
+	AsyncFileReader(const AsyncFileReader&) = delete;
+	AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+	// Finishes all submitted reads
+	~AsyncFileReader();
+
+	void Read(const char* path, Callback on_complete);
+
+	// get() throws std::runtime_error if the file couldn't be read
+	std::future<Array<uint8_t>> Read(const char* path);
+
+	// Block until every submitted read has completed
+	void WaitIdle();
+
+	bool IsUsingIoUring() const;
+
+private:
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+};
@@ -0,0 +1,384 @@
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+#include <codecvt>
+#include <locale>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "BinaryLog.h"
+#include "Array.h"
+
+// File layout, all records 8 byte aligned:
+//	FileHeader
+//	Record { uint32_t size, uint32_t kind } followed by
+//		SiteRecord: uint32_t id, line, file length, format length, then the file and format strings
+//		MessageRecord: uint32_t site id, argument count, uint64_t ticks since open, then the
+//			arguments in the mu::dbg::details::EncodeArgs format
+// The size of a record is written last, the rest of the file is zero so a zero size ends the log.
+
+namespace
+{
+	using mu::dbg::details::LogArg;
+	using mu::dbg::details::LogArgType;
+
+	const char BinaryLogMagic[8] = { 'M', 'U', 'L', 'O', 'G', 0, 0, 1 };
+
+	struct FileHeader
+	{
+		char m_magic[8];
+		uint64_t m_tick_num;	// seconds per tick as a fraction
+		uint64_t m_tick_den;
+	};
+
+	enum class RecordKind : uint32_t
+	{
+		Site = 1,
+		Message = 2,
+	};
+
+	struct RecordHeader
+	{
+		uint32_t m_size;
+		RecordKind m_kind;
+	};
+
+	struct SiteRecord
+	{
+		uint32_t m_id;
+		uint32_t m_line;
+		uint32_t m_file_length;
+		uint32_t m_format_length;
+	};
+
+	struct MessageRecord
+	{
+		uint32_t m_site_id;
+		uint32_t m_num_args;
+		uint64_t m_ticks;
+	};
+
+	size_t AlignRecord(size_t size) { return (size + 7) & ~size_t(7); }
+
+	typedef std::chrono::steady_clock LogClock;
+
+	class BinaryLogWriter
+	{
+		uint8_t* m_data = nullptr;
+		size_t m_capacity = 0;
+		std::atomic<size_t> m_used{ 0 };
+		std::atomic<uint64_t> m_num_dropped{ 0 };
+		uint32_t m_generation = 0;
+		uint32_t m_num_sites = 0;
+		std::mutex m_site_mutex;
+		LogClock::time_point m_start;
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = nullptr;
+#else
+		int m_fd = -1;
+#endif
+
+	public:
+		BinaryLogWriter(uint32_t generation) : m_generation(generation), m_start(LogClock::now()) {}
+		BinaryLogWriter(const BinaryLogWriter&) = delete;
+		BinaryLogWriter& operator=(const BinaryLogWriter&) = delete;
+
+		~BinaryLogWriter()
+		{
+			const size_t used = m_used.load() < m_capacity ? m_used.load() : m_capacity;
+#ifdef _WIN32
+			if (m_data) { UnmapViewOfFile(m_data); }
+			if (m_mapping) { CloseHandle(m_mapping); }
+			if (m_file != INVALID_HANDLE_VALUE)
+			{
+				LARGE_INTEGER end;
+				end.QuadPart = LONGLONG(used);
+				SetFilePointerEx(m_file, end, nullptr, FILE_BEGIN);
+				SetEndOfFile(m_file);
+				CloseHandle(m_file);
+			}
+#else
+			if (m_data) { munmap(m_data, m_capacity); }
+			if (m_fd >= 0)
+			{
+				if (ftruncate(m_fd, off_t(used)) != 0) {}
+				close(m_fd);
+			}
+#endif
+		}
+
+		bool Open(const char* path, size_t capacity)
+		{
+			m_capacity = AlignRecord(capacity > sizeof(FileHeader) ? capacity : sizeof(FileHeader));
+#ifdef _WIN32
+			std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert{};
+			std::wstring wide_path = convert.from_bytes(path);
+			m_file = CreateFile(wide_path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (m_file == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+			// Mapping past the end of the file extends it with zeroes
+			const uint64_t size = m_capacity;
+			m_mapping = CreateFileMapping(m_file, nullptr, PAGE_READWRITE, DWORD(size >> 32), DWORD(size), nullptr);
+			if (!m_mapping)
+			{
+				return false;
+			}
+			m_data = static_cast<uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, m_capacity));
+			if (!m_data)
+			{
+				return false;
+			}
+#else
+			m_fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			if (m_fd < 0 || ftruncate(m_fd, off_t(m_capacity)) != 0)
+			{
+				return false;
+			}
+			void* data = mmap(nullptr, m_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+			if (data == MAP_FAILED)
+			{
+				return false;
+			}
+			m_data = static_cast<uint8_t*>(data);
+#endif
+
+			FileHeader header;
+			memcpy(header.m_magic, BinaryLogMagic, sizeof(BinaryLogMagic));
+			header.m_tick_num = uint64_t(LogClock::period::num);
+			header.m_tick_den = uint64_t(LogClock::period::den);
+			memcpy(m_data, &header, sizeof(header));
+			m_used = AlignRecord(sizeof(header));
+			return true;
+		}
+
+		uint32_t GetGeneration() const { return m_generation; }
+		uint64_t GetNumDropped() const { return m_num_dropped.load(std::memory_order_relaxed); }
+
+		// Returns the site's id in this log
+		uint32_t RegisterSite(mu::dbg::LogSite& site, const char* format)
+		{
+			std::lock_guard<std::mutex> lock(m_site_mutex);
+			const uint64_t key = site.m_binary_id.load(std::memory_order_acquire);
+			if ((key >> 32) == m_generation)
+			{
+				return uint32_t(key);
+			}
+
+			SiteRecord record;
+			record.m_id = ++m_num_sites;
+			record.m_line = site.m_line;
+			record.m_file_length = uint32_t(strlen(site.m_file));
+			record.m_format_length = uint32_t(strlen(format));
+
+			// Holding the lock keeps site records in id order in the file
+			const size_t size = sizeof(RecordHeader) + sizeof(record) + record.m_file_length + record.m_format_length;
+			uint8_t* out = Reserve(size);
+			if (out)
+			{
+				memcpy(out + sizeof(RecordHeader), &record, sizeof(record));
+				memcpy(out + sizeof(RecordHeader) + sizeof(record), site.m_file, record.m_file_length);
+				memcpy(out + sizeof(RecordHeader) + sizeof(record) + record.m_file_length, format, record.m_format_length);
+				Commit(out, size, RecordKind::Site);
+			}
+
+			site.m_binary_id.store((uint64_t(m_generation) << 32) | record.m_id, std::memory_order_release);
+			return record.m_id;
+		}
+
+		void WriteMessage(uint32_t site_id, const LogArg* args, size_t count)
+		{
+			MessageRecord record;
+			record.m_site_id = site_id;
+			record.m_num_args = uint32_t(count);
+			record.m_ticks = uint64_t((LogClock::now() - m_start).count());
+
+			const size_t size = sizeof(RecordHeader) + sizeof(record) + mu::dbg::details::EncodedSize(args, count);
+			uint8_t* out = Reserve(size);
+			if (out)
+			{
+				memcpy(out + sizeof(RecordHeader), &record, sizeof(record));
+				mu::dbg::details::EncodeArgs(out + sizeof(RecordHeader) + sizeof(record), args, count);
+				Commit(out, size, RecordKind::Message);
+			}
+		}
+
+	private:
+		// Claims space for a record, any number of threads can write records at once
+		uint8_t* Reserve(size_t size)
+		{
+			const size_t aligned_size = AlignRecord(size);
+			const size_t offset = m_used.fetch_add(aligned_size, std::memory_order_relaxed);
+			if (offset + aligned_size > m_capacity)
+			{
+				m_num_dropped.fetch_add(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+			return m_data + offset;
+		}
+
+		static void Commit(uint8_t* out, size_t size, RecordKind kind)
+		{
+			const RecordHeader header = { uint32_t(AlignRecord(size)), kind };
+			memcpy(out + sizeof(header.m_size), &header.m_kind, sizeof(header.m_kind));
+			std::atomic_thread_fence(std::memory_order_release);
+			memcpy(out, &header.m_size, sizeof(header.m_size));
+		}
+	};
+
+	std::atomic<BinaryLogWriter*> s_binary_log{ nullptr };
+	uint32_t s_binary_log_generation = 0;
+
+	// Checks the encoded arguments fit in [encoded, end) before they are formatted
+	bool ValidateEncodedArgs(const uint8_t* encoded, const uint8_t* end, uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (end - encoded < 1) { return false; }
+			const LogArgType type = LogArgType(*encoded++);
+			size_t size = sizeof(uint64_t);
+			if (type == LogArgType::C_Str)
+			{
+				uint32_t length;
+				if (size_t(end - encoded) < sizeof(length)) { return false; }
+				memcpy(&length, encoded, sizeof(length));
+				size = sizeof(length) + length;
+			}
+			else if (type != LogArgType::Unsigned && type != LogArgType::Signed
+				&& type != LogArgType::Float && type != LogArgType::Pointer)
+			{
+				return false;
+			}
+			if (size_t(end - encoded) < size) { return false; }
+			encoded += size;
+		}
+		return true;
+	}
+
+	struct DecodedSite
+	{
+		std::string m_file;
+		uint32_t m_line;
+		std::string m_format;
+	};
+}
+
+bool mu::dbg::OpenBinaryLog(const char* path, size_t capacity)
+{
+	CloseBinaryLog();
+	std::unique_ptr<BinaryLogWriter> log{ new BinaryLogWriter(++s_binary_log_generation) };
+	if (!log->Open(path, capacity))
+	{
+		return false;
+	}
+	s_binary_log.store(log.release(), std::memory_order_release);
+	return true;
+}
+
+void mu::dbg::CloseBinaryLog()
+{
+	delete s_binary_log.exchange(nullptr);
+}
+
+uint64_t mu::dbg::GetNumDroppedBinaryLogs()
+{
+	BinaryLogWriter* log = s_binary_log.load(std::memory_order_acquire);
+	return log ? log->GetNumDropped() : 0;
+}
+
+bool mu::dbg::details::WriteBinaryLog(LogSite& site, const char* format, const LogArg* args, size_t count)
+{
+	BinaryLogWriter* log = s_binary_log.load(std::memory_order_acquire);
+	if (!log)
+	{
+		return false;
+	}
+
+	const uint64_t key = site.m_binary_id.load(std::memory_order_acquire);
+	const uint32_t site_id = (key >> 32) == log->GetGeneration() ? uint32_t(key) : log->RegisterSite(site, format);
+	log->WriteMessage(site_id, args, count);
+	return true;
+}
+
+bool mu::dbg::DecodeBinaryLog(ranges::PointerRange<const uint8_t> data, const std::function<void(const DecodedLogMessage&)>& func)
+{
+	FileHeader header;
+	if (data.Size() < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, data.Data(), sizeof(header));
+	if (memcmp(header.m_magic, BinaryLogMagic, sizeof(BinaryLogMagic)) != 0 || header.m_tick_den == 0)
+	{
+		return false;
+	}
+	const double seconds_per_tick = double(header.m_tick_num) / double(header.m_tick_den);
+
+	Array<DecodedSite> sites;
+	DecodedLogMessage message;
+	const uint8_t* end = data.Data() + data.Size();
+	for (const uint8_t* pos = data.Data() + AlignRecord(sizeof(header)); size_t(end - pos) >= sizeof(RecordHeader);)
+	{
+		RecordHeader record_header;
+		memcpy(&record_header, pos, sizeof(record_header));
+		if (record_header.m_size < sizeof(RecordHeader) || record_header.m_size > size_t(end - pos))
+		{
+			break;
+		}
+		const uint8_t* body = pos + sizeof(RecordHeader);
+		const uint8_t* record_end = pos + record_header.m_size;
+		pos = record_end;
+
+		if (record_header.m_kind == RecordKind::Site)
+		{
+			SiteRecord site;
+			if (size_t(record_end - body) < sizeof(site)) { break; }
+			memcpy(&site, body, sizeof(site));
+			const char* strings = reinterpret_cast<const char*>(body + sizeof(site));
+			if (site.m_id != sites.Num() + 1
+				|| size_t(record_end - body) - sizeof(site) < size_t(site.m_file_length) + site.m_format_length)
+			{
+				break;
+			}
+			sites.Add(DecodedSite{ std::string(strings, site.m_file_length), site.m_line, std::string(strings + site.m_file_length, site.m_format_length) });
+		}
+		else if (record_header.m_kind == RecordKind::Message)
+		{
+			MessageRecord record;
+			if (size_t(record_end - body) < sizeof(record)) { break; }
+			memcpy(&record, body, sizeof(record));
+			const uint8_t* args = body + sizeof(record);
+			if (record.m_site_id == 0 || record.m_site_id > sites.Num() || !ValidateEncodedArgs(args, record_end, record.m_num_args))
+			{
+				break;
+			}
+
+			const DecodedSite& site = sites[record.m_site_id - 1];
+			message.m_seconds = double(record.m_ticks) * seconds_per_tick;
+			message.m_file = site.m_file;
+			message.m_line = site.m_line;
+			message.m_text.clear();
+			details::FormatEncodedArgs(message.m_text, site.m_format.c_str(), args, record.m_num_args);
+			func(message);
+		}
+		else
+		{
+			break;
+		}
+	}
+	return true;
+}
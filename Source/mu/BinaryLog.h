@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "Debug.h"
+#include "Ranges.h"
+
+// Compact binary log for long sessions, written by MU_LOG while it is open.
+// The first call from each MU_LOG site writes the site's file, line and format string, after that
+//	a call only appends the site id, a timestamp and the raw arguments to a memory mapped file.
+// Turn the file back into text with DecodeBinaryLog or the mu_log_decoder tool.
+namespace mu
+{
+	namespace dbg
+	{
+		// The file is capacity bytes while open, messages past that are dropped and counted.
+		// Open and close while no other thread is logging, i.e. during startup and shutdown.
+		bool OpenBinaryLog(const char* path, size_t capacity = 256 * 1024 * 1024);
+
+		// Trims the file to the messages written
+		void CloseBinaryLog();
+
+		uint64_t GetNumDroppedBinaryLogs();
+
+		struct DecodedLogMessage
+		{
+			double m_seconds;	// since the log was opened
+			std::string m_file;
+			uint32_t m_line;
+			std::string m_text;
+		};
+
+		// Calls func for every complete message in a binary log file's contents.
+		// Returns false if the data isn't a binary log, decoding stops at the first damaged record.
+		bool DecodeBinaryLog(ranges::PointerRange<const uint8_t> data, const std::function<void(const DecodedLogMessage&)>& func);
+
+		namespace details
+		{
+			// Returns false if no binary log is open
+			bool WriteBinaryLog(LogSite& site, const char* format, const LogArg* args, size_t count);
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#include "CommandRecorder.h"
+
+mu::vk::ParallelCommandRecorder::ParallelCommandRecorder(VkDevice device, uint32_t queue_family, uint32_t num_sets,
+	VkCommandPoolCreateFlags pool_flags, uint32_t num_slices, ThreadPool& thread_pool)
+	: m_device(device)
+	, m_num_slices(num_slices > 0 ? num_slices : uint32_t(thread_pool.NumThreads() + 1))
+	, m_thread_pool(&thread_pool)
+{
+	VkCommandPoolCreateInfo pool_info = {
+		VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		nullptr,
+		pool_flags,
+		queue_family
+	};
+
+	m_slices.Reserve(num_sets * m_num_slices);
+	for (uint32_t i = 0; i < num_sets * m_num_slices; ++i)
+	{
+		m_slices.Emplace();
+		Slice& slice = m_slices[i];
+		slice.m_pool = CommandPool{ device, nullptr };
+		if (vkCreateCommandPool(device, &pool_info, nullptr, slice.m_pool.Replace()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create command pool");
+		}
+
+		VkCommandBufferAllocateInfo alloc_info = {
+			VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			nullptr,
+			slice.m_pool,
+			VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+			1
+		};
+		if (vkAllocateCommandBuffers(device, &alloc_info, &slice.m_buffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate command buffers");
+		}
+	}
+	m_execute.Reserve(m_num_slices);
+}
+
+void mu::vk::ParallelCommandRecorder::Reset(uint32_t set)
+{
+	// Resetting the whole pool is cheaper than resetting its buffers one at a time
+	for (uint32_t slice = 0; slice < m_num_slices; ++slice)
+	{
+		if (vkResetCommandPool(m_device, m_slices[set * m_num_slices + slice].m_pool, 0) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to reset command pool");
+		}
+	}
+}
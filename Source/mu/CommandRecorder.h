@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <stdexcept>
+
+#include "Array.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include "VulkanTools.h"
+
+namespace mu
+{
+	namespace vk
+	{
+		// Records the draws of a render pass from several threads at once. The draws are split into
+		//	slices, each recorded into a secondary command buffer by a task on the thread pool, and the
+		//	primary command buffer executes them in slice order.
+		// A command pool may only be used by one thread at a time, so every slice has its own pool.
+		// Each set of slices has its own pools and buffers, so one set can be recorded while the
+		//	GPU still executes another, such as one set per swapchain image or frame in flight.
+		class ParallelCommandRecorder
+		{
+			struct Slice
+			{
+				CommandPool m_pool;
+				VkCommandBuffer m_buffer = nullptr;
+				VkResult m_result = VK_SUCCESS;
+			};
+
+			VkDevice m_device = nullptr;
+			Array<Slice> m_slices;	// indexed by set * m_num_slices + slice
+			Array<VkCommandBuffer> m_execute;
+			uint32_t m_num_slices = 0;
+			ThreadPool* m_thread_pool = nullptr;
+
+		public:
+			ParallelCommandRecorder() {}
+
+			// By default there is a slice for each pool thread and one for the thread calling Record.
+			// pool_flags are given to every slice's command pool, such as TRANSIENT when sets are re-recorded each frame.
+			ParallelCommandRecorder(VkDevice device, uint32_t queue_family, uint32_t num_sets, VkCommandPoolCreateFlags pool_flags = 0,
+				uint32_t num_slices = 0, ThreadPool& thread_pool = ThreadPool::Default());
+
+			ParallelCommandRecorder(ParallelCommandRecorder&&) = default;
+			ParallelCommandRecorder& operator=(ParallelCommandRecorder&&) = default;
+			ParallelCommandRecorder(const ParallelCommandRecorder&) = delete;
+			ParallelCommandRecorder& operator=(const ParallelCommandRecorder&) = delete;
+
+			uint32_t NumSlices() const { return m_num_slices; }
+
+			// Resets the command pools of the set, which must not be executing on the GPU, so it can be recorded again
+			void Reset(uint32_t set);
+
+			// Calls func(command_buffer, begin, end) to record each slice of [0, num_items) into the set's
+			//	secondary command buffers, then executes them from primary. primary must be in the given
+			//	subpass of a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+			// usage is added to the secondary buffers' flags, pass SIMULTANEOUS_USE if primary uses it.
+			// func is called concurrently from several threads and must not throw.
+			template<typename FUNC>
+			void Record(VkCommandBuffer primary, uint32_t set, VkRenderPass render_pass, uint32_t subpass,
+				VkFramebuffer framebuffer, VkCommandBufferUsageFlags usage, size_t num_items, FUNC&& func)
+			{
+				MU_PROFILE_ZONE("ParallelCommandRecorder::Record");
+				const uint32_t num_used = num_items < m_num_slices ? uint32_t(num_items) : m_num_slices;
+				const VkCommandBufferInheritanceInfo inheritance_info = {
+					VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+					nullptr,
+					render_pass,
+					subpass,
+					framebuffer,
+					VK_FALSE, 0, 0
+				};
+				const VkCommandBufferBeginInfo begin_info = {
+					VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+					nullptr,
+					usage | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+					&inheritance_info
+				};
+
+				auto record_slice = [&](uint32_t slice)
+				{
+					MU_PROFILE_ZONE("RecordSlice");
+					Slice& s = m_slices[set * m_num_slices + slice];
+					s.m_result = vkBeginCommandBuffer(s.m_buffer, &begin_info);
+					if (s.m_result == VK_SUCCESS)
+					{
+						func(s.m_buffer, num_items * slice / num_used, num_items * (slice + 1) / num_used);
+						s.m_result = vkEndCommandBuffer(s.m_buffer);
+					}
+				};
+
+				// Capture only two words so the task fits in std::function without a heap allocation
+				TaskGroup group;
+				for (uint32_t slice = 1; slice < num_used; ++slice)
+				{
+					m_thread_pool->Run(group, [&record_slice, slice]() { record_slice(slice); });
+				}
+				if (num_used > 0)
+				{
+					record_slice(0);
+				}
+				m_thread_pool->Wait(group);
+
+				m_execute.Clear();
+				for (uint32_t slice = 0; slice < num_used; ++slice)
+				{
+					const Slice& s = m_slices[set * m_num_slices + slice];
+					if (s.m_result != VK_SUCCESS)
+					{
+						throw std::runtime_error("Failed to record secondary command buffer");
+					}
+					m_execute.Add(s.m_buffer);
+				}
+				if (num_used > 0)
+				{
+					vkCmdExecuteCommands(primary, num_used, m_execute.Data());
+				}
+			}
+		};
+	}
+}
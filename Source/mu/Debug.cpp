@@ -1,30 +1,412 @@
 #include "Debug.h"
+#include "BinaryLog.h"
 
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
 #include <Windows.h>
-#include <sstream>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using mu::dbg::details::LogArg;
+	using mu::dbg::details::LogArgType;
+
+	const size_t LogBufferSize = 64 * 1024;
+	const size_t MaxLogStringLength = 4096;
+	const std::chrono::milliseconds FlushInterval{ 10 };
+
+	// Records are a uint32_t size and argument count, the format string if any, then the encoded
+	//	arguments. Records are 8 byte aligned and never wrap around the end of the buffer, the space
+	//	left at the end is skipped with a padding record which only has the size and count.
+	const size_t RecordHeaderSize = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+	const uint32_t PaddingRecord = UINT32_MAX;
+
+	size_t AlignRecord(size_t size) { return (size + 7) & ~size_t(7); }
+
+	// Single producer single consumer byte ring, written by one logging thread and read by the
+	//	logger thread. Positions increase forever and are wrapped on access.
+	struct LogBuffer
+	{
+		std::atomic<size_t> m_write{ 0 };
+		std::atomic<size_t> m_read{ 0 };
+		std::atomic<bool> m_retired{ false };
+		alignas(8) uint8_t m_data[LogBufferSize];
+	};
+
+	class Logger
+	{
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_flushed;
+		std::vector<std::unique_ptr<LogBuffer>> m_buffers;
+		std::atomic<uint64_t> m_num_dropped{ 0 };
+		uint64_t m_num_dropped_reported = 0;
+		uint64_t m_flush_requested = 0;
+		uint64_t m_flush_completed = 0;
+		bool m_to_stderr = true;
+		FILE* m_file = nullptr;
+		bool m_stop = false;
+		std::thread m_thread;
+
+	public:
+		Logger()
+		{
+			m_thread = std::thread([this]() { WriterLoop(); });
+		}
+
+		~Logger()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+			m_thread.join();
+			if (m_file) { fclose(m_file); }
+		}
+
+		static Logger& Get()
+		{
+			static Logger logger;
+			return logger;
+		}
+
+		LogBuffer* AddBuffer()
+		{
+			std::unique_ptr<LogBuffer> buffer{ new LogBuffer };
+			LogBuffer* result = buffer.get();
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_buffers.push_back(std::move(buffer));
+			return result;
+		}
+
+		void Push(LogBuffer& buffer, const char* format, const LogArg* args, size_t count)
+		{
+			const size_t size = AlignRecord(RecordHeaderSize + mu::dbg::details::EncodedSize(args, count));
+
+			// Only this thread writes, so free space can only grow while we fill it
+			const size_t write = buffer.m_write.load(std::memory_order_relaxed);
+			const size_t read = buffer.m_read.load(std::memory_order_acquire);
+			const size_t space_to_end = LogBufferSize - write % LogBufferSize;
+			const size_t padding = space_to_end < size ? space_to_end : 0;
+			if (padding + size > LogBufferSize - (write - read))
+			{
+				m_num_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			if (padding > 0)
+			{
+				const uint32_t padding_header[2] = { uint32_t(padding), PaddingRecord };
+				memcpy(buffer.m_data + write % LogBufferSize, padding_header, sizeof(padding_header));
+			}
+
+			uint8_t* record = buffer.m_data + (write + padding) % LogBufferSize;
+			const uint32_t header[2] = { uint32_t(size), uint32_t(count) };
+			const uint64_t format_bits = reinterpret_cast<uintptr_t>(format);
+			memcpy(record, header, sizeof(header));
+			memcpy(record + sizeof(header), &format_bits, sizeof(format_bits));
+			mu::dbg::details::EncodeArgs(record + RecordHeaderSize, args, count);
+			buffer.m_write.store(write + padding + size, std::memory_order_release);
+		}
+
+		void Flush()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			const uint64_t target = ++m_flush_requested;
+			m_wake.notify_all();
+			m_flushed.wait(lock, [this, target]() { return m_flush_completed >= target; });
+		}
+
+		uint64_t GetNumDropped() const { return m_num_dropped.load(std::memory_order_relaxed); }
+
+		void SetToStderr(bool enabled)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_to_stderr = enabled;
+		}
+
+		void SetFile(const char* path)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_file) { fclose(m_file); }
+			m_file = path ? fopen(path, "ab") : nullptr;
+		}
+
+	private:
+		// Format every complete record in the buffer onto out
+		static void Drain(LogBuffer& buffer, std::string& out)
+		{
+			size_t read = buffer.m_read.load(std::memory_order_relaxed);
+			const size_t write = buffer.m_write.load(std::memory_order_acquire);
+			while (read != write)
+			{
+				const uint8_t* record = buffer.m_data + read % LogBufferSize;
+				uint32_t header[2];
+				memcpy(header, record, sizeof(header));
+				if (header[1] != PaddingRecord)
+				{
+					uint64_t format_bits;
+					memcpy(&format_bits, record + sizeof(header), sizeof(format_bits));
+					const char* format = reinterpret_cast<const char*>(uintptr_t(format_bits));
+					mu::dbg::details::FormatEncodedArgs(out, format, record + RecordHeaderSize, header[1]);
+					out += '\n';
+				}
+				read += header[0];
+			}
+			buffer.m_read.store(read, std::memory_order_release);
+		}
+
+		void Output(const std::string& text)
+		{
+			if (text.empty()) { return; }
+			if (m_to_stderr)
+			{
+				fwrite(text.data(), 1, text.size(), stderr);
+#ifdef _WIN32
+				OutputDebugStringA(text.c_str());
+#endif
+			}
+			if (m_file)
+			{
+				fwrite(text.data(), 1, text.size(), m_file);
+				fflush(m_file);
+			}
+		}
+
+		void WriterLoop()
+		{
+			std::vector<LogBuffer*> buffers;
+			std::string text;
+			std::unique_lock<std::mutex> lock(m_mutex);
+			for (;;)
+			{
+				const uint64_t flush_target = m_flush_requested;
+				const bool stopping = m_stop;
+
+				// Buffers are only removed by this thread, so they stay valid while unlocked
+				buffers.clear();
+				for (const std::unique_ptr<LogBuffer>& buffer : m_buffers)
+				{
+					buffers.push_back(buffer.get());
+				}
+				lock.unlock();
+
+				text.clear();
+				for (LogBuffer* buffer : buffers)
+				{
+					Drain(*buffer, text);
+				}
+				const uint64_t num_dropped = m_num_dropped.load(std::memory_order_relaxed);
+				if (num_dropped != m_num_dropped_reported)
+				{
+					text += "Log buffer full, dropped " + std::to_string(num_dropped - m_num_dropped_reported) + " messages\n";
+					m_num_dropped_reported = num_dropped;
+				}
+
+				lock.lock();
+				Output(text);
+
+				// A buffer whose thread has exited is freed once it has been drained,
+				//	retired is set after the thread's last write so an empty buffer stays empty
+				for (size_t i = 0; i < m_buffers.size();)
+				{
+					LogBuffer& buffer = *m_buffers[i];
+					if (buffer.m_retired.load(std::memory_order_acquire)
+						&& buffer.m_read.load(std::memory_order_relaxed) == buffer.m_write.load(std::memory_order_acquire))
+					{
+						m_buffers[i] = std::move(m_buffers.back());
+						m_buffers.pop_back();
+					}
+					else
+					{
+						++i;
+					}
+				}
+
+				m_flush_completed = flush_target;
+				m_flushed.notify_all();
+				if (stopping)
+				{
+					return;
+				}
+				m_wake.wait_for(lock, FlushInterval, [this, flush_target]() { return m_stop || m_flush_requested != flush_target; });
+			}
+		}
+	};
+
+	// Marks the thread's buffer retired when the thread exits
+	struct ThreadLogBuffer
+	{
+		LogBuffer* m_buffer = nullptr;
+
+		~ThreadLogBuffer()
+		{
+			if (m_buffer) { m_buffer->m_retired.store(true, std::memory_order_release); }
+		}
+	};
+}
+
+static void PushToThreadBuffer(const char* format, const LogArg* args, size_t count)
+{
+	Logger& logger = Logger::Get();
+	static thread_local ThreadLogBuffer thread_buffer;
+	if (!thread_buffer.m_buffer)
+	{
+		thread_buffer.m_buffer = logger.AddBuffer();
+	}
+	logger.Push(*thread_buffer.m_buffer, format, args, count);
+}
 
 void mu::dbg::LogInternal(const details::LogArg* args, size_t count)
 {
-	std::wostringstream o;
+	PushToThreadBuffer(nullptr, args, count);
+}
 
-	for (size_t i =0; i < count; ++i)
+void mu::dbg::LogInternal(LogSite& site, const char* format, const details::LogArg* args, size_t count)
+{
+	if (!details::WriteBinaryLog(site, format, args, count))
 	{
-		switch (args->m_type)
+		PushToThreadBuffer(format, args, count);
+	}
+}
+
+void mu::dbg::FlushLog()
+{
+	Logger::Get().Flush();
+}
+
+uint64_t mu::dbg::GetNumDroppedLogs()
+{
+	return Logger::Get().GetNumDropped();
+}
+
+void mu::dbg::SetLogToStderr(bool enabled)
+{
+	Logger::Get().SetToStderr(enabled);
+}
+
+void mu::dbg::SetLogFile(const char* path)
+{
+	Logger::Get().SetFile(path);
+}
+
+static size_t StringLength(const char* str)
+{
+	if (!str) { return 0; }
+	const size_t length = strlen(str);
+	return length < MaxLogStringLength ? length : MaxLogStringLength;
+}
+
+size_t mu::dbg::details::EncodedSize(const LogArg* args, size_t count)
+{
+	size_t size = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		size += 1 + (args[i].m_type == LogArgType::C_Str ? sizeof(uint32_t) + StringLength(args[i].m_c_str) : sizeof(uint64_t));
+	}
+	return size;
+}
+
+uint8_t* mu::dbg::details::EncodeArgs(uint8_t* out, const LogArg* args, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		*out++ = uint8_t(args[i].m_type);
+		if (args[i].m_type == LogArgType::C_Str)
 		{
-		case details::LogArgType::C_Str:
-			o << args->m_c_str;
-			break;
-		case details::LogArgType::Unsigned:
-			o << args->m_uint;
-			break;
-		default:
-			throw new std::runtime_error("Invalid argument type to log");
+			const uint32_t length = uint32_t(StringLength(args[i].m_c_str));
+			memcpy(out, &length, sizeof(length));
+			memcpy(out + sizeof(length), args[i].m_c_str, length);
+			out += sizeof(length) + length;
 		}
+		else
+		{
+			// Every other member of the union is 8 bytes or a pointer, which is widened
+			uint64_t bits = args[i].m_uint;
+			if (args[i].m_type == LogArgType::Pointer)
+			{
+				bits = reinterpret_cast<uintptr_t>(args[i].m_ptr);
+			}
+			memcpy(out, &bits, sizeof(bits));
+			out += sizeof(bits);
+		}
+	}
+	return out;
+}
 
-		++args;
+static const uint8_t* FormatEncodedArg(std::string& out, const uint8_t* encoded)
+{
+	const LogArgType type = LogArgType(*encoded++);
+	if (type == LogArgType::C_Str)
+	{
+		uint32_t length;
+		memcpy(&length, encoded, sizeof(length));
+		out.append(reinterpret_cast<const char*>(encoded + sizeof(length)), length);
+		return encoded + sizeof(length) + length;
 	}
 
-	o << std::endl;
+	uint64_t bits;
+	memcpy(&bits, encoded, sizeof(bits));
+	char text[32];
+	switch (type)
+	{
+	case LogArgType::Unsigned:
+		snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(bits));
+		break;
+	case LogArgType::Signed:
+		snprintf(text, sizeof(text), "%lld", static_cast<long long>(bits));
+		break;
+	case LogArgType::Float:
+	{
+		double value;
+		memcpy(&value, &bits, sizeof(value));
+		snprintf(text, sizeof(text), "%g", value);
+		break;
+	}
+	case LogArgType::Pointer:
+		snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(bits));
+		break;
+	default:
+		snprintf(text, sizeof(text), "<invalid log argument>");
+		break;
+	}
+	out += text;
+	return encoded + sizeof(bits);
+}
 
-	OutputDebugStringW(o.str().c_str());
+const uint8_t* mu::dbg::details::FormatEncodedArgs(std::string& out, const char* format, const uint8_t* encoded, size_t count)
+{
+	size_t next_arg = 0;
+	for (const char* c = format; c && *c; ++c)
+	{
+		if (c[0] == '{' && c[1] == '}' && next_arg < count)
+		{
+			encoded = FormatEncodedArg(out, encoded);
+			++next_arg;
+			++c;
+		}
+		else
+		{
+			out += *c;
+		}
+	}
+	for (; next_arg < count; ++next_arg)
+	{
+		encoded = FormatEncodedArg(out, encoded);
+	}
+	return encoded;
 }
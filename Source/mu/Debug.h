@@ -1,6 +1,10 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 
 namespace mu
 {
@@ -8,10 +12,13 @@ namespace mu
 	{
 		namespace details
 		{
-			enum class LogArgType
+			enum class LogArgType : uint8_t
 			{
 				C_Str,
-				Unsigned
+				Unsigned,
+				Signed,
+				Float,
+				Pointer,	// also dispatchable and 64 bit non-dispatchable Vulkan handles
 			};
 
 			struct LogArg
@@ -21,6 +28,9 @@ namespace mu
 				{
 					const char* m_c_str;
 					uint64_t m_uint;
+					int64_t m_int;
+					double m_float;
+					const void* m_ptr;
 				};
 
 				LogArg(const char* c_str)
@@ -29,8 +39,13 @@ namespace mu
 				{}
 
 				LogArg(int32_t i32)
-					: m_type(LogArgType::Unsigned)
-					, m_uint(i32)
+					: m_type(LogArgType::Signed)
+					, m_int(i32)
+				{}
+
+				LogArg(int64_t i64)
+					: m_type(LogArgType::Signed)
+					, m_int(i64)
 				{}
 
 				LogArg(uint32_t u32)
@@ -42,16 +57,83 @@ namespace mu
 					: m_type(LogArgType::Unsigned)
 					, m_uint(s)
 				{}
+
+				LogArg(double d)
+					: m_type(LogArgType::Float)
+					, m_float(d)
+				{}
+
+				LogArg(const void* ptr)
+					: m_type(LogArgType::Pointer)
+					, m_ptr(ptr)
+				{}
 			};
+
+			// Arguments are stored as a LogArgType byte followed by 8 bytes of value, or for strings
+			//	a uint32_t length and the characters. Shared by the text and binary logs.
+			size_t EncodedSize(const LogArg* args, size_t count);
+			uint8_t* EncodeArgs(uint8_t* out, const LogArg* args, size_t count);
+
+			// Appends the encoded arguments to out, each {} in format is replaced by the next argument
+			//	and any arguments left over are appended. Returns the end of the encoded arguments.
+			const uint8_t* FormatEncodedArgs(std::string& out, const char* format, const uint8_t* encoded, size_t count);
 		}
 
+		// A static log call site, see MU_LOG
+		struct LogSite
+		{
+			const char* m_file;
+			uint32_t m_line;
+			// Identifies the site in the open binary log, 0 until it has been written there
+			std::atomic<uint64_t> m_binary_id;
+
+			constexpr LogSite(const char* file, uint32_t line)
+				: m_file(file), m_line(line), m_binary_id(0)
+			{}
+		};
+
+		// Copies the arguments into a per-thread ring buffer without formatting or allocating,
+		//	a background thread formats and writes them out within about 10ms.
+		// The message is dropped and counted if the buffer is full.
 		void LogInternal(const details::LogArg*, size_t);
-		
+
+		// As above with a format string, written to the binary log instead if one is open
+		void LogInternal(LogSite& site, const char* format, const details::LogArg*, size_t);
+
+		// Block until everything logged so far has been written
+		void FlushLog();
+
+		// Number of messages dropped because their thread's buffer was full
+		uint64_t GetNumDroppedLogs();
+
+		// Log lines go to stderr and, on Windows, the debugger output by default
+		void SetLogToStderr(bool enabled);
+
+		// Additionally append log lines to a file, nullptr closes it
+		void SetLogFile(const char* path);
+
 		template<typename ...ARGS>
 		void Log(ARGS... args)
 		{
 			auto arr = std::array<details::LogArg, sizeof...(args)>{ {details::LogArg(args)...}};
 			LogInternal(arr.data(), arr.size());
 		}
+
+		template<typename ...ARGS>
+		void LogFormat(LogSite& site, const char* format, ARGS... args)
+		{
+			auto arr = std::array<details::LogArg, sizeof...(args)>{ {details::LogArg(args)...}};
+			LogInternal(site, format, arr.data(), arr.size());
+		}
 	}
-}
\ No newline at end of file
+}
+
+// Log with a format string literal, each {} is replaced by the next argument:
+//	MU_LOG("Frame made {} heap allocations", count);
+// With a binary log open the site and format are written once and each call only writes its arguments.
+#define MU_LOG(...) \
+	do \
+	{ \
+		static mu::dbg::LogSite mu_log_site{ __FILE__, __LINE__ }; \
+		mu::dbg::LogFormat(mu_log_site, __VA_ARGS__); \
+	} while (false)
@@ -0,0 +1,216 @@
+#include "DeviceMemory.h"
+
+#include <stdexcept>
+
+void mu::vk::deleters::DeviceAllocation::operator()(DeviceMemoryRange* range, DeviceMemoryAllocator* allocator)
+{
+	allocator->Free(range);
+}
+
+mu::vk::DeviceMemoryAllocator::DeviceMemoryAllocator(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize block_size)
+	: m_device(device)
+	, m_block_size(block_size)
+{
+	vkGetPhysicalDeviceMemoryProperties(physical_device, &m_memory_properties);
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physical_device, &properties);
+	m_non_coherent_atom_size = properties.limits.nonCoherentAtomSize;
+}
+
+mu::vk::DeviceAllocation mu::vk::DeviceMemoryAllocator::Allocate(const VkMemoryRequirements& requirements, ResourceKind kind,
+	VkMemoryPropertyFlags required_flags, VkMemoryPropertyFlags preferred_flags, bool dedicated)
+{
+	uint32_t memory_type = FindMemoryType(requirements.memoryTypeBits, required_flags | preferred_flags);
+	if (memory_type == UINT32_MAX)
+	{
+		memory_type = FindMemoryType(requirements.memoryTypeBits, required_flags);
+		if (memory_type == UINT32_MAX)
+		{
+			throw std::runtime_error("No suitable memory type");
+		}
+	}
+
+	// Flushes and invalidates of non-coherent memory work in whole atoms, so no two allocations may share one
+	VkDeviceSize alignment = requirements.alignment;
+	VkDeviceSize size = requirements.size;
+	const VkMemoryPropertyFlags type_flags = m_memory_properties.memoryTypes[memory_type].propertyFlags;
+	if ((type_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(type_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+	{
+		alignment = alignment > m_non_coherent_atom_size ? alignment : m_non_coherent_atom_size;
+		size = (size + m_non_coherent_atom_size - 1) & ~(m_non_coherent_atom_size - 1);
+	}
+
+	if (dedicated || size > m_block_size / 2)
+	{
+		DeviceMemory memory;
+		uint8_t* mapped = nullptr;
+		AllocateMemory(memory_type, size, memory, mapped);
+		++m_num_dedicated;
+		m_dedicated_bytes += size;
+		DeviceMemoryRange* range = new DeviceMemoryRange{ memory.Release(), 0, size, mapped, memory_type, DedicatedPool, 0, 0 };
+		return DeviceAllocation{ range, this };
+	}
+
+	const uint32_t pool_index = memory_type * uint32_t(ResourceKind::Count) + uint32_t(kind);
+	Array<Block>& pool = m_pools[pool_index];
+	uint32_t free_slot = UINT32_MAX;
+	for (uint32_t i = 0; i < pool.Num(); ++i)
+	{
+		Block& block = pool[i];
+		if (block.m_memory == VK_NULL_HANDLE)
+		{
+			free_slot = free_slot == UINT32_MAX ? i : free_slot;
+			continue;
+		}
+		const RangeAllocator::Allocation allocation = block.m_ranges.Allocate(size, alignment);
+		if (allocation.m_range != RangeAllocator::InvalidRange)
+		{
+			DeviceMemoryRange* range = new DeviceMemoryRange{ block.m_memory, allocation.m_offset, size,
+				block.m_mapped ? block.m_mapped + allocation.m_offset : nullptr, memory_type, pool_index, i, allocation.m_range };
+			return DeviceAllocation{ range, this };
+		}
+	}
+
+	// No room in any block, start a new one
+	if (free_slot == UINT32_MAX)
+	{
+		free_slot = uint32_t(pool.Emplace());
+	}
+	Block& block = pool[free_slot];
+	AllocateMemory(memory_type, m_block_size, block.m_memory, block.m_mapped);
+	block.m_ranges = RangeAllocator(m_block_size);
+	const RangeAllocator::Allocation allocation = block.m_ranges.Allocate(size, alignment);
+	DeviceMemoryRange* range = new DeviceMemoryRange{ block.m_memory, allocation.m_offset, size,
+		block.m_mapped ? block.m_mapped + allocation.m_offset : nullptr, memory_type, pool_index, free_slot, allocation.m_range };
+	return DeviceAllocation{ range, this };
+}
+
+mu::vk::DeviceAllocation mu::vk::DeviceMemoryAllocator::AllocateForBuffer(VkBuffer buffer,
+	VkMemoryPropertyFlags required_flags, VkMemoryPropertyFlags preferred_flags)
+{
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_device, buffer, &requirements);
+	DeviceAllocation allocation = Allocate(requirements, ResourceKind::Linear, required_flags, preferred_flags);
+	if (vkBindBufferMemory(m_device, buffer, allocation->m_memory, allocation->m_offset) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to bind buffer memory");
+	}
+	return std::move(allocation);
+}
+
+mu::vk::DeviceAllocation mu::vk::DeviceMemoryAllocator::AllocateForImage(VkImage image, VkImageTiling tiling,
+	VkMemoryPropertyFlags required_flags, VkMemoryPropertyFlags preferred_flags)
+{
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(m_device, image, &requirements);
+	const ResourceKind kind = tiling == VK_IMAGE_TILING_LINEAR ? ResourceKind::Linear : ResourceKind::Optimal;
+	const bool dedicated = requirements.size >= m_block_size / 4;
+	DeviceAllocation allocation = Allocate(requirements, kind, required_flags, preferred_flags, dedicated);
+	if (vkBindImageMemory(m_device, image, allocation->m_memory, allocation->m_offset) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to bind image memory");
+	}
+	return std::move(allocation);
+}
+
+void mu::vk::DeviceMemoryAllocator::Free(DeviceMemoryRange* range)
+{
+	if (range->m_pool == DedicatedPool)
+	{
+		vkFreeMemory(m_device, range->m_memory, nullptr);
+		--m_num_dedicated;
+		m_dedicated_bytes -= range->m_size;
+	}
+	else
+	{
+		Array<Block>& pool = m_pools[range->m_pool];
+		Block& block = pool[range->m_block];
+		block.m_ranges.Free(range->m_range);
+
+		// Hand empty blocks back to the driver, but keep one so a pool that empties and refills doesn't thrash
+		if (block.m_ranges.IsEmpty())
+		{
+			uint32_t num_live = 0;
+			for (const Block& b : pool)
+			{
+				num_live += b.m_memory != VK_NULL_HANDLE ? 1 : 0;
+			}
+			if (num_live > 1)
+			{
+				block.m_memory.Reset();
+				block.m_mapped = nullptr;
+			}
+		}
+	}
+	delete range;
+}
+
+mu::vk::DeviceMemoryStats mu::vk::DeviceMemoryAllocator::GetStats() const
+{
+	DeviceMemoryStats stats = {};
+	stats.m_num_dedicated = m_num_dedicated;
+	stats.m_num_allocations = m_num_dedicated;
+	stats.m_bytes_allocated = m_dedicated_bytes;
+	stats.m_bytes_in_use = m_dedicated_bytes;
+
+	VkDeviceSize free_bytes = 0;
+	VkDeviceSize largest_free_bytes = 0;
+	for (const Array<Block>& pool : m_pools)
+	{
+		for (const Block& block : pool)
+		{
+			if (block.m_memory == VK_NULL_HANDLE)
+			{
+				continue;
+			}
+			const VkDeviceSize largest = block.m_ranges.GetLargestFreeRange();
+			++stats.m_num_blocks;
+			stats.m_num_allocations += block.m_ranges.GetNumAllocations();
+			stats.m_bytes_allocated += block.m_ranges.GetSize();
+			stats.m_bytes_in_use += block.m_ranges.GetSize() - block.m_ranges.GetFreeBytes();
+			stats.m_largest_free_range = largest > stats.m_largest_free_range ? largest : stats.m_largest_free_range;
+			free_bytes += block.m_ranges.GetFreeBytes();
+			largest_free_bytes += largest;
+		}
+	}
+	stats.m_fragmentation = free_bytes > 0 ? 1.0f - float(double(largest_free_bytes) / double(free_bytes)) : 0.0f;
+	return stats;
+}
+
+uint32_t mu::vk::DeviceMemoryAllocator::FindMemoryType(uint32_t type_bits, VkMemoryPropertyFlags flags) const
+{
+	for (uint32_t i = 0; i < m_memory_properties.memoryTypeCount; ++i)
+	{
+		if ((type_bits & (1u << i)) && (m_memory_properties.memoryTypes[i].propertyFlags & flags) == flags)
+		{
+			return i;
+		}
+	}
+	return UINT32_MAX;
+}
+
+void mu::vk::DeviceMemoryAllocator::AllocateMemory(uint32_t memory_type, VkDeviceSize size, DeviceMemory& out_memory, uint8_t*& out_mapped)
+{
+	const VkMemoryAllocateInfo alloc_info = {
+		VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+		nullptr,
+		size,
+		memory_type
+	};
+	out_memory = DeviceMemory{ m_device, nullptr };
+	if (vkAllocateMemory(m_device, &alloc_info, nullptr, out_memory.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to allocate device memory");
+	}
+
+	out_mapped = nullptr;
+	if (m_memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		void* mapped = nullptr;
+		if (vkMapMemory(m_device, out_memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to map device memory");
+		}
+		out_mapped = (uint8_t*)mapped;
+	}
+}
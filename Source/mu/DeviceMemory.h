@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "Array.h"
+#include "RangeAllocator.h"
+#include "VulkanTools.h"
+
+namespace mu
+{
+	namespace vk
+	{
+		class DeviceMemoryAllocator;
+
+		// Where a DeviceAllocation lives. Owned by the allocator and valid until the allocation is freed.
+		struct DeviceMemoryRange
+		{
+			VkDeviceMemory m_memory;
+			VkDeviceSize m_offset;
+			VkDeviceSize m_size;
+			uint8_t* m_mapped;	// points at m_offset, nullptr unless the memory type is host visible
+			uint32_t m_memory_type;
+			uint32_t m_pool;	// DedicatedPool if m_memory belongs to this allocation alone
+			uint32_t m_block;
+			uint32_t m_range;
+		};
+
+		namespace deleters
+		{
+			struct DeviceAllocation
+			{
+				void operator()(DeviceMemoryRange* range, DeviceMemoryAllocator* allocator);
+			};
+		}
+
+		class DeviceAllocation : public VkHandle<DeviceMemoryRange*, deleters::DeviceAllocation, DeviceMemoryAllocator*>
+		{
+		public:
+			using VkHandle::VkHandle;
+
+			const DeviceMemoryRange* operator->() const { return m_handle; }
+		};
+
+		struct DeviceMemoryStats
+		{
+			uint32_t m_num_blocks;
+			uint32_t m_num_dedicated;
+			uint32_t m_num_allocations;
+			VkDeviceSize m_bytes_allocated;	// everything allocated from the driver
+			VkDeviceSize m_bytes_in_use;
+			VkDeviceSize m_largest_free_range;
+			float m_fragmentation;	// 0 when each block's free space is one range, towards 1 as it splinters
+		};
+
+		// Allocates device memory from the driver in large blocks and hands out ranges of them, so
+		//	resources don't each pay for vkAllocateMemory or count against maxMemoryAllocationCount.
+		// Blocks are sub-allocated with RangeAllocator. Each memory type has one pool of blocks for
+		//	buffers and linear images and another for optimal images, so neighbouring resources never
+		//	break bufferImageGranularity.
+		// Allocations too big to share a block, or asked to be dedicated, get memory of their own.
+		// Host visible memory is mapped for as long as it is allocated.
+		// Not thread safe. Allocations must be freed before the allocator is destroyed.
+		class DeviceMemoryAllocator
+		{
+		public:
+			static const uint32_t DedicatedPool = UINT32_MAX;
+			static const VkDeviceSize DefaultBlockSize = 64 * 1024 * 1024;
+
+			enum class ResourceKind : uint32_t
+			{
+				Linear,		// buffers and linear images
+				Optimal,	// optimal tiling images
+				Count
+			};
+
+		private:
+			struct Block
+			{
+				DeviceMemory m_memory;
+				RangeAllocator m_ranges;
+				uint8_t* m_mapped = nullptr;
+			};
+
+			VkDevice m_device = nullptr;
+			VkPhysicalDeviceMemoryProperties m_memory_properties;
+			VkDeviceSize m_block_size = 0;
+			VkDeviceSize m_non_coherent_atom_size = 1;
+			// Indexed by memory type * ResourceKind::Count + kind. Empty blocks are freed but keep their
+			//	slot so the indices held by allocations stay put.
+			Array<Block> m_pools[VK_MAX_MEMORY_TYPES * uint32_t(ResourceKind::Count)];
+			uint32_t m_num_dedicated = 0;
+			VkDeviceSize m_dedicated_bytes = 0;
+
+		public:
+			DeviceMemoryAllocator() {}
+			DeviceMemoryAllocator(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize block_size = DefaultBlockSize);
+
+			DeviceMemoryAllocator(const DeviceMemoryAllocator&) = delete;
+			DeviceMemoryAllocator& operator=(const DeviceMemoryAllocator&) = delete;
+
+			// Picks a memory type allowed by requirements with all of required_flags, preferring those
+			//	that also have preferred_flags.
+			// Throws if no memory type fits or the driver is out of memory.
+			DeviceAllocation Allocate(const VkMemoryRequirements& requirements, ResourceKind kind,
+				VkMemoryPropertyFlags required_flags, VkMemoryPropertyFlags preferred_flags = 0, bool dedicated = false);
+
+			// Allocate memory for the resource and bind it
+			DeviceAllocation AllocateForBuffer(VkBuffer buffer, VkMemoryPropertyFlags required_flags, VkMemoryPropertyFlags preferred_flags = 0);
+			// Images of at least a quarter of a block, such as render targets, get dedicated memory
+			DeviceAllocation AllocateForImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags required_flags, VkMemoryPropertyFlags preferred_flags = 0);
+
+			void Free(DeviceMemoryRange* range);
+
+			DeviceMemoryStats GetStats() const;
+
+		private:
+			uint32_t FindMemoryType(uint32_t type_bits, VkMemoryPropertyFlags flags) const;
+			void AllocateMemory(uint32_t memory_type, VkDeviceSize size, DeviceMemory& out_memory, uint8_t*& out_mapped);
+		};
+	}
+}
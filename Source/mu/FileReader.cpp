@@ -1,26 +1,65 @@
+#ifdef _WIN32
 #define VC_EXTRALEAN
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #include <Windows.h>
 
-#include <stdexcept>
 #include <codecvt>
 #include <locale>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 #include "FileReader.h"
 
-FileReader::FileReader(void* handle) : m_handle(handle)
+FileReader::FileReader(FileReader&& other)
 {
+	*this = std::move(other);
 }
 
+FileReader& FileReader::operator=(FileReader&& other)
+{
+	if (this != &other)
+	{
+		Close();
+#ifdef _WIN32
+		std::swap(m_handle, other.m_handle);
+#else
+		std::swap(m_fd, other.m_fd);
+#endif
+	}
+	return *this;
+}
+
+FileReader::~FileReader()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
 FileReader FileReader::Open(const char* path)
 {
 	// TODO: Would rather do this conversion on the stack if possible, or with a custom temp allocator at least
 	std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert{};
 	std::wstring wide_path = convert.from_bytes(path);
 
+	FileReader reader;
 	HANDLE handle = CreateFile(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
-	return FileReader(handle);
+	if (handle != INVALID_HANDLE_VALUE)
+	{
+		reader.m_handle = handle;
+	}
+	return reader;
 }
 
 mu::ranges::PointerRange<uint8_t>  FileReader::Read(mu::ranges::PointerRange<uint8_t> dest_range)
@@ -31,9 +70,13 @@ mu::ranges::PointerRange<uint8_t>  FileReader::Read(mu::ranges::PointerRange<uin
 		uint32_t bytes_read = 0;
 		const uint32_t call_bytes = max_per_call > dest_range.Size() ? uint32_t(dest_range.Size()) : max_per_call;
 		if( !ReadFile(m_handle, static_cast<void*>(&dest_range.Front()), call_bytes, reinterpret_cast<LPDWORD>(&bytes_read), nullptr) )
-		{ 
+		{
 			throw std::runtime_error("ReadFile failed");
 		}
+		if (bytes_read == 0)
+		{
+			throw std::runtime_error("Unexpected end of file");
+		}
 		dest_range.AdvanceBy(bytes_read);
 	}
 	return dest_range;
@@ -46,10 +89,120 @@ int64_t FileReader::GetFileSize() const
 	return size;
 }
 
+void FileReader::Close()
+{
+	if (m_handle) { CloseHandle(m_handle); }
+	m_handle = nullptr;
+}
+
+void SaveFileAtomically(const char* path, mu::ranges::PointerRange<const uint8_t> data)
+{
+	std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert{};
+	std::wstring wide_path = convert.from_bytes(path);
+	std::wstring temp_path = wide_path + L".tmp";
+
+	HANDLE handle = CreateFile(temp_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Failed to create file");
+	}
+	const uint32_t max_per_call = std::numeric_limits<uint32_t>::max();
+	bool ok = true;
+	while (ok && !data.IsEmpty())
+	{
+		DWORD bytes_written = 0;
+		const uint32_t call_bytes = max_per_call > data.Size() ? uint32_t(data.Size()) : max_per_call;
+		ok = WriteFile(handle, &data.Front(), call_bytes, &bytes_written, nullptr) && bytes_written > 0;
+		data.AdvanceBy(bytes_written);
+	}
+	ok = FlushFileBuffers(handle) && ok;
+	CloseHandle(handle);
+	if (!ok || !MoveFileEx(temp_path.c_str(), wide_path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		DeleteFile(temp_path.c_str());
+		throw std::runtime_error("Failed to write file");
+	}
+}
+
+#else
+
+FileReader FileReader::Open(const char* path)
+{
+	FileReader reader;
+	reader.m_fd = open(path, O_RDONLY | O_CLOEXEC);
+	return reader;
+}
+
+mu::ranges::PointerRange<uint8_t>  FileReader::Read(mu::ranges::PointerRange<uint8_t> dest_range)
+{
+	while (!dest_range.IsEmpty())
+	{
+		const ssize_t bytes_read = read(m_fd, &dest_range.Front(), dest_range.Size());
+		if (bytes_read < 0)
+		{
+			if (errno == EINTR) { continue; }
+			throw std::runtime_error("read failed");
+		}
+		if (bytes_read == 0)
+		{
+			throw std::runtime_error("Unexpected end of file");
+		}
+		dest_range.AdvanceBy(size_t(bytes_read));
+	}
+	return dest_range;
+}
+
+int64_t FileReader::GetFileSize() const
+{
+	struct stat info;
+	if (fstat(m_fd, &info) != 0)
+	{
+		return 0;
+	}
+	return int64_t(info.st_size);
+}
+
+void FileReader::Close()
+{
+	if (m_fd >= 0) { close(m_fd); }
+	m_fd = -1;
+}
+
+void SaveFileAtomically(const char* path, mu::ranges::PointerRange<const uint8_t> data)
+{
+	const std::string temp_path = std::string(path) + ".tmp";
+	const int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Failed to create file");
+	}
+	bool ok = true;
+	while (ok && !data.IsEmpty())
+	{
+		const ssize_t bytes_written = write(fd, &data.Front(), data.Size());
+		if (bytes_written < 0 && errno == EINTR) { continue; }
+		ok = bytes_written > 0;
+		if (ok) { data.AdvanceBy(size_t(bytes_written)); }
+	}
+	// The data has to reach the disk before the rename does, or a crash could still expose an empty file
+	ok = fsync(fd) == 0 && ok;
+	ok = close(fd) == 0 && ok;
+	if (!ok || rename(temp_path.c_str(), path) != 0)
+	{
+		unlink(temp_path.c_str());
+		throw std::runtime_error("Failed to write file");
+	}
+}
+
+#endif
 
 Array<uint8_t> LoadFileToArray(const char* path)
 {
 	FileReader reader = FileReader::Open(path);
+	if (!reader.IsValidFile())
+	{
+		throw std::runtime_error("Failed to open file");
+	}
 	auto arr = Array<uint8_t>::MakeUninitialized(reader.GetFileSize());
 	reader.Read(mu::Range(arr));
 	return std::move(arr);
@@ -4,19 +4,40 @@
 
 #include "Array.h"
 
+// Throws std::runtime_error if the file can't be opened or read
 Array<uint8_t> LoadFileToArray(const char* path);
 
+// Writes to a temporary file beside path then renames it over path, so a crash part way through
+//	never leaves a truncated file behind. Throws std::runtime_error on failure.
+void SaveFileAtomically(const char* path, mu::ranges::PointerRange<const uint8_t> data);
+
 class FileReader
 {
+#ifdef _WIN32
 	void* m_handle = nullptr;
+#else
+	int m_fd = -1;
+#endif
 
-	FileReader(void* handle);
+	FileReader() {}
 public:
+	FileReader(const FileReader&) = delete;
+	FileReader& operator=(const FileReader&) = delete;
+	FileReader(FileReader&& other);
+	FileReader& operator=(FileReader&& other);
+	~FileReader();
 
 	static FileReader Open(const char* path);
 
 	mu::ranges::PointerRange<uint8_t> Read(mu::ranges::PointerRange<uint8_t> dest_range);
 
+#ifdef _WIN32
 	bool IsValidFile() const { return m_handle != nullptr; }
+#else
+	bool IsValidFile() const { return m_fd >= 0; }
+#endif
 	int64_t GetFileSize() const;
+
+private:
+	void Close();
 };
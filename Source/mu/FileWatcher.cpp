@@ -0,0 +1,188 @@
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+#include <codecvt>
+#include <locale>
+#else
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+#include "FileWatcher.h"
+
+FileWatcher::FileWatcher()
+{
+}
+
+FileWatcher::FileWatcher(FileWatcher&& other)
+	: m_impl(std::move(other.m_impl))
+{
+}
+
+FileWatcher& FileWatcher::operator=(FileWatcher&& other)
+{
+	m_impl = std::move(other.m_impl);
+	return *this;
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+#ifdef _WIN32
+
+struct FileWatcher::Impl
+{
+	HANDLE m_directory = INVALID_HANDLE_VALUE;
+	OVERLAPPED m_overlapped = {};
+	bool m_pending = false;	// a ReadDirectoryChangesW is waiting for changes
+	DWORD m_buffer[4096];	// FILE_NOTIFY_INFORMATION records, which are DWORD aligned
+
+	~Impl()
+	{
+		if (m_pending)
+		{
+			DWORD bytes = 0;
+			CancelIoEx(m_directory, &m_overlapped);
+			GetOverlappedResult(m_directory, &m_overlapped, &bytes, TRUE);
+		}
+		if (m_overlapped.hEvent) { CloseHandle(m_overlapped.hEvent); }
+		if (m_directory != INVALID_HANDLE_VALUE) { CloseHandle(m_directory); }
+	}
+
+	// Windows only buffers changes once the first read has been issued, and keeps buffering between reads
+	bool BeginRead()
+	{
+		ResetEvent(m_overlapped.hEvent);
+		const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+		m_pending = ReadDirectoryChangesW(m_directory, m_buffer, sizeof(m_buffer), FALSE, filter, nullptr, &m_overlapped, nullptr) != FALSE;
+		return m_pending;
+	}
+};
+
+FileWatcher FileWatcher::Open(const char* directory)
+{
+	std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert{};
+	std::wstring wide_directory = convert.from_bytes(directory);
+
+	std::unique_ptr<Impl> impl{ new Impl };
+	impl->m_directory = CreateFile(wide_directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	impl->m_overlapped.hEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+	FileWatcher watcher;
+	// Read from the start, so changes made before the first Wait are reported
+	if (impl->m_directory != INVALID_HANDLE_VALUE && impl->m_overlapped.hEvent && impl->BeginRead())
+	{
+		watcher.m_impl = std::move(impl);
+	}
+	return watcher;
+}
+
+bool FileWatcher::Wait(uint32_t timeout_ms, Array<std::string>& out_names)
+{
+	Impl& impl = *m_impl;
+	if (!impl.m_pending && !impl.BeginRead())
+	{
+		return false;
+	}
+	if (WaitForSingleObject(impl.m_overlapped.hEvent, timeout_ms) != WAIT_OBJECT_0)
+	{
+		return false;
+	}
+	impl.m_pending = false;
+
+	// No bytes means the buffer overflowed and the changes are lost
+	DWORD bytes = 0;
+	if (!GetOverlappedResult(impl.m_directory, &impl.m_overlapped, &bytes, FALSE) || bytes == 0)
+	{
+		return false;
+	}
+
+	std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert{};
+	bool changed = false;
+	const uint8_t* record = reinterpret_cast<const uint8_t*>(impl.m_buffer);
+	for (;;)
+	{
+		const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(record);
+		if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME)
+		{
+			out_names.AddUnique(convert.to_bytes(info->FileName, info->FileName + info->FileNameLength / sizeof(WCHAR)));
+			changed = true;
+		}
+		if (info->NextEntryOffset == 0)
+		{
+			break;
+		}
+		record += info->NextEntryOffset;
+	}
+	return changed;
+}
+
+#else
+
+struct FileWatcher::Impl
+{
+	int m_fd = -1;
+
+	~Impl()
+	{
+		if (m_fd >= 0) { close(m_fd); }
+	}
+};
+
+FileWatcher FileWatcher::Open(const char* directory)
+{
+	std::unique_ptr<Impl> impl{ new Impl };
+	impl->m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	FileWatcher watcher;
+	// Editors either rewrite a file in place or write a new one and rename it over the old
+	if (impl->m_fd >= 0 && inotify_add_watch(impl->m_fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR) >= 0)
+	{
+		watcher.m_impl = std::move(impl);
+	}
+	return watcher;
+}
+
+bool FileWatcher::Wait(uint32_t timeout_ms, Array<std::string>& out_names)
+{
+	pollfd poll_fd = { m_impl->m_fd, POLLIN, 0 };
+	if (poll(&poll_fd, 1, int(timeout_ms)) <= 0)
+	{
+		return false;
+	}
+
+	bool changed = false;
+	alignas(inotify_event) char buffer[4096];
+	for (;;)
+	{
+		const ssize_t bytes = read(m_impl->m_fd, buffer, sizeof(buffer));
+		if (bytes < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (bytes <= 0)
+		{
+			break;
+		}
+		for (const char* pos = buffer; pos < buffer + bytes;)
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(pos);
+			if (event->len > 0 && !(event->mask & IN_ISDIR))
+			{
+				out_names.AddUnique(std::string(event->name));
+				changed = true;
+			}
+			pos += sizeof(inotify_event) + event->len;
+		}
+	}
+	return changed;
+}
+
+#endif
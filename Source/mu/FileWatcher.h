@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "Array.h"
+
+// Reports files written, created or moved into one directory, not including subdirectories.
+// Uses inotify on Linux and ReadDirectoryChangesW on Windows, so nothing is polled.
+class FileWatcher
+{
+	struct Impl;
+	std::unique_ptr<Impl> m_impl;
+
+public:
+	FileWatcher();
+	FileWatcher(FileWatcher&& other);
+	FileWatcher& operator=(FileWatcher&& other);
+	~FileWatcher();
+
+	// Returns an invalid watcher if the directory can't be watched
+	static FileWatcher Open(const char* directory);
+
+	bool IsValid() const { return m_impl != nullptr; }
+
+	// Waits up to timeout_ms for changes and adds the names of the files which changed to out_names,
+	//	without their directory and without repeating a name already there.
+	// Returns false if nothing changed in time.
+	bool Wait(uint32_t timeout_ms, Array<std::string>& out_names);
+};
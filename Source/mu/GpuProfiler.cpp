@@ -0,0 +1,225 @@
+#include "GpuProfiler.h"
+
+#include <stdexcept>
+
+// Every GpuProfiler adds to the same track, they are expected to be used from the render thread
+static mu::prof::ProfileTrack* GetGpuTrack()
+{
+	static mu::prof::ProfileTrack* track = mu::prof::AddTrack("GPU");
+	return track;
+}
+
+mu::prof::GpuProfiler::GpuProfiler(VkPhysicalDevice physical_device, VkDevice device, VkQueue queue, uint32_t queue_family,
+	uint32_t num_slots, uint32_t max_zones_per_slot)
+	: m_device(device)
+	, m_query_pool(device, nullptr)
+	, m_max_zones_per_slot(max_zones_per_slot)
+{
+	uint32_t num_families = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &num_families, nullptr);
+	auto families = Array<VkQueueFamilyProperties>::MakeUninitialized(num_families);
+	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &num_families, families.Data());
+	const uint32_t valid_bits = queue_family < num_families ? families[queue_family].timestampValidBits : 0;
+	if (valid_bits == 0)
+	{
+		return;
+	}
+	m_timestamp_mask = valid_bits >= 64 ? UINT64_MAX : (uint64_t(1) << valid_bits) - 1;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physical_device, &properties);
+	m_seconds_per_timestamp = double(properties.limits.timestampPeriod) * 1e-9;
+
+	// Every slot holds a begin and end query per zone
+	VkQueryPoolCreateInfo pool_info = {
+		VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		nullptr,
+		0,
+		VK_QUERY_TYPE_TIMESTAMP,
+		num_slots * max_zones_per_slot * 2,
+		0
+	};
+	if (vkCreateQueryPool(device, &pool_info, nullptr, m_query_pool.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create timestamp query pool");
+	}
+
+	m_slots.Reserve(num_slots);
+	for (uint32_t i = 0; i < num_slots; ++i)
+	{
+		m_slots.Emplace();
+		m_slots[i].m_zones.Reserve(max_zones_per_slot);
+	}
+	// Each result is the timestamp followed by its availability
+	m_results = Array<uint64_t>::MakeUninitialized(max_zones_per_slot * 2 * 2);
+
+	// Write one timestamp and take the CPU time half way between submitting and seeing it finish
+	VkCommandPoolCreateInfo command_pool_info = {
+		VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		nullptr,
+		VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		queue_family
+	};
+	vk::CommandPool command_pool{ device, nullptr };
+	if (vkCreateCommandPool(device, &command_pool_info, nullptr, command_pool.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create command pool");
+	}
+
+	VkCommandBufferAllocateInfo alloc_info = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		nullptr,
+		command_pool,
+		VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		1,
+	};
+	VkCommandBuffer command_buffer = nullptr;
+	if (vkAllocateCommandBuffers(device, &alloc_info, &command_buffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to allocate command buffers");
+	}
+
+	VkCommandBufferBeginInfo begin_info = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		nullptr,
+		VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+		nullptr
+	};
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+	vkCmdResetQueryPool(command_buffer, m_query_pool, 0, 1);
+	vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_query_pool, 0);
+	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to record command buffer");
+	}
+
+	VkFenceCreateInfo fence_info = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr, 0 };
+	vk::Fence fence{ device, nullptr };
+	if (vkCreateFence(device, &fence_info, nullptr, fence.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create fence");
+	}
+
+	VkSubmitInfo submit_info = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		nullptr,
+		0, nullptr, nullptr,
+		1, &command_buffer,
+		0, nullptr,
+	};
+	const uint64_t submit_ticks = GetTicks();
+	if (vkQueueSubmit(queue, 1, &submit_info, fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to submit command queue");
+	}
+	VkFence wait_fence = fence;
+	vkWaitForFences(device, 1, &wait_fence, VK_TRUE, UINT64_MAX);
+	const uint64_t done_ticks = GetTicks();
+
+	uint64_t timestamp = 0;
+	if (vkGetQueryPoolResults(device, m_query_pool, 0, 1, sizeof(timestamp), &timestamp, sizeof(timestamp),
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to read timestamp query");
+	}
+	m_calibration_timestamp = timestamp & m_timestamp_mask;
+	m_calibration_ticks = submit_ticks + (done_ticks - submit_ticks) / 2;
+	m_track = GetGpuTrack();
+}
+
+void mu::prof::GpuProfiler::CmdBeginSlot(VkCommandBuffer command_buffer, uint32_t slot)
+{
+	if (!IsEnabled()) { return; }
+	if (m_slots[slot].m_submitted && !TryCollect(slot))
+	{
+		++m_num_dropped;
+	}
+	m_slots[slot].m_zones.Clear();
+	m_slots[slot].m_submitted = false;
+	vkCmdResetQueryPool(command_buffer, m_query_pool, slot * m_max_zones_per_slot * 2, m_max_zones_per_slot * 2);
+}
+
+uint32_t mu::prof::GpuProfiler::CmdBeginZone(VkCommandBuffer command_buffer, uint32_t slot, const ZoneSite& site)
+{
+	if (!IsEnabled() || m_slots[slot].m_zones.Num() == m_max_zones_per_slot)
+	{
+		return NoZone;
+	}
+	const uint32_t zone = uint32_t(m_slots[slot].m_zones.Add(&site));
+	vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_query_pool, (slot * m_max_zones_per_slot + zone) * 2);
+	return zone;
+}
+
+void mu::prof::GpuProfiler::CmdEndZone(VkCommandBuffer command_buffer, uint32_t slot, uint32_t zone)
+{
+	if (zone == NoZone) { return; }
+	vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_query_pool, (slot * m_max_zones_per_slot + zone) * 2 + 1);
+}
+
+void mu::prof::GpuProfiler::OnSubmit(uint32_t slot, VkFence fence)
+{
+	if (!IsEnabled()) { return; }
+	if (m_slots[slot].m_submitted && !TryCollect(slot))
+	{
+		++m_num_dropped;
+	}
+	m_slots[slot].m_submitted = !m_slots[slot].m_zones.IsEmpty();
+	m_slots[slot].m_fence = fence;
+}
+
+void mu::prof::GpuProfiler::Collect()
+{
+	for (uint32_t slot = 0; slot < m_slots.Num(); ++slot)
+	{
+		if (m_slots[slot].m_submitted && TryCollect(slot))
+		{
+			m_slots[slot].m_submitted = false;
+		}
+	}
+}
+
+bool mu::prof::GpuProfiler::TryCollect(uint32_t slot)
+{
+	if (vkGetFenceStatus(m_device, m_slots[slot].m_fence) != VK_SUCCESS)
+	{
+		return false;
+	}
+
+	const Array<const ZoneSite*>& zones = m_slots[slot].m_zones;
+	const uint32_t num_queries = uint32_t(zones.Num() * 2);
+	const VkResult result = vkGetQueryPoolResults(m_device, m_query_pool, slot * m_max_zones_per_slot * 2, num_queries,
+		num_queries * 2 * sizeof(uint64_t), m_results.Data(), 2 * sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if (result != VK_SUCCESS)
+	{
+		return false;
+	}
+	for (uint32_t i = 0; i < num_queries; ++i)
+	{
+		if (m_results[i * 2 + 1] == 0)
+		{
+			return false;
+		}
+	}
+
+	const double ticks_per_timestamp = m_seconds_per_timestamp / GetSecondsPerTick();
+	uint64_t first_begin = UINT64_MAX;
+	uint64_t last_end = 0;
+	for (uint32_t zone = 0; zone < zones.Num(); ++zone)
+	{
+		const uint64_t begin = ToTicks(m_results[zone * 4], ticks_per_timestamp);
+		const uint64_t end = ToTicks(m_results[zone * 4 + 2], ticks_per_timestamp);
+		AddTrackZone(m_track, *zones[zone], begin, end);
+		first_begin = begin < first_begin ? begin : first_begin;
+		last_end = end > last_end ? end : last_end;
+	}
+	m_busy_seconds += double(last_end - first_begin) * GetSecondsPerTick();
+	return true;
+}
+
+uint64_t mu::prof::GpuProfiler::ToTicks(uint64_t timestamp, double ticks_per_timestamp) const
+{
+	// Timestamps wrap at their valid bits, the mask keeps the difference right across a wrap
+	const uint64_t elapsed = ((timestamp & m_timestamp_mask) - m_calibration_timestamp) & m_timestamp_mask;
+	return m_calibration_ticks + uint64_t(double(elapsed) * ticks_per_timestamp);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "Array.h"
+#include "Profiler.h"
+#include "VulkanTools.h"
+
+namespace mu
+{
+	namespace prof
+	{
+		// Times regions of command buffers with timestamp queries and adds them to the CPU profiler
+		//	on a "GPU" track. Results are read back once the GPU has written them, never waiting for it.
+		// Each recording of a command buffer uses a slot of queries, such as one per swapchain image
+		//	when command buffers are recorded once up front, or one per frame in flight.
+		class GpuProfiler
+		{
+			struct Slot
+			{
+				Array<const ZoneSite*> m_zones;	// zone i writes queries 2i and 2i + 1 of the slot
+				bool m_submitted = false;
+				VkFence m_fence = VK_NULL_HANDLE;	// signalled once the submit using the slot has finished
+			};
+
+			VkDevice m_device = nullptr;
+			vk::QueryPool m_query_pool;
+			Array<Slot> m_slots;
+			Array<uint64_t> m_results;
+			uint32_t m_max_zones_per_slot = 0;
+			uint64_t m_timestamp_mask = 0;
+			double m_seconds_per_timestamp = 0.0;
+			uint64_t m_calibration_timestamp = 0;
+			uint64_t m_calibration_ticks = 0;
+			ProfileTrack* m_track = nullptr;
+			uint64_t m_num_dropped = 0;
+			double m_busy_seconds = 0.0;
+
+		public:
+			static const uint32_t NoZone = UINT32_MAX;
+
+			GpuProfiler() {}
+
+			// Runs one blocking submit on queue to line GPU timestamps up with the CPU profiler's clock.
+			// If the queue family doesn't support timestamps the profiler is disabled and records nothing.
+			GpuProfiler(VkPhysicalDevice physical_device, VkDevice device, VkQueue queue, uint32_t queue_family,
+				uint32_t num_slots, uint32_t max_zones_per_slot = 64);
+
+			GpuProfiler(GpuProfiler&&) = default;
+			GpuProfiler& operator=(GpuProfiler&&) = default;
+			GpuProfiler(const GpuProfiler&) = delete;
+			GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+			bool IsEnabled() const { return m_track != nullptr; }
+
+			// Resets the slot's queries, record outside a render pass before any of the slot's zones.
+			// Results of the slot's previous submit are read first if they are ready, or lost if not.
+			void CmdBeginSlot(VkCommandBuffer command_buffer, uint32_t slot);
+
+			// Returns NoZone once the slot is full, ending NoZone does nothing
+			uint32_t CmdBeginZone(VkCommandBuffer command_buffer, uint32_t slot, const ZoneSite& site);
+			void CmdEndZone(VkCommandBuffer command_buffer, uint32_t slot, uint32_t zone);
+
+			auto CmdZone(VkCommandBuffer command_buffer, uint32_t slot, const ZoneSite& site)
+			{
+				const uint32_t zone = CmdBeginZone(command_buffer, slot, site);
+				return make_scope_exit([this, command_buffer, slot, zone]() { CmdEndZone(command_buffer, slot, zone); });
+			}
+
+			// Call before submitting a command buffer recorded with the slot, with the fence the submit signals.
+			// Results of the slot's previous submit are read now if Collect hasn't seen them yet, or lost if
+			//	its fence hasn't signalled. The fence must not be reset before that submit has finished.
+			void OnSubmit(uint32_t slot, VkFence fence);
+
+			// Adds the zones of every submitted slot whose fence has signalled to the GPU track.
+			// Until then the slot's queries may still hold an earlier submit's results, as the reset
+			//	recorded in the command buffer hasn't run, so availability alone can't be trusted.
+			void Collect();
+
+			// Slot submits whose results were overwritten before they were ready
+			uint64_t GetNumDropped() const { return m_num_dropped; }
+
+			// Total time collected slots spent between their first zone beginning and last zone ending
+			double GetBusySeconds() const { return m_busy_seconds; }
+
+		private:
+			bool TryCollect(uint32_t slot);
+			uint64_t ToTicks(uint64_t timestamp, double ticks_per_timestamp) const;
+		};
+	}
+}
+
+// Time the rest of the enclosing scope of command buffer recording:
+//	MU_GPU_PROFILE_ZONE(gpu_profiler, command_buffer, slot, "MainPass");
+#if MU_PROFILE_ENABLED
+#define MU_GPU_PROFILE_ZONE(PROFILER, COMMAND_BUFFER, SLOT, NAME) \
+	static const mu::prof::ZoneSite STRING_JOIN2(mu_gpu_profile_site_, __LINE__){ NAME, __FILE__, __LINE__ }; \
+	auto STRING_JOIN2(mu_gpu_profile_zone_, __LINE__) = (PROFILER).CmdZone(COMMAND_BUFFER, SLOT, STRING_JOIN2(mu_gpu_profile_site_, __LINE__))
+#else
+#define MU_GPU_PROFILE_ZONE(PROFILER, COMMAND_BUFFER, SLOT, NAME) do {} while (false)
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "StringView.h"
+
+// Hash functions for the hashed containers.
+// Hash tables use the low bits of a hash as a tag and the high bits to pick a bucket,
+//	so every bit of the result has to depend on every bit of the input.
+namespace mu
+{
+	// Final avalanche step of MurmurHash3
+	inline uint64_t HashMix(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0)
+	{
+		const uint64_t multiplier = 0x9e3779b97f4a7c15ull;
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		uint64_t h = seed ^ (size * multiplier);
+
+		for (; size >= 8; size -= 8, bytes += 8)
+		{
+			uint64_t chunk;
+			memcpy(&chunk, bytes, 8);
+			h = (h ^ HashMix(chunk)) * multiplier;
+		}
+
+		uint64_t tail = 0;
+		memcpy(&tail, bytes, size);
+		return HashMix(h ^ tail);
+	}
+
+	template<typename T, typename = void>
+	struct Hash;
+
+	template<typename T>
+	struct Hash<T, std::enable_if_t<std::is_integral<T>::value || std::is_enum<T>::value>>
+	{
+		size_t operator()(T t) const { return size_t(HashMix(uint64_t(t))); }
+	};
+
+	template<typename T>
+	struct Hash<T*>
+	{
+		size_t operator()(const T* t) const { return size_t(HashMix(uint64_t(reinterpret_cast<uintptr_t>(t)))); }
+	};
+
+	template<>
+	struct Hash<StringView>
+	{
+		size_t operator()(const StringView& s) const { return size_t(HashBytes(s.Data(), s.Size())); }
+	};
+}
@@ -0,0 +1,640 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define MU_HASH_TABLE_SSE2 1
+#include <emmintrin.h>
+#else
+#define MU_HASH_TABLE_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "Ranges.h"
+#include "Allocators.h"
+#include "Hash.h"
+
+// Open addressing hash containers.
+// Elements live in one flat array next to an array of control bytes, one per slot.
+// A control byte holds 7 bits of the element's hash, so a lookup compares a whole group
+//	of 16 control bytes at once and only touches the elements whose tag matches.
+namespace mu
+{
+	namespace details
+	{
+		// Full slots store the low 7 bits of their hash, free slots have the sign bit set
+		enum : int8_t
+		{
+			CtrlEmpty	= -128,
+			CtrlDeleted = -2,
+		};
+
+		inline uint32_t CountTrailingZeros(uint32_t mask)
+		{
+#if defined(_MSC_VER)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return uint32_t(index);
+#else
+			return uint32_t(__builtin_ctz(mask));
+#endif
+		}
+
+		// Control bytes which are probed together, the Match functions return one bit per byte
+		struct CtrlGroup
+		{
+			enum { Width = 16 };
+
+#if MU_HASH_TABLE_SSE2
+			__m128i m_ctrl;
+
+			explicit CtrlGroup(const int8_t* ctrl)
+				: m_ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)))
+			{
+			}
+
+			uint32_t Match(int8_t tag) const { return uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), m_ctrl))); }
+			uint32_t MatchEmpty() const { return Match(CtrlEmpty); }
+			uint32_t MatchFree() const { return uint32_t(_mm_movemask_epi8(m_ctrl)); }
+#else
+			const int8_t* m_ctrl;
+
+			explicit CtrlGroup(const int8_t* ctrl)
+				: m_ctrl(ctrl)
+			{
+			}
+
+			uint32_t Match(int8_t tag) const
+			{
+				uint32_t mask = 0;
+				for (uint32_t i = 0; i < Width; ++i)
+				{
+					mask |= uint32_t(m_ctrl[i] == tag) << i;
+				}
+				return mask;
+			}
+			uint32_t MatchEmpty() const { return Match(CtrlEmpty); }
+			uint32_t MatchFree() const
+			{
+				uint32_t mask = 0;
+				for (uint32_t i = 0; i < Width; ++i)
+				{
+					mask |= uint32_t(m_ctrl[i] < 0) << i;
+				}
+				return mask;
+			}
+#endif
+		};
+
+		template<typename K, typename V>
+		struct KeyValue
+		{
+			K m_key;
+			V m_value;
+
+			template<typename KK, typename... ARGS>
+			KeyValue(KK&& key, ARGS&&... args)
+				: m_key(std::forward<KK>(key))
+				, m_value(std::forward<ARGS>(args)...)
+			{
+			}
+		};
+
+		// Policies describing what a slot holds and what iterating the container yields
+		template<typename T>
+		struct SetPolicy
+		{
+			typedef T Key;
+			typedef T Slot;
+
+			static const T& KeyOf(const T& slot) { return slot; }
+			static const T& Front(const T& slot) { return slot; }
+		};
+
+		template<typename K, typename V>
+		struct MapPolicy
+		{
+			typedef K Key;
+			typedef KeyValue<K, V> Slot;
+
+			static const K& KeyOf(const Slot& slot) { return slot.m_key; }
+			static std::tuple<const K&, V&> Front(Slot& slot) { return std::tuple<const K&, V&>(slot.m_key, slot.m_value); }
+			static std::tuple<const K&, const V&> Front(const Slot& slot) { return std::tuple<const K&, const V&>(slot.m_key, slot.m_value); }
+		};
+
+		// Forward range over the full slots of a table
+		template<typename POLICY, typename SLOT>
+		class HashTableRange : public mu::ranges::details::WithBeginEnd<HashTableRange<POLICY, SLOT>>
+		{
+			SLOT* m_slot			= nullptr;
+			const int8_t* m_ctrl	= nullptr;
+			const int8_t* m_ctrl_end = nullptr;
+
+			void SkipFree()
+			{
+				while (m_ctrl != m_ctrl_end && *m_ctrl < 0)
+				{
+					++m_ctrl;
+					++m_slot;
+				}
+			}
+
+		public:
+			enum { HasSize = 0 };
+
+			HashTableRange(SLOT* slots, const int8_t* ctrl, size_t capacity)
+				: m_slot(slots)
+				, m_ctrl(ctrl)
+				, m_ctrl_end(ctrl + capacity)
+			{
+				SkipFree();
+			}
+
+			void Advance()
+			{
+				++m_ctrl;
+				++m_slot;
+				SkipFree();
+			}
+
+			bool IsEmpty() const { return m_ctrl == m_ctrl_end; }
+			auto Front() -> decltype(POLICY::Front(*m_slot)) { return POLICY::Front(*m_slot); }
+
+			HashTableRange MakeEmpty() const { return HashTableRange{ nullptr, nullptr, 0 }; }
+		};
+
+		// Shared implementation of HashSet and HashMap.
+		// Capacity is zero or a power of two multiple of the group width, groups are probed
+		//	quadratically so every group is visited before the sequence repeats.
+		template<typename POLICY, typename HASHER, typename EQUAL, typename ALLOCATOR>
+		class HashTable
+		{
+		public:
+			typedef typename POLICY::Key Key;
+			typedef typename POLICY::Slot Slot;
+			typedef HashTableRange<POLICY, Slot> RangeType;
+			typedef HashTableRange<POLICY, const Slot> ConstRangeType;
+
+		protected:
+			Slot* m_slots		= nullptr;
+			int8_t* m_ctrl		= nullptr;
+			size_t m_capacity	= 0;
+			size_t m_num		= 0;
+			// Number of empty slots which can be filled before the load factor is exceeded.
+			// Deleted slots are not given back until the next rehash.
+			size_t m_growth_left = 0;
+			HASHER m_hasher;
+			EQUAL m_equal;
+			ALLOCATOR m_allocator;
+
+		public:
+			HashTable()
+			{
+			}
+
+			explicit HashTable(ALLOCATOR allocator)
+				: m_allocator(allocator)
+			{
+			}
+
+			HashTable(const HashTable& other)
+				: m_hasher(other.m_hasher)
+				, m_equal(other.m_equal)
+				, m_allocator(other.m_allocator)
+			{
+				CopyFrom(other);
+			}
+
+			HashTable(HashTable&& other)
+			{
+				*this = std::move(other);
+			}
+
+			// Copies keep their own allocator
+			HashTable& operator=(const HashTable& other)
+			{
+				if (this != &other)
+				{
+					Clear();
+					CopyFrom(other);
+				}
+				return *this;
+			}
+
+			HashTable& operator=(HashTable&& other)
+			{
+				if (this != &other)
+				{
+					Release();
+					m_slots = other.m_slots;
+					m_ctrl = other.m_ctrl;
+					m_capacity = other.m_capacity;
+					m_num = other.m_num;
+					m_growth_left = other.m_growth_left;
+					m_hasher = std::move(other.m_hasher);
+					m_equal = std::move(other.m_equal);
+					m_allocator = other.m_allocator;
+					other.m_slots = nullptr;
+					other.m_ctrl = nullptr;
+					other.m_capacity = 0;
+					other.m_num = 0;
+					other.m_growth_left = 0;
+				}
+				return *this;
+			}
+
+			~HashTable()
+			{
+				Release();
+			}
+
+			size_t Num() const { return m_num; }
+			size_t Capacity() const { return m_capacity; }
+			bool IsEmpty() const { return m_num == 0; }
+
+			const ALLOCATOR& GetAllocator() const { return m_allocator; }
+
+			// Make room for num elements without rehashing
+			void Reserve(size_t num)
+			{
+				if (num > m_num + m_growth_left)
+				{
+					size_t capacity = m_capacity ? m_capacity : size_t(CtrlGroup::Width);
+					while (MaxLoad(capacity) < num)
+					{
+						capacity *= 2;
+					}
+					Rehash(capacity);
+				}
+			}
+
+			// Destroy all elements, keeping the current storage
+			void Clear()
+			{
+				if (m_capacity == 0) { return; }
+
+				DestructAll();
+				memset(m_ctrl, CtrlEmpty, m_capacity);
+				m_num = 0;
+				m_growth_left = MaxLoad(m_capacity);
+			}
+
+			RangeType All() { return RangeType{ m_slots, m_ctrl, m_capacity }; }
+			ConstRangeType All() const { return ConstRangeType{ m_slots, m_ctrl, m_capacity }; }
+
+			auto begin() { return mu::MakeRangeIterator(All()); }
+			auto end() { return mu::MakeRangeIterator(All().MakeEmpty()); }
+
+			auto begin() const { return mu::MakeRangeIterator(All()); }
+			auto end() const { return mu::MakeRangeIterator(All().MakeEmpty()); }
+
+		protected:
+			static int8_t Tag(size_t hash) { return int8_t(hash & 0x7f); }
+
+			// Keep one slot in eight free so probe sequences stay short
+			static size_t MaxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+			static size_t AllocationSize(size_t capacity) { return capacity * (sizeof(Slot) + 1); }
+
+			// Calls visit(group start) for each group in the probe sequence of hash until it returns false
+			template<typename FUNC>
+			void Probe(size_t hash, FUNC&& visit) const
+			{
+				const size_t mask = m_capacity / CtrlGroup::Width - 1;
+				size_t group = (hash >> 7) & mask;
+				for (size_t step = 1; visit(group * CtrlGroup::Width); ++step)
+				{
+					group = (group + step) & mask;
+				}
+			}
+
+			Slot* FindSlot(const Key& key) const
+			{
+				if (m_num == 0) { return nullptr; }
+
+				const size_t hash = m_hasher(key);
+				const int8_t tag = Tag(hash);
+				Slot* found = nullptr;
+				Probe(hash, [&](size_t start)
+				{
+					CtrlGroup group{ m_ctrl + start };
+					for (uint32_t match = group.Match(tag); match != 0; match &= match - 1)
+					{
+						Slot* slot = m_slots + start + CountTrailingZeros(match);
+						if (m_equal(POLICY::KeyOf(*slot), key))
+						{
+							found = slot;
+							return false;
+						}
+					}
+					return group.MatchEmpty() == 0;
+				});
+				return found;
+			}
+
+			// Returns the slot holding key and true if args were used to construct a new element
+			template<typename... ARGS>
+			std::pair<Slot*, bool> FindOrInsert(const Key& key, ARGS&&... args)
+			{
+				const size_t hash = m_hasher(key);
+				const int8_t tag = Tag(hash);
+				size_t index = size_t(-1);
+				Slot* found = nullptr;
+
+				if (m_capacity > 0)
+				{
+					Probe(hash, [&](size_t start)
+					{
+						CtrlGroup group{ m_ctrl + start };
+						for (uint32_t match = group.Match(tag); match != 0; match &= match - 1)
+						{
+							Slot* slot = m_slots + start + CountTrailingZeros(match);
+							if (m_equal(POLICY::KeyOf(*slot), key))
+							{
+								found = slot;
+								return false;
+							}
+						}
+						const uint32_t free = group.MatchFree();
+						if (index == size_t(-1) && free != 0)
+						{
+							index = start + CountTrailingZeros(free);
+						}
+						return group.MatchEmpty() == 0;
+					});
+
+					if (found)
+					{
+						return std::make_pair(found, false);
+					}
+				}
+
+				// Reusing a deleted slot doesn't change the load
+				if (index == size_t(-1) || (m_growth_left == 0 && m_ctrl[index] == CtrlEmpty))
+				{
+					Grow();
+					index = FindFreeIndex(hash);
+				}
+
+				new(m_slots + index) Slot(std::forward<ARGS>(args)...);
+				if (m_ctrl[index] == CtrlEmpty)
+				{
+					--m_growth_left;
+				}
+				m_ctrl[index] = tag;
+				++m_num;
+				return std::make_pair(m_slots + index, true);
+			}
+
+			bool Erase(const Key& key)
+			{
+				Slot* slot = FindSlot(key);
+				if (!slot) { return false; }
+
+				const size_t index = slot - m_slots;
+				slot->~Slot();
+				--m_num;
+
+				// A group with an empty slot ends every probe sequence passing through it,
+				//	so the slot can become empty again instead of leaving a tombstone.
+				if (CtrlGroup{ m_ctrl + (index & ~size_t(CtrlGroup::Width - 1)) }.MatchEmpty() != 0)
+				{
+					m_ctrl[index] = CtrlEmpty;
+					++m_growth_left;
+				}
+				else
+				{
+					m_ctrl[index] = CtrlDeleted;
+				}
+				return true;
+			}
+
+		private:
+			size_t FindFreeIndex(size_t hash) const
+			{
+				size_t index = 0;
+				Probe(hash, [&](size_t start)
+				{
+					const uint32_t free = CtrlGroup{ m_ctrl + start }.MatchFree();
+					if (free != 0)
+					{
+						index = start + CountTrailingZeros(free);
+						return false;
+					}
+					return true;
+				});
+				return index;
+			}
+
+			void Grow()
+			{
+				// Mostly tombstones, clean them up without growing
+				if (m_capacity > 0 && m_num <= MaxLoad(m_capacity) / 2)
+				{
+					Rehash(m_capacity);
+				}
+				else
+				{
+					Rehash(m_capacity ? m_capacity * 2 : size_t(CtrlGroup::Width));
+				}
+			}
+
+			void Rehash(size_t new_capacity)
+			{
+				Slot* old_slots = m_slots;
+				int8_t* old_ctrl = m_ctrl;
+				const size_t old_capacity = m_capacity;
+
+				m_slots = (Slot*)m_allocator.Allocate(AllocationSize(new_capacity), alignof(Slot));
+				m_ctrl = reinterpret_cast<int8_t*>(m_slots + new_capacity);
+				m_capacity = new_capacity;
+				m_growth_left = MaxLoad(new_capacity) - m_num;
+				memset(m_ctrl, CtrlEmpty, new_capacity);
+
+				for (size_t i = 0; i < old_capacity; ++i)
+				{
+					if (old_ctrl[i] >= 0)
+					{
+						const size_t hash = m_hasher(POLICY::KeyOf(old_slots[i]));
+						const size_t index = FindFreeIndex(hash);
+						new(m_slots + index) Slot(std::move(old_slots[i]));
+						old_slots[i].~Slot();
+						m_ctrl[index] = Tag(hash);
+					}
+				}
+
+				if (old_slots)
+				{
+					m_allocator.Free(old_slots, AllocationSize(old_capacity));
+				}
+			}
+
+			void CopyFrom(const HashTable& other)
+			{
+				Reserve(other.m_num);
+				for (size_t i = 0; i < other.m_capacity; ++i)
+				{
+					if (other.m_ctrl[i] >= 0)
+					{
+						FindOrInsert(POLICY::KeyOf(other.m_slots[i]), other.m_slots[i]);
+					}
+				}
+			}
+
+			void DestructAll()
+			{
+				for (size_t i = 0; i < m_capacity; ++i)
+				{
+					if (m_ctrl[i] >= 0)
+					{
+						m_slots[i].~Slot();
+					}
+				}
+			}
+
+			// Destroy all elements and give the storage back to the allocator
+			void Release()
+			{
+				if (m_capacity == 0) { return; }
+
+				DestructAll();
+				m_allocator.Free(m_slots, AllocationSize(m_capacity));
+				m_slots = nullptr;
+				m_ctrl = nullptr;
+				m_capacity = 0;
+				m_num = 0;
+				m_growth_left = 0;
+			}
+		};
+	}
+
+	template<typename T, typename HASHER = Hash<T>, typename EQUAL = std::equal_to<T>, typename ALLOCATOR = HeapAllocator>
+	class HashSet : public details::HashTable<details::SetPolicy<T>, HASHER, EQUAL, ALLOCATOR>
+	{
+		typedef details::HashTable<details::SetPolicy<T>, HASHER, EQUAL, ALLOCATOR> Base;
+
+	public:
+		HashSet()
+		{
+		}
+
+		explicit HashSet(ALLOCATOR allocator)
+			: Base(allocator)
+		{
+		}
+
+		HashSet(std::initializer_list<T> init, ALLOCATOR allocator = ALLOCATOR())
+			: Base(allocator)
+		{
+			this->Reserve(init.size());
+			Append(init);
+		}
+
+		template<class RANGE, typename = std::enable_if_t<
+			!std::is_convertible<RANGE, ALLOCATOR>::value && !std::is_same<std::decay_t<RANGE>, HashSet>::value>>
+		HashSet(RANGE&& r, ALLOCATOR allocator = ALLOCATOR())
+			: Base(allocator)
+		{
+			Append(std::forward<RANGE>(r));
+		}
+
+		// Returns false if the item was already present
+		bool Add(const T& item)
+		{
+			return this->FindOrInsert(item, item).second;
+		}
+
+		bool Add(T&& item)
+		{
+			return this->FindOrInsert(item, std::move(item)).second;
+		}
+
+		template<typename RANGE>
+		void Append(RANGE&& r)
+		{
+			for (auto&& item : r)
+			{
+				Add(std::forward<decltype(item)>(item));
+			}
+		}
+
+		bool Contains(const T& item) const
+		{
+			return this->FindSlot(item) != nullptr;
+		}
+
+		// Returns false if the item was not present
+		bool Remove(const T& item)
+		{
+			return this->Erase(item);
+		}
+	};
+
+	template<typename K, typename V, typename HASHER = Hash<K>, typename EQUAL = std::equal_to<K>, typename ALLOCATOR = HeapAllocator>
+	class HashMap : public details::HashTable<details::MapPolicy<K, V>, HASHER, EQUAL, ALLOCATOR>
+	{
+		typedef details::HashTable<details::MapPolicy<K, V>, HASHER, EQUAL, ALLOCATOR> Base;
+
+	public:
+		HashMap()
+		{
+		}
+
+		explicit HashMap(ALLOCATOR allocator)
+			: Base(allocator)
+		{
+		}
+
+		// Inserts the value, replacing any existing value for key
+		template<typename VV>
+		V& Add(const K& key, VV&& value)
+		{
+			auto result = this->FindOrInsert(key, key, std::forward<VV>(value));
+			if (!result.second)
+			{
+				result.first->m_value = std::forward<VV>(value);
+			}
+			return result.first->m_value;
+		}
+
+		// Returns the value for key, constructing it from args if key is not present
+		template<typename... ARGS>
+		V& FindOrAdd(const K& key, ARGS&&... args)
+		{
+			return this->FindOrInsert(key, key, std::forward<ARGS>(args)...).first->m_value;
+		}
+
+		V* Find(const K& key)
+		{
+			auto slot = this->FindSlot(key);
+			return slot ? &slot->m_value : nullptr;
+		}
+
+		const V* Find(const K& key) const
+		{
+			auto slot = this->FindSlot(key);
+			return slot ? &slot->m_value : nullptr;
+		}
+
+		bool Contains(const K& key) const
+		{
+			return this->FindSlot(key) != nullptr;
+		}
+
+		// Returns false if the key was not present
+		bool Remove(const K& key)
+		{
+			return this->Erase(key);
+		}
+	};
+}
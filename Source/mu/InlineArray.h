@@ -0,0 +1,319 @@
+#pragma once
+
+#include <initializer_list>
+#include <cstdint>
+#include <type_traits>
+
+#include "Ranges.h"
+#include "Algorithms.h"
+#include "Metaprogramming.h"
+#include "Allocators.h"
+
+// Array with space for N elements inside the object itself.
+// Only spills to the allocator once more than N elements are added, so the common case of
+//	a handful of items (queue families, layer names, swapchain images) never touches the heap.
+// Has the same interface as Array.
+template<typename T, size_t N, typename ALLOCATOR = mu::HeapAllocator>
+class InlineArray
+{
+	static_assert(N > 0, "InlineArray needs space for at least one element, use Array instead");
+
+	T* m_data		= reinterpret_cast<T*>(m_inline);
+	size_t m_num	= 0;
+	size_t m_max	= N;
+	ALLOCATOR m_allocator;
+	alignas(T) uint8_t m_inline[sizeof(T) * N];
+
+public:
+	InlineArray()
+	{
+	}
+
+	explicit InlineArray(ALLOCATOR allocator)
+		: m_allocator(allocator)
+	{
+	}
+
+	InlineArray(std::initializer_list<T> init, ALLOCATOR allocator = ALLOCATOR())
+		: m_allocator(allocator)
+	{
+		Reserve(init.size());
+		for (auto&& item : init)
+		{
+			AddSafe(item);
+		}
+	}
+
+	template<class RANGE, typename = std::enable_if_t<!std::is_convertible<RANGE, ALLOCATOR>::value>>
+	InlineArray(RANGE&& r, ALLOCATOR allocator = ALLOCATOR())
+		: m_allocator(allocator)
+	{
+		for (auto&& item : r)
+		{
+			Add(item);
+		}
+	}
+
+	InlineArray(const InlineArray& other)
+		: m_allocator(other.m_allocator)
+	{
+		Reserve(other.m_num);
+		for (auto&& item : other)
+		{
+			AddSafe(item);
+		}
+	}
+
+	InlineArray(InlineArray&& other)
+	{
+		*this = std::forward<InlineArray>(other);
+	}
+
+	// Copies keep their own allocator
+	InlineArray& operator=(const InlineArray& other)
+	{
+		if (this != &other)
+		{
+			Clear();
+			Reserve(other.m_num);
+			for (const auto& item : other)
+			{
+				AddSafe(item);
+			}
+		}
+		return *this;
+	}
+
+	// Heap storage is stolen, inline elements are relocated one by one
+	InlineArray& operator=(InlineArray&& other)
+	{
+		if (this != &other)
+		{
+			Release();
+			m_allocator = other.m_allocator;
+			if (other.IsInline())
+			{
+				mu::RelocateConstruct(mu::Range(m_data, other.m_num), mu::Range(other.m_data, other.m_num));
+				m_num = other.m_num;
+			}
+			else
+			{
+				m_data = other.m_data;
+				m_num = other.m_num;
+				m_max = other.m_max;
+				other.m_data = reinterpret_cast<T*>(other.m_inline);
+				other.m_max = N;
+			}
+			other.m_num = 0;
+		}
+		return *this;
+	}
+
+	~InlineArray()
+	{
+		Release();
+	}
+
+	void Reserve(size_t new_max)
+	{
+		if (new_max > m_max)
+		{
+			Grow(new_max);
+		}
+	}
+
+	template<typename... US>
+	static InlineArray MakeUnique(US&&... us)
+	{
+		InlineArray ret{};
+		ret.Reserve(sizeof...(US));
+		ret.AddManyUnique(us...);
+		return std::move(ret);
+	}
+
+	size_t Add(const T& item)
+	{
+		EnsureSpace(m_num + 1);
+		return AddSafe(item);
+	}
+
+	size_t Add(T&& item)
+	{
+		EnsureSpace(m_num + 1);
+		return AddSafe(std::forward<T>(item));
+	}
+
+	void AddUnique(const T& item)
+	{
+		if (!Contains(item))
+		{
+			Add(item);
+		}
+	}
+
+	void AddUnique(T&& item)
+	{
+		if (!Contains(item))
+		{
+			Add(std::forward<T>(item));
+		}
+	}
+
+	template<typename U>
+	void AddManyUnique(U&& u)
+	{
+		AddUnique(std::forward<U>(u));
+	}
+
+	template<typename U, typename... US>
+	void AddManyUnique(U&& u, US&&... us)
+	{
+		AddUnique(std::forward<U>(u));
+		AddManyUnique(std::forward<US>(us)...);
+	}
+
+	size_t Emplace(T&& item)
+	{
+		EnsureSpace(m_num + 1);
+		return AddSafe(std::forward<T>(item));
+	}
+
+	template<typename... US>
+	size_t Emplace(US&&... us)
+	{
+		return Add(T(std::forward<US>(us)...));
+	}
+
+	template<typename RANGE>
+	void Append(RANGE&& r)
+	{
+		for (auto&& item : r)
+		{
+			Add(std::forward<decltype(item)>(item));
+		}
+	}
+
+	void AppendRaw(const T* items, size_t count)
+	{
+		Append(mu::Range(items, count));
+	}
+
+	// Destroy all elements, keeping the current storage
+	void Clear()
+	{
+		Destruct(0, m_num);
+		m_num = 0;
+	}
+
+	T& operator[](size_t index)
+	{
+		return m_data[index];
+	}
+
+	const T& operator[](size_t index) const
+	{
+		return m_data[index];
+	}
+
+	T* Data() { return m_data; }
+	const T* Data() const { return m_data; }
+
+	const ALLOCATOR& GetAllocator() const { return m_allocator; }
+
+	size_t Num() const { return m_num; }
+	size_t Max() const { return m_max; }
+	bool IsEmpty() const { return m_num == 0; }
+
+	// True while the elements still fit in the inline storage
+	bool IsInline() const { return m_data == reinterpret_cast<const T*>(m_inline); }
+
+	bool Contains(const T& item) const
+	{
+		for (const T& t : *this)
+		{
+			if (t == item)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	auto begin() { return mu::MakeRangeIterator(mu::Range(m_data, m_num)); }
+	auto end() { return mu::MakeRangeIterator(mu::Range((T*)nullptr, 0)); }
+
+	auto begin() const { return mu::MakeRangeIterator(mu::Range((const T*)m_data, m_num)); }
+	auto end() const { return mu::MakeRangeIterator(mu::Range((const T*)nullptr, 0)); }
+
+private:
+	// Destroy all elements and give any heap storage back to the allocator
+	void Release()
+	{
+		Clear();
+		if (!IsInline())
+		{
+			m_allocator.Free(m_data, sizeof(T) * m_max);
+			m_data = reinterpret_cast<T*>(m_inline);
+			m_max = N;
+		}
+	}
+
+	void EnsureSpace(size_t num)
+	{
+		if (num > m_max)
+		{
+			Grow(num > m_max * 2 ? num : m_max * 2);
+		}
+	}
+
+	void Grow(size_t new_size)
+	{
+		if (!IsInline())
+		{
+			Grow(new_size, mu::meta::IsTriviallyRelocatable<T>{});
+			return;
+		}
+
+		// Spill from the inline storage to the allocator
+		T* new_data = (T*)m_allocator.Allocate(sizeof(T) * new_size, alignof(T));
+		mu::RelocateConstruct(mu::Range(new_data, m_num), mu::Range(m_data, m_num));
+		m_data = new_data;
+		m_max = new_size;
+	}
+
+	// Trivially relocatable elements move along with the allocation
+	void Grow(size_t new_size, std::true_type)
+	{
+		m_data = (T*)m_allocator.Reallocate(m_data, sizeof(T) * m_max, sizeof(T) * new_size, alignof(T));
+		m_max = new_size;
+	}
+
+	void Grow(size_t new_size, std::false_type)
+	{
+		T* new_data = (T*)m_allocator.Allocate(sizeof(T) * new_size, alignof(T));
+		mu::RelocateConstruct(mu::Range(new_data, m_num), mu::Range(m_data, m_num));
+		m_allocator.Free(m_data, sizeof(T) * m_max);
+		m_data = new_data;
+		m_max = new_size;
+	}
+
+	size_t AddSafe(const T& item)
+	{
+		new(m_data + m_num) T(item);
+		return m_num++;
+	}
+
+	size_t AddSafe(T&& item)
+	{
+		new(m_data + m_num) T(std::forward<T>(item));
+		return m_num++;
+	}
+
+	void Destruct(size_t start, size_t num)
+	{
+		for (size_t i = start; i < start + num; ++i)
+		{
+			m_data[i].~T();
+		}
+	}
+};
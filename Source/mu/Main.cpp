@@ -1,22 +1,47 @@
 #include <vulkan/vulkan.h>
 
 #include <glfw/glfw3.h>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
 #include <memory>
+#include <string>
 
 #include "Array.h"
+#include "InlineArray.h"
+#include "HashTable.h"
+#include "Allocators.h"
 #include "Ranges.h"
 #include "Algorithms.h"
 #include "Debug.h"
+#include "BinaryLog.h"
 #include "Scope.h"
 #include "VulkanTools.h"
 #include "Utils.h"
 #include "Math.h"
 #include "FileReader.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "GpuProfiler.h"
+#include "CommandRecorder.h"
+#include "DeviceMemory.h"
+#include "StagingUploader.h"
+#include "PipelineBuilder.h"
+#include "ShaderLibrary.h"
+#include "ShaderHotReloader.h"
 
 using std::tuple;
 using namespace mu;
 
+// Temporary arrays built during startup come from a scratch arena instead of the heap
+using ScratchAllocator = AllocatorRef<LinearArena>;
+
+// Layer and extension names, there are only ever a few of them
+using NameList = InlineArray<const char*, 8>;
+
 VKAPI_ATTR VkBool32 VKAPI_CALL VkDebugCallback(
 	VkDebugReportFlagsEXT                       flags,
 	VkDebugReportObjectTypeEXT                  objectType,
@@ -31,13 +56,25 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VkDebugCallback(
 	return VK_FALSE;
 }
 
-void CreateVulkanInstance(vk::Instance& out_instance)
+// Headless instances don't need the window system's extensions.
+// Validation and debug reporting are used when installed, which CI machines and software drivers may not have.
+void CreateVulkanInstance(bool headless, ScratchAllocator scratch, vk::Instance& out_instance, bool& out_debug_report)
 {
-	Array<const char*> instance_extensions;
+	MU_PROFILE_ZONE("CreateVulkanInstance");
+	NameList instance_extensions;
+	if (!headless)
 	{
 		uint32_t count = 0;
 		const char** extensions = glfwGetRequiredInstanceExtensions(&count);
 		instance_extensions.AppendRaw(extensions, count);
+	}
+	out_debug_report = false;
+	for (const VkExtensionProperties& ext : vk::EnumerateInstanceExtensionProperties(nullptr, scratch))
+	{
+		out_debug_report = out_debug_report || strcmp(ext.extensionName, VK_EXT_DEBUG_REPORT_EXTENSION_NAME) == 0;
+	}
+	if (out_debug_report)
+	{
 		instance_extensions.Emplace(VK_EXT_DEBUG_REPORT_EXTENSION_NAME);
 	}
 
@@ -48,8 +85,19 @@ void CreateVulkanInstance(vk::Instance& out_instance)
 		VK_API_VERSION_1_0
 	};
 
-	Array<const char*> layers = { "VK_LAYER_LUNARG_standard_validation" };
-
+	const char* validation_layer = "VK_LAYER_LUNARG_standard_validation";
+	NameList layers;
+	for (const VkLayerProperties& layer : vk::EnumerateInstanceLayerProperties(scratch))
+	{
+		if (strcmp(layer.layerName, validation_layer) == 0)
+		{
+			layers.Add(validation_layer);
+		}
+	}
+	if (layers.IsEmpty())
+	{
+		dbg::Log("Validation layer not available, running without it");
+	}
 
 	auto instance_create_info = VkInstanceCreateInfo{
 		VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO, nullptr,
@@ -94,37 +142,49 @@ struct PhysicalDeviceSelection
 	VkPhysicalDeviceProperties m_device_properties;
 	uint32_t m_graphics_queue_family;
 	uint32_t m_present_queue_family;
+	uint32_t m_transfer_queue_family;	// transfer only if the device has such a family, so copies overlap rendering
 };
 
 PhysicalDeviceSelection SelectPhysicalDevice(
-	const Array<const char*>& required_extensions,
+	const NameList& required_extensions,
 	VkInstance instance, 
-	VkSurfaceKHR surface)
+	VkSurfaceKHR surface,
+	ScratchAllocator scratch)
 {
-	Array<VkPhysicalDevice> devices = vk::EnumeratePhysicalDevices(instance);
+	MU_PROFILE_ZONE("SelectPhysicalDevice");
+	auto devices = vk::EnumeratePhysicalDevices(instance, scratch);
 
 	for (VkPhysicalDevice device : devices)
 	{		
 		{
-			Array<VkExtensionProperties> available_extensions = vk::EnumerateDeviceExtensionProperties(device);
+			auto available_extensions = vk::EnumerateDeviceExtensionProperties(device, scratch);
+			HashSet<StringView, Hash<StringView>, std::equal_to<StringView>, ScratchAllocator> available_names{ scratch };
+			available_names.Reserve(available_extensions.Num());
+			for (const VkExtensionProperties& ext : available_extensions)
+			{
+				available_names.Add(ext.extensionName);
+			}
+
 			bool all_found = true;
 			for (const char* needed_ext : required_extensions)
 			{
-				auto f = Find(available_extensions, [needed_ext](const VkExtensionProperties& ext) { return strcmp(ext.extensionName, needed_ext) == 0; });
-				all_found = all_found && !f.IsEmpty();
+				all_found = all_found && available_names.Contains(needed_ext);
 			}
 
 			if (!all_found) { continue; }
 		}
 
-		vk::SwapChainSupport swap_chain = vk::QuerySwapChainSupport(device, surface);
-		if (swap_chain.surface_formats.IsEmpty() || swap_chain.present_modes.IsEmpty())
+		if (surface != VK_NULL_HANDLE)
 		{
-			continue;
+			auto swap_chain = vk::QuerySwapChainSupport(device, surface, scratch);
+			if (swap_chain.surface_formats.IsEmpty() || swap_chain.present_modes.IsEmpty())
+			{
+				continue;
+			}
 		}
 
-		Array<VkQueueFamilyProperties> queue_props = vk::GetPhysicalDeviceQueueFamilyProperties(device);
-		int32_t graphics_index = -1, present_index = -1;
+		auto queue_props = vk::GetPhysicalDeviceQueueFamilyProperties(device, scratch);
+		int32_t graphics_index = -1, present_index = -1, transfer_index = -1;
 		for (int32_t i = 0; i < queue_props.Num(); ++i)
 		{
 			if (queue_props[i].queueCount > 0)
@@ -134,8 +194,23 @@ PhysicalDeviceSelection SelectPhysicalDevice(
 					graphics_index = i;
 				}
 
+				// Graphics and compute queues can do transfers too, but a family without them is the copy engine
+				const VkQueueFlags transfer_only_mask = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+				if (transfer_index < 0 && (queue_props[i].queueFlags & transfer_only_mask) == VK_QUEUE_TRANSFER_BIT)
+				{
+					transfer_index = i;
+				}
+
+				// Without a surface nothing is presented, so the graphics queue stands in
 				VkBool32 supports_present = false;
-				vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &supports_present);
+				if (surface != VK_NULL_HANDLE)
+				{
+					vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &supports_present);
+				}
+				else
+				{
+					supports_present = (queue_props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+				}
 				if (present_index < 0 && supports_present)
 				{
 					present_index = i;
@@ -145,10 +220,12 @@ PhysicalDeviceSelection SelectPhysicalDevice(
 
 		if (graphics_index >= 0 && present_index >= 0)
 		{
-			PhysicalDeviceSelection selection{ device,{}, (uint32_t)graphics_index, (uint32_t)present_index};
+			transfer_index = transfer_index >= 0 ? transfer_index : graphics_index;
+			PhysicalDeviceSelection selection{ device,{}, (uint32_t)graphics_index, (uint32_t)present_index, (uint32_t)transfer_index };
 			vkGetPhysicalDeviceProperties(device, &selection.m_device_properties); 
 
-			dbg::Log("Using physical device: ", selection.m_device_properties.deviceName, ", graphics queue family: ", graphics_index, ", present queue family:", present_index);
+			dbg::Log("Using physical device: ", selection.m_device_properties.deviceName, ", graphics queue family: ", graphics_index, ", present queue family:", present_index,
+				", transfer queue family: ", transfer_index);
 			
 			return selection;
 		}
@@ -157,7 +234,8 @@ PhysicalDeviceSelection SelectPhysicalDevice(
 	throw std::runtime_error("No device available");
 }
 
-VkSurfaceFormatKHR ChooseSurfaceFormat(const Array<VkSurfaceFormatKHR>& surface_formats)
+template<typename ALLOCATOR>
+VkSurfaceFormatKHR ChooseSurfaceFormat(const Array<VkSurfaceFormatKHR, ALLOCATOR>& surface_formats)
 {
 	if (surface_formats.Num() == 0) throw std::runtime_error("No device formats available");
 
@@ -176,7 +254,8 @@ VkSurfaceFormatKHR ChooseSurfaceFormat(const Array<VkSurfaceFormatKHR>& surface_
 	return surface_formats[0];
 }
 
-VkPresentModeKHR ChoosePresentMode(const Array<VkPresentModeKHR>& present_modes)
+template<typename ALLOCATOR>
+VkPresentModeKHR ChoosePresentMode(const Array<VkPresentModeKHR, ALLOCATOR>& present_modes)
 {
 	for (const auto& mode : present_modes)
 	{
@@ -200,19 +279,19 @@ VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& surface_caps, uint32
 
 void CreateDevice(
 	PhysicalDeviceSelection selected_device,
-	const Array<const char*>& device_extensions,
+	const NameList& device_extensions,
 	GLFWwindow* window,
 	VkInstance instance,
 	VkSurfaceKHR surface,
+	ScratchAllocator scratch,
 	vk::Device& out_device,
-	VkQueue& out_graphics_queue, VkQueue& out_present_queue)
+	VkQueue& out_graphics_queue, VkQueue& out_present_queue, VkQueue& out_transfer_queue)
 {	
-	vk::SwapChainSupport swap_chain_support = vk::QuerySwapChainSupport(selected_device.m_device, surface);
-	ChooseSurfaceFormat(swap_chain_support.surface_formats);
-
+	MU_PROFILE_ZONE("CreateDevice");
 	float priority = 1.0f;
-	auto queue_families = Array<uint32_t>::MakeUnique( selected_device.m_graphics_queue_family, selected_device.m_present_queue_family );
-	Array<VkDeviceQueueCreateInfo> queue_create_info{ Transform(Range(queue_families), [&](uint32_t index) {
+	auto queue_families = InlineArray<uint32_t, 3>::MakeUnique( selected_device.m_graphics_queue_family, selected_device.m_present_queue_family,
+		selected_device.m_transfer_queue_family );
+	InlineArray<VkDeviceQueueCreateInfo, 3> queue_create_info{ Transform(Range(queue_families), [&](uint32_t index) {
 		return VkDeviceQueueCreateInfo{
 			VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
 			nullptr,
@@ -239,13 +318,14 @@ void CreateDevice(
 	}
 	vkGetDeviceQueue(out_device, selected_device.m_graphics_queue_family, 0, &out_graphics_queue);
 	vkGetDeviceQueue(out_device, selected_device.m_present_queue_family, 0, &out_present_queue);
+	vkGetDeviceQueue(out_device, selected_device.m_transfer_queue_family, 0, &out_transfer_queue);
 }
 
 struct Swapchain
 {
 	vk::SwapchainKHR handle;
-	Array<VkImage> images;
-	Array<vk::ImageView> image_views;
+	InlineArray<VkImage, 4> images;
+	InlineArray<vk::ImageView, 4> image_views;
 	VkFormat image_format;
 	VkExtent2D extent;
 };
@@ -254,12 +334,15 @@ Swapchain CreateSwapChain(
 	GLFWwindow* window,
 	PhysicalDeviceSelection device_selection,
 	VkDevice device,
-	VkSurfaceKHR surface)
+	VkSurfaceKHR surface,
+	ScratchAllocator scratch,
+	VkSwapchainKHR old_swapchain = VK_NULL_HANDLE)
 {
+	MU_PROFILE_ZONE("CreateSwapChain");
 	int fb_width = 0, fb_height = 0;
 	glfwGetFramebufferSize(window, &fb_width, &fb_height);
 
-	vk::SwapChainSupport swap_chain_support = vk::QuerySwapChainSupport(device_selection.m_device, surface);
+	auto swap_chain_support = vk::QuerySwapChainSupport(device_selection.m_device, surface, scratch);
 	VkSurfaceFormatKHR surface_format = ChooseSurfaceFormat(swap_chain_support.surface_formats);
 	VkPresentModeKHR present_mode = ChoosePresentMode(swap_chain_support.present_modes);
 	VkExtent2D extent = ChooseSwapExtent(swap_chain_support.capabilities, fb_width, fb_height);
@@ -269,7 +352,7 @@ Swapchain CreateSwapChain(
 	{
 		image_count = Min(image_count, swap_chain_support.capabilities.maxImageCount);
 	}
-	auto queue_family_indices = Array<uint32_t>::MakeUnique( device_selection.m_graphics_queue_family, device_selection.m_present_queue_family );
+	auto queue_family_indices = InlineArray<uint32_t, 2>::MakeUnique( device_selection.m_graphics_queue_family, device_selection.m_present_queue_family );
 
 	VkSharingMode sharing_mode = queue_family_indices.Num() == 1 ? VK_SHARING_MODE_EXCLUSIVE : VK_SHARING_MODE_CONCURRENT;
 
@@ -290,15 +373,15 @@ Swapchain CreateSwapChain(
 		VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR, // compositeAlpha
 		present_mode, // presentMode
 		VK_TRUE, // clipped
-		VK_NULL_HANDLE, // oldSwapchain
+		old_swapchain, // oldSwapchain, retired once the new one is created
 	};
 	vk::SwapchainKHR out_swapchain{ device, nullptr };
 	if (vkCreateSwapchainKHR(device, &swapchain_create_info, nullptr, out_swapchain.Replace()) != VK_SUCCESS)
 	{
 		throw std::runtime_error("Failed to create swap chain");
 	}
-	Array<VkImage> images = vk::GetSwapchainImagesKHR(device, out_swapchain);
-	Array<vk::ImageView> image_views;
+	InlineArray<VkImage, 4> images{ vk::GetSwapchainImagesKHR(device, out_swapchain, scratch) };
+	InlineArray<vk::ImageView, 4> image_views;
 	for (VkImage image : images)
 	{
 		VkImageViewCreateInfo image_view_create_info{
@@ -318,21 +401,70 @@ Swapchain CreateSwapChain(
 	return{ std::move(out_swapchain), std::move(images), std::move(image_views), surface_format.format, extent };
 }
 
-vk::ShaderModule CreateShaderModule(VkDevice device, const ranges::PointerRange<uint8_t>& code)
+// Owns the images which stand in for the swapchain's when rendering headless
+struct OffscreenTargets
 {
-	VkShaderModuleCreateInfo create_info = {
-		VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-		nullptr,
-		0,
-		code.Size(), reinterpret_cast<const uint32_t*>(&code.Front()),
-	};
+	InlineArray<vk::DeviceAllocation, 4> memory;
+	InlineArray<vk::Image, 4> images;
+};
 
-	vk::ShaderModule shader_module{ device, nullptr };
-	if (vkCreateShaderModule(device, &create_info, nullptr, shader_module.Replace()) != VK_SUCCESS)
+// A swapchain without a surface, whose images are rendered to but never presented
+Swapchain CreateOffscreenSwapchain(
+	VkDevice device,
+	vk::DeviceMemoryAllocator& allocator,
+	VkFormat format,
+	VkExtent2D extent,
+	uint32_t image_count,
+	OffscreenTargets& out_targets)
+{
+	MU_PROFILE_ZONE("CreateOffscreenSwapchain");
+	InlineArray<VkImage, 4> images;
+	InlineArray<vk::ImageView, 4> image_views;
+	for (uint32_t i = 0; i < image_count; ++i)
 	{
-		throw std::runtime_error("Failed to create shader module");
+		VkImageCreateInfo image_create_info = {
+			VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			nullptr,
+			0,
+			VK_IMAGE_TYPE_2D,
+			format,
+			{ extent.width, extent.height, 1 },
+			1, // mip levels
+			1, // array layers
+			VK_SAMPLE_COUNT_1_BIT,
+			VK_IMAGE_TILING_OPTIMAL,
+			VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+			VK_SHARING_MODE_EXCLUSIVE,
+			0, nullptr,
+			VK_IMAGE_LAYOUT_UNDEFINED
+		};
+		vk::Image image{ device, nullptr };
+		if (vkCreateImage(device, &image_create_info, nullptr, image.Replace()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create offscreen image");
+		}
+		out_targets.memory.Add(allocator.AllocateForImage(image, VK_IMAGE_TILING_OPTIMAL, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+		images.Add(image);
+
+		VkImageViewCreateInfo image_view_create_info{
+			VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO, nullptr,
+			0,
+			image,
+			VK_IMAGE_VIEW_TYPE_2D,
+			format,
+			{ VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY }, // components
+			{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 } // subresourcerange
+		};
+		vk::ImageView view{ device, nullptr };
+		if (vkCreateImageView(device, &image_view_create_info, nullptr, view.Replace()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create image view");
+		}
+		image_views.Add(std::move(view));
+		out_targets.images.Add(std::move(image));
 	}
-	return std::move(shader_module);
+
+	return{ vk::SwapchainKHR{ device, nullptr }, std::move(images), std::move(image_views), format, extent };
 }
 
 vk::PipelineLayout CreatePipelineLayout(VkDevice device)
@@ -353,7 +485,8 @@ vk::PipelineLayout CreatePipelineLayout(VkDevice device)
 	return pipeline_layout;
 }
 
-vk::RenderPass CreateRenderPass(VkDevice device, VkFormat swapchain_format)
+// final_layout is PRESENT_SRC_KHR for swapchain images
+vk::RenderPass CreateRenderPass(VkDevice device, VkFormat swapchain_format, VkImageLayout final_layout)
 {
 	VkAttachmentDescription color_attachment = {
 		0, // flags
@@ -362,7 +495,7 @@ vk::RenderPass CreateRenderPass(VkDevice device, VkFormat swapchain_format)
 		VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE,	// attachment ops
 		VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, // stencil ops
 		VK_IMAGE_LAYOUT_UNDEFINED, // initial layout
-		VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, // final layout
+		final_layout,
 	};
 
 	VkAttachmentReference color_attachment_ref = {
@@ -405,154 +538,137 @@ vk::RenderPass CreateRenderPass(VkDevice device, VkFormat swapchain_format)
 	return std::move(render_pass);
 }
 
-vk::Pipeline CreatePipeline(
-	VkDevice			device, 
-	VkPipelineLayout	pipeline_layout, 
-	VkRenderPass		render_pass, 
-	VkShaderModule		vert_shader, 
-	VkShaderModule		frag_shader, 
-	VkExtent2D			viewport_extent)
+// Pipeline cache files hold this followed by the data from vkGetPipelineCacheData
+struct PipelineCacheFileHeader
 {
-	VkPipelineShaderStageCreateInfo shader_stages[] = {
-		{
-			VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			nullptr,
-			0,
-			VK_SHADER_STAGE_VERTEX_BIT,
-			vert_shader,
-			"main",
-			nullptr
-		},
-		{
-			VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-			nullptr,
-			0,
-			VK_SHADER_STAGE_FRAGMENT_BIT,
-			frag_shader,
-			"main",
-			nullptr
-		}
-	};
-	VkPipelineVertexInputStateCreateInfo vertex_input_info = {
-		VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-		nullptr,
-		0,
-		0, nullptr, // vertex binding description
-		0, nullptr, // vertex attribute description
-	};
-	VkPipelineInputAssemblyStateCreateInfo input_assembly_info = {
-		VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-		nullptr,
-		0,
-		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-		false, // primitive restart enable
-	};
+	uint32_t magic;
+	uint32_t driver_version;	// not part of the driver's own header, but its compiled code is only good for one version
+	uint64_t data_size;
+};
+static const uint32_t PipelineCacheFileMagic = 0x4350554d; // "MUPC"
+static const char* PipelineCachePath = "mu_pipeline_cache.bin";
 
-	VkViewport viewport = {
-		0, 0,
-		float(viewport_extent.width), float(viewport_extent.height),
-		0.0f, 1.0f, // depth range
-	};
+// Every compiled shader, packed by mu_shader_packer when the shaders are built
+static const char* ShaderArchivePath = "../Shaders/Bin/shaders.pak";
 
-	VkRect2D scissor = {
-		{ 0, 0 },
-		{ viewport_extent.width, viewport_extent.height }
-	};
+// Watched for changes by --hot-reload-shaders
+static const char* ShaderSourceDirectory = "../Shaders";
+static const char* ShaderOutputDirectory = "../Shaders/Bin";
 
-	VkPipelineViewportStateCreateInfo viewport_create_info = {
-		VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-		nullptr,
-		0,
-		1, &viewport,
-		1, &scissor
-	};
-	VkPipelineRasterizationStateCreateInfo raster_state_create_info = {
-		VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-		nullptr,
-		0,
-		false, // depth clamp
-		false, // raster discard enable
-		VK_POLYGON_MODE_FILL,
-		VK_CULL_MODE_NONE,
-		VK_FRONT_FACE_CLOCKWISE,
-		false, // depth bias enable
-		0.0f, // constant depth bias
-		0.0f,  // depth bias clamp
-		0.0f, // depth bias slope factor
-		1.0f, // line width
-	};
-
-	VkPipelineMultisampleStateCreateInfo multisample_state_create_info = {
-		VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-		nullptr,
-		0,
-		VK_SAMPLE_COUNT_1_BIT,
-		false, // sample shading enable
-		1.0f, // min sample shading
-		nullptr, // sample mask
-		false, // alpha to coverage
-		false, // alpha to one
-	};
+static const char* VertShaderName = "shader.vert";
+static const char* FragShaderName = "shader.frag";
 
-	VkPipelineColorBlendAttachmentState color_blend_attachment_state = {
-		false, // blend enable
-		VK_BLEND_FACTOR_ONE, // source color blend factor
-		VK_BLEND_FACTOR_ZERO, // dest color blend factor
-		VK_BLEND_OP_ADD, // color blend op
-		VK_BLEND_FACTOR_ONE, // source alpha blend factor
-		VK_BLEND_FACTOR_ZERO, // dest alpha blend factor
-		VK_BLEND_OP_ADD, // alpha blend op
-		VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT, // color mask
-	};
+// Start of the cache data for VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+struct PipelineCacheDataHeader
+{
+	uint32_t header_size;
+	uint32_t header_version;
+	uint32_t vendor_id;
+	uint32_t device_id;
+	uint8_t pipeline_cache_uuid[VK_UUID_SIZE];
+};
 
-	VkPipelineColorBlendStateCreateInfo color_blend_state_create_info = {
-		VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-		nullptr,
-		0,
-		false, // logic op enable
-		VK_LOGIC_OP_COPY, // logic op
-		1, &color_blend_attachment_state, // attachments
-		{ 0.0f, 0.0f, 0.0f, 0.0f }, // blend constants
-	};
+bool IsPipelineCacheCompatible(ranges::PointerRange<const uint8_t> file, const VkPhysicalDeviceProperties& properties)
+{
+	PipelineCacheFileHeader file_header;
+	PipelineCacheDataHeader data_header;
+	if (file.Size() < sizeof(file_header) + sizeof(data_header))
+	{
+		return false;
+	}
+	memcpy(&file_header, file.Data(), sizeof(file_header));
+	memcpy(&data_header, file.Data() + sizeof(file_header), sizeof(data_header));
+	return file_header.magic == PipelineCacheFileMagic
+		&& file_header.driver_version == properties.driverVersion
+		&& file_header.data_size == file.Size() - sizeof(file_header)
+		&& data_header.header_size >= sizeof(data_header)
+		&& data_header.header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& data_header.vendor_id == properties.vendorID
+		&& data_header.device_id == properties.deviceID
+		&& memcmp(data_header.pipeline_cache_uuid, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
 
-	VkDynamicState dynamic_states[] = {
-		//VK_DYNAMIC_STATE_VIEWPORT,
-		VK_DYNAMIC_STATE_LINE_WIDTH,
-	};
+// Starts from the data saved by the last run on the same device and driver, or empty if there is none
+vk::PipelineCache LoadPipelineCache(VkDevice device, const VkPhysicalDeviceProperties& properties, const char* path)
+{
+	MU_PROFILE_ZONE("LoadPipelineCache");
+	MappedFile file = MappedFile::Open(path, FileAccessHint::Sequential);
+	const uint8_t* initial_data = nullptr;
+	size_t initial_data_size = 0;
+	if (file.IsValidFile() && IsPipelineCacheCompatible(file.GetRange(), properties))
+	{
+		initial_data = file.GetRange().Data() + sizeof(PipelineCacheFileHeader);
+		initial_data_size = file.GetFileSize() - sizeof(PipelineCacheFileHeader);
+		dbg::Log("Loaded pipeline cache, ", initial_data_size, " bytes");
+	}
+	else
+	{
+		dbg::Log("No pipeline cache for this device and driver, pipelines will be compiled from scratch");
+	}
 
-	VkPipelineDynamicStateCreateInfo dynamic_state_create_info = {
-		VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+	VkPipelineCacheCreateInfo cache_info = {
+		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
 		nullptr,
 		0,
-		sizeof(dynamic_states) / sizeof(VkDynamicState), dynamic_states
-	};
-
-	VkGraphicsPipelineCreateInfo pipeline_info = {
-		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-		nullptr, 
-		0,
-		2, shader_stages,
-		&vertex_input_info,
-		&input_assembly_info,
-		nullptr, // tesselation state
-		&viewport_create_info,
-		&raster_state_create_info,
-		&multisample_state_create_info,
-		nullptr, // depth stencil info
-		&color_blend_state_create_info,
-		&dynamic_state_create_info,
-		pipeline_layout,
-		render_pass,
-		0, // subpass
-		nullptr, -1 // base pipeline
+		initial_data_size,
+		initial_data
 	};
+	vk::PipelineCache cache{ device, nullptr };
+	if (vkCreatePipelineCache(device, &cache_info, nullptr, cache.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create pipeline cache");
+	}
+	return std::move(cache);
+}
 
-	vk::Pipeline pipeline{ device, nullptr };
-	if (vkCreateGraphicsPipelines(device, nullptr, 1, &pipeline_info, nullptr, pipeline.Replace()) != VK_SUCCESS)
+void SavePipelineCache(VkDevice device, VkPipelineCache cache, const VkPhysicalDeviceProperties& properties, const char* path)
+{
+	MU_PROFILE_ZONE("SavePipelineCache");
+	size_t data_size = 0;
+	if (vkGetPipelineCacheData(device, cache, &data_size, nullptr) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to get pipeline cache size");
+	}
+	auto file = Array<uint8_t>::MakeUninitialized(sizeof(PipelineCacheFileHeader) + data_size);
+	if (vkGetPipelineCacheData(device, cache, &data_size, file.Data() + sizeof(PipelineCacheFileHeader)) != VK_SUCCESS)
 	{
-		throw std::runtime_error("Failed to create pipeline");
+		throw std::runtime_error("Failed to get pipeline cache data");
 	}
-	return std::move(pipeline);
+	const PipelineCacheFileHeader header = { PipelineCacheFileMagic, properties.driverVersion, data_size };
+	memcpy(file.Data(), &header, sizeof(header));
+	SaveFileAtomically(path, Range(file.Data(), sizeof(header) + data_size));
+}
+
+struct Vertex
+{
+	float position[2];
+	float color[3];
+};
+
+struct Instance
+{
+	float offset[2];
+	float scale;
+};
+
+vk::GraphicsPipelineDesc MakePipelineDesc(
+	VkPipelineLayout	pipeline_layout,
+	VkRenderPass		render_pass,
+	VkShaderModule		vert_shader,
+	VkShaderModule		frag_shader)
+{
+	vk::GraphicsPipelineDesc desc;
+	desc.m_layout = pipeline_layout;
+	desc.m_render_pass = render_pass;
+	desc.m_vert_shader = vert_shader;
+	desc.m_frag_shader = frag_shader;
+	desc.m_vertex_bindings.Add({ 0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX });
+	desc.m_vertex_bindings.Add({ 1, sizeof(Instance), VK_VERTEX_INPUT_RATE_INSTANCE });
+	desc.m_vertex_attributes.Add({ 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, position) });
+	desc.m_vertex_attributes.Add({ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color) });
+	desc.m_vertex_attributes.Add({ 2, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(Instance, offset) });
+	desc.m_vertex_attributes.Add({ 3, 1, VK_FORMAT_R32_SFLOAT, offsetof(Instance, scale) });
+	return desc;
 }
 
 Array<vk::Framebuffer> CreateFramebuffers(
@@ -586,12 +702,12 @@ Array<vk::Framebuffer> CreateFramebuffers(
 	return std::move(framebuffers);
 }
 
-vk::CommandPool CreateCommandPool(VkDevice device, const PhysicalDeviceSelection& device_info)
+vk::CommandPool CreateCommandPool(VkDevice device, const PhysicalDeviceSelection& device_info, VkCommandPoolCreateFlags flags = 0)
 {
 	VkCommandPoolCreateInfo pool_info = {
 		VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
 		nullptr,
-		0,
+		flags,
 		device_info.m_graphics_queue_family
 	};
 
@@ -621,46 +737,177 @@ Array<VkCommandBuffer> CreateCommandBuffers(VkDevice device, VkCommandPool comma
 	return std::move(command_buffers);
 }
 
-void RecordCommandBuffers(
-	ranges::PointerRange<VkCommandBuffer> command_buffers,
-	ranges::PointerRange<vk::Framebuffer> framebuffers,
+// Device local buffers can be filled by the transfer queue, so when it is a different family they are shared with it
+vk::Buffer CreateBuffer(VkDevice device, const PhysicalDeviceSelection& device_info, VkDeviceSize size, VkBufferUsageFlags usage)
+{
+	const uint32_t queue_families[] = { device_info.m_graphics_queue_family, device_info.m_transfer_queue_family };
+	const bool shared = device_info.m_transfer_queue_family != device_info.m_graphics_queue_family;
+	VkBufferCreateInfo buffer_info = {
+		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		nullptr,
+		0,
+		size,
+		usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		shared ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+		shared ? 2u : 0u, shared ? queue_families : nullptr
+	};
+
+	vk::Buffer buffer{ device, nullptr };
+	if (vkCreateBuffer(device, &buffer_info, nullptr, buffer.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create buffer");
+	}
+	return std::move(buffer);
+}
+
+// Instances of one mesh, drawn instances_per_draw at a time
+struct Scene
+{
+	vk::DeviceAllocation vertex_memory;
+	vk::DeviceAllocation index_memory;
+	vk::DeviceAllocation instance_memory;
+	vk::Buffer vertex_buffer;
+	vk::Buffer index_buffer;
+	vk::Buffer instance_buffer;
+	uint32_t num_indices = 0;
+	uint32_t num_instances = 0;
+	uint32_t instances_per_draw = 0;
+
+	uint32_t NumDraws() const { return (num_instances + instances_per_draw - 1) / instances_per_draw; }
+};
+
+// A grid of num_instances triangles filling the screen. The buffers are filled through the uploader,
+//	so they are ready once the first frame's submit has waited on its next Flush.
+Scene CreateScene(
+	VkDevice device,
+	const PhysicalDeviceSelection& device_info,
+	vk::DeviceMemoryAllocator& allocator,
+	vk::StagingUploader& uploader,
+	uint32_t num_instances,
+	uint32_t instances_per_draw)
+{
+	MU_PROFILE_ZONE("CreateScene");
+	const Vertex vertices[] = {
+		{ { 0.0f, -0.5f }, { 1.0f, 0.0f, 0.0f } },
+		{ { 0.5f, 0.5f }, { 0.0f, 1.0f, 0.0f } },
+		{ { -0.5f, 0.5f }, { 0.0f, 0.0f, 1.0f } },
+	};
+	const uint16_t indices[] = { 0, 1, 2 };
+
+	// One instance is the whole triangle, more shrink it into the cells of a square grid
+	const uint32_t grid_size = uint32_t(ceil(sqrt(double(num_instances))));
+	const float cell_size = 2.0f / grid_size;
+	auto instances = Array<Instance>::MakeUninitialized(num_instances);
+	for (uint32_t i = 0; i < num_instances; ++i)
+	{
+		instances[i] = num_instances == 1 ? Instance{ { 0.0f, 0.0f }, 1.0f }
+			: Instance{ { -1.0f + cell_size * (i % grid_size + 0.5f), -1.0f + cell_size * (i / grid_size + 0.5f) }, cell_size };
+	}
+
+	Scene scene;
+	scene.num_indices = uint32_t(sizeof(indices) / sizeof(uint16_t));
+	scene.num_instances = num_instances;
+	scene.instances_per_draw = instances_per_draw > 0 ? instances_per_draw : num_instances;
+
+	const VkMemoryPropertyFlags device_local = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	scene.vertex_buffer = CreateBuffer(device, device_info, sizeof(vertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+	scene.vertex_memory = allocator.AllocateForBuffer(scene.vertex_buffer, device_local);
+	uploader.UploadToBuffer(scene.vertex_buffer, 0, vertices, sizeof(vertices));
+
+	scene.index_buffer = CreateBuffer(device, device_info, sizeof(indices), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+	scene.index_memory = allocator.AllocateForBuffer(scene.index_buffer, device_local);
+	uploader.UploadToBuffer(scene.index_buffer, 0, indices, sizeof(indices));
+
+	const VkDeviceSize instances_size = sizeof(Instance) * instances.Num();
+	scene.instance_buffer = CreateBuffer(device, device_info, instances_size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+	scene.instance_memory = allocator.AllocateForBuffer(scene.instance_buffer, device_local);
+	uploader.UploadToBuffer(scene.instance_buffer, 0, instances.Data(), instances_size);
+
+	return std::move(scene);
+}
+
+// slot picks the GPU profiler's queries and the recorder's set of secondary command buffers
+void RecordCommandBuffer(
+	VkCommandBuffer command_buffer,
+	VkCommandBufferUsageFlags usage,
+	uint32_t slot,
+	VkFramebuffer framebuffer,
 	VkPipeline graphics_pipeline,
 	VkRenderPass render_pass,
-	VkExtent2D framebuffer_extent)
+	VkExtent2D framebuffer_extent,
+	const Scene& scene,
+	prof::GpuProfiler& gpu_profiler,
+	vk::ParallelCommandRecorder& recorder)
 {
-	for (tuple<VkCommandBuffer&, vk::Framebuffer&> pair : Zip(command_buffers, framebuffers))
+	MU_PROFILE_ZONE("RecordCommandBuffer");
+	VkCommandBufferBeginInfo begin_info = {
+		VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		nullptr,
+		usage,
+		nullptr // inheritance info
+	};
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+	gpu_profiler.CmdBeginSlot(command_buffer, slot);
 	{
-		VkCommandBuffer command_buffer = std::get<0>(pair);
-		VkFramebuffer framebuffer = std::get<1>(pair);
-
-		VkCommandBufferBeginInfo begin_info = {
-			VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		MU_GPU_PROFILE_ZONE(gpu_profiler, command_buffer, slot, "RenderPass");
+		VkClearValue clear_color = { 0.0f, 0.0f, 0.0f, 1.0f };
+		VkRenderPassBeginInfo begin_pass = {
+			VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
 			nullptr,
-			VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
-			nullptr // inheritance info
+			render_pass,
+			framebuffer,
+			{ {0,0}, framebuffer_extent },
+			1, &clear_color
 		};
-		vkBeginCommandBuffer(command_buffer, &begin_info);
+		vkCmdBeginRenderPass(command_buffer, &begin_pass, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 		{
-			VkClearValue clear_color = { 0.0f, 0.0f, 0.0f, 1.0f };
-			VkRenderPassBeginInfo begin_pass = {
-				VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-				nullptr,
-				render_pass,
-				framebuffer,
-				{ {0,0}, framebuffer_extent },
-				1, &clear_color
-			};
-			vkCmdBeginRenderPass(command_buffer, &begin_pass, VK_SUBPASS_CONTENTS_INLINE);
+			// Secondary command buffers inherit no state, so every slice binds and sets everything it draws with
+			const VkViewport viewport = { 0.0f, 0.0f, float(framebuffer_extent.width), float(framebuffer_extent.height), 0.0f, 1.0f };
+			const VkRect2D scissor = { { 0, 0 }, framebuffer_extent };
+			recorder.Record(command_buffer, slot, render_pass, 0, framebuffer, usage, scene.NumDraws(),
+				[graphics_pipeline, viewport, scissor, &scene](VkCommandBuffer slice_buffer, size_t begin, size_t end)
 			{
-				vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline);
-				vkCmdDraw(command_buffer, 3, 1, 0, 0);
-			}
-			vkCmdEndRenderPass(command_buffer);
-		}
-		if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
-		{
-			throw std::runtime_error("Failed to record command buffer");
+				vkCmdBindPipeline(slice_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipeline);
+				vkCmdSetViewport(slice_buffer, 0, 1, &viewport);
+				vkCmdSetScissor(slice_buffer, 0, 1, &scissor);
+				const VkBuffer vertex_buffers[] = { scene.vertex_buffer, scene.instance_buffer };
+				const VkDeviceSize vertex_offsets[] = { 0, 0 };
+				vkCmdBindVertexBuffers(slice_buffer, 0, 2, vertex_buffers, vertex_offsets);
+				vkCmdBindIndexBuffer(slice_buffer, scene.index_buffer, 0, VK_INDEX_TYPE_UINT16);
+				for (size_t draw = begin; draw < end; ++draw)
+				{
+					const uint32_t first_instance = uint32_t(draw) * scene.instances_per_draw;
+					const uint32_t num_instances = Min(scene.instances_per_draw, scene.num_instances - first_instance);
+					vkCmdDrawIndexed(slice_buffer, scene.num_indices, num_instances, 0, 0, first_instance);
+				}
+			});
 		}
+		vkCmdEndRenderPass(command_buffer);
+	}
+	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to record command buffer");
+	}
+}
+
+// Records each swapchain image's command buffer once, to be replayed every frame
+void RecordCommandBuffers(
+	ranges::PointerRange<VkCommandBuffer> command_buffers,
+	ranges::PointerRange<vk::Framebuffer> framebuffers,
+	VkPipeline graphics_pipeline,
+	VkRenderPass render_pass,
+	VkExtent2D framebuffer_extent,
+	const Scene& scene,
+	prof::GpuProfiler& gpu_profiler,
+	vk::ParallelCommandRecorder& recorder)
+{
+	MU_PROFILE_ZONE("RecordCommandBuffers");
+	uint32_t slot = 0;
+	for (tuple<VkCommandBuffer&, vk::Framebuffer&> pair : Zip(command_buffers, framebuffers))
+	{
+		RecordCommandBuffer(std::get<0>(pair), VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, slot, std::get<1>(pair),
+			graphics_pipeline, render_pass, framebuffer_extent, scene, gpu_profiler, recorder);
+		++slot;
 	}
 }
 
@@ -689,6 +936,111 @@ void CreateSemaphores(VkDevice device, SEMAPHORES&... semaphores)
 	CreateSemaphoresRec(device, semaphore_info, semaphores...);
 }
 
+// The CPU records and submits up to this many frames before waiting for the GPU to finish the oldest
+static const uint32_t DefaultFramesInFlight = 2;
+static const uint32_t MaxFramesInFlight = 3;
+
+// Enough to stream a few frames of meshes and textures before an upload has to wait for the GPU
+static const VkDeviceSize StagingBufferSize = 16 * 1024 * 1024;
+
+struct FrameResources
+{
+	vk::Semaphore image_available;
+	vk::Semaphore render_finished;
+	vk::Fence in_flight;	// signalled once the frame's submit has finished on the GPU
+	vk::CommandPool command_pool;	// transient, reset as a whole before the frame is recorded again
+	VkCommandBuffer command_buffer = nullptr;
+};
+
+InlineArray<FrameResources, MaxFramesInFlight> CreateFrameResources(VkDevice device, const PhysicalDeviceSelection& device_info, uint32_t frames_in_flight)
+{
+	// Created signalled so the first wait on each frame returns immediately
+	VkFenceCreateInfo fence_info = {
+		VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+		nullptr,
+		VK_FENCE_CREATE_SIGNALED_BIT
+	};
+
+	InlineArray<FrameResources, MaxFramesInFlight> frames;
+	for (uint32_t i = 0; i < frames_in_flight; ++i)
+	{
+		FrameResources frame;
+		CreateSemaphores(device, frame.image_available, frame.render_finished);
+		frame.in_flight = vk::Fence{ device, nullptr };
+		if (vkCreateFence(device, &fence_info, nullptr, frame.in_flight.Replace()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create fence");
+		}
+		frame.command_pool = CreateCommandPool(device, device_info, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		frame.command_buffer = CreateCommandBuffers(device, frame.command_pool, 1)[0];
+		frames.Emplace(std::move(frame));
+	}
+	return std::move(frames);
+}
+
+struct Options
+{
+	uint32_t frames_in_flight = DefaultFramesInFlight;
+	bool prebaked_command_buffers = false;	// record once per swapchain image at startup instead of every frame
+	uint32_t num_instances = 1;
+	uint32_t instances_per_draw = 0;	// 0 draws them all at once
+	bool headless = false;	// render offscreen without a window, for running where there is no display
+	uint32_t num_frames = 1000;	// frames rendered before a headless run exits
+	bool hot_reload_shaders = false;
+	const char* binary_log_path = nullptr;	// MU_LOG writes to this binary log as well, for long sessions
+};
+
+// --frames-in-flight N, clamped to 1 to MaxFramesInFlight
+// --prebaked-command-buffers
+// --instances N, at least 1. Use 100000 or more to measure the draw path.
+// --instances-per-draw N, 1 makes a draw call for every instance
+// --headless renders offscreen and reports frame times after --frames N frames
+// --hot-reload-shaders recompiles shaders when their source changes and rebuilds the pipelines using them
+// --binary-log PATH writes MU_LOG messages to a binary log, read it with mu_log_decoder
+Options ParseOptions(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+		{
+			options.frames_in_flight = uint32_t(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--prebaked-command-buffers") == 0)
+		{
+			options.prebaked_command_buffers = true;
+		}
+		else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+		{
+			options.num_instances = uint32_t(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--instances-per-draw") == 0 && i + 1 < argc)
+		{
+			options.instances_per_draw = uint32_t(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--headless") == 0)
+		{
+			options.headless = true;
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			options.num_frames = uint32_t(atoi(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--hot-reload-shaders") == 0)
+		{
+			options.hot_reload_shaders = true;
+		}
+		else if (strcmp(argv[i], "--binary-log") == 0 && i + 1 < argc)
+		{
+			options.binary_log_path = argv[++i];
+		}
+	}
+	const uint32_t max_frames_in_flight = MaxFramesInFlight;
+	options.frames_in_flight = Clamp(options.frames_in_flight, 1u, max_frames_in_flight);
+	options.num_instances = options.num_instances > 0 ? options.num_instances : 1;
+	return options;
+}
+
 
 /*! @brief The function signature for keyboard key callbacks.
 *
@@ -710,123 +1062,594 @@ void CreateSemaphores(VkDevice device, SEMAPHORES&... semaphores)
 *  @ingroup input
 */
 bool bAllowAppStart = false;
-void GLFW_OnKeyPressed(GLFWwindow*, int, int, int, int)
+bool bToggleProfileCapture = false;
+void GLFW_OnKeyPressed(GLFWwindow*, int key, int, int action, int)
 {
+	if (bAllowAppStart && key == GLFW_KEY_P && action == GLFW_PRESS)
+	{
+		bToggleProfileCapture = true;
+	}
 	bAllowAppStart = true;
 }
 
-int main(int, char**)
+// Set when the window is resized, as not every platform reports it through the swapchain
+bool bFramebufferResized = false;
+void GLFW_OnFramebufferResized(GLFWwindow*, int, int)
 {
-	if (!glfwInit())
-	{
-		return 1;
-	}
-	SCOPE_EXIT(glfwTerminate());
+	bFramebufferResized = true;
+}
+
+// Size of the images rendered to in headless mode
+static const VkExtent2D HeadlessExtent = { 1280, 720 };
+
+int main(int argc, char** argv)
+{
+	const Options options = ParseOptions(argc, argv);
+	const uint32_t frames_in_flight = options.frames_in_flight;
+	const bool headless = options.headless;
 
-	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-	GLFWwindow* window = glfwCreateWindow(1280, 720, "mu", nullptr, nullptr);
-	if (!window)
+	if (!headless && !glfwInit())
 	{
 		return 1;
 	}
+	SCOPE_EXIT(if (!headless) { glfwTerminate(); });
 
-	glfwSetKeyCallback(window, GLFW_OnKeyPressed);
-	while (!glfwWindowShouldClose(window) && !bAllowAppStart)
+	GLFWwindow* window = nullptr;
+	if (!headless)
 	{
-		glfwPollEvents();
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+		window = glfwCreateWindow(1280, 720, "mu", nullptr, nullptr);
+		if (!window)
+		{
+			return 1;
+		}
+
+		glfwSetKeyCallback(window, GLFW_OnKeyPressed);
+		glfwSetFramebufferSizeCallback(window, GLFW_OnFramebufferResized);
+		while (!glfwWindowShouldClose(window) && !bAllowAppStart)
+		{
+			glfwPollEvents();
+		}
 	}
 
-	SCOPE_EXIT(glfwDestroyWindow(window));
+	SCOPE_EXIT(if (window) { glfwDestroyWindow(window); });
+
+	// Startup is always captured, press P to capture a range of frames
+	prof::BeginCapture();
+	const uint64_t startup_ticks = prof::GetTicks();
 
 	vk::Instance instance;
 	vk::DebugReportCallbackEXT debug_callbacks;
 	vk::Device device;
+	std::unique_ptr<vk::DeviceMemoryAllocator> memory_allocator;
+	vk::StagingUploader uploader;
+	Scene scene;
 	vk::SurfaceKHR surface;
+	PhysicalDeviceSelection selected_device = {};
+	OffscreenTargets offscreen_targets;
 	Swapchain swapchain;
-	VkQueue graphics_queue, present_queue;
-	vk::ShaderModule vert_shader, frag_shader;
+	VkQueue graphics_queue, present_queue, transfer_queue;
+	vk::ShaderLibrary shader_library;
 	vk::PipelineLayout pipeline_layout;
 	vk::RenderPass render_pass;
+	VkPhysicalDeviceProperties device_properties = {};
+	vk::PipelineCache pipeline_cache;
+	vk::PipelineBuilder pipeline_builder;
 	vk::Pipeline pipeline;
 	Array<vk::Framebuffer> framebuffers;
 	vk::CommandPool command_pool;
 	Array<VkCommandBuffer> command_buffers;
-	vk::Semaphore image_available_semaphore, render_finished_semaphore;
-	try
+	vk::ParallelCommandRecorder recorder;
+	prof::GpuProfiler gpu_profiler;
+	InlineArray<FrameResources, MaxFramesInFlight> frames;
+	LinearArena startup_scratch{ 256 * 1024 };
+
+	// Opened before any other thread is started, such as the pipeline builder's
+	if (options.binary_log_path && !dbg::OpenBinaryLog(options.binary_log_path))
 	{
-		CreateVulkanInstance(instance);
-		RegisterDebugCallback(instance, debug_callbacks);
+		dbg::Log("Failed to open binary log ", options.binary_log_path);
+	}
 
-		surface = vk::SurfaceKHR{ instance, nullptr };
-		VkResult err = glfwCreateWindowSurface(instance, window, nullptr, surface.Replace());
-		if (err)
+	try
+	{
+		MU_PROFILE_ZONE("InitVulkan");
+		bool debug_report = false;
+		CreateVulkanInstance(headless, startup_scratch, instance, debug_report);
+		if (debug_report)
 		{
-			throw std::runtime_error("Failed to create surface");
+			RegisterDebugCallback(instance, debug_callbacks);
 		}
 
-		Array<const char*> device_extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
-		PhysicalDeviceSelection selected_device = SelectPhysicalDevice(device_extensions, instance, surface);
-		CreateDevice(selected_device, device_extensions, window, instance, surface, device, graphics_queue, present_queue);
-		swapchain = CreateSwapChain(window, selected_device, device, surface);
+		NameList device_extensions;
+		if (!headless)
+		{
+			surface = vk::SurfaceKHR{ instance, nullptr };
+			VkResult err = glfwCreateWindowSurface(instance, window, nullptr, surface.Replace());
+			if (err)
+			{
+				throw std::runtime_error("Failed to create surface");
+			}
+			device_extensions.Add(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		}
 
-		auto vert_shader_code = LoadFileToArray("../Shaders/Bin/shader.vert.spv");
-		vert_shader = CreateShaderModule(device, Range(vert_shader_code));
+		selected_device = SelectPhysicalDevice(device_extensions, instance, surface, startup_scratch);
+		device_properties = selected_device.m_device_properties;
+		CreateDevice(selected_device, device_extensions, window, instance, surface, startup_scratch, device, graphics_queue, present_queue, transfer_queue);
+		memory_allocator.reset(new vk::DeviceMemoryAllocator(selected_device.m_device, device));
+		// One more batch than frames in flight so a frame's uploads never wait on the frame before
+		uploader = vk::StagingUploader(selected_device.m_device, device, *memory_allocator, selected_device.m_transfer_queue_family, transfer_queue,
+			StagingBufferSize, frames_in_flight + 1);
+		if (headless)
+		{
+			// One image per frame in flight, so image_index can follow frame_index without an acquire
+			swapchain = CreateOffscreenSwapchain(device, *memory_allocator, VK_FORMAT_B8G8R8A8_UNORM, HeadlessExtent,
+				frames_in_flight, offscreen_targets);
+		}
+		else
+		{
+			swapchain = CreateSwapChain(window, selected_device, device, surface, startup_scratch);
+		}
 
-		auto frag_shader_code = LoadFileToArray("../Shaders/Bin/shader.frag.spv");
-		frag_shader = CreateShaderModule(device, Range(frag_shader_code));
+		shader_library = vk::ShaderLibrary(device, ShaderArchivePath);
+		VkShaderModule vert_shader = shader_library.GetModule(VertShaderName);
+		VkShaderModule frag_shader = shader_library.GetModule(FragShaderName);
 
 		pipeline_layout = CreatePipelineLayout(device);
-		render_pass = CreateRenderPass(device, swapchain.image_format);
-		pipeline = CreatePipeline(device, pipeline_layout, render_pass, vert_shader, frag_shader, swapchain.extent);
+		render_pass = CreateRenderPass(device, swapchain.image_format,
+			headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+		pipeline_cache = LoadPipelineCache(device, selected_device.m_device_properties, PipelineCachePath);
+
+		// Pipelines compile on the builder's threads while the scene uploads and the rest of startup runs
+		pipeline_builder = vk::PipelineBuilder(device, pipeline_cache);
+		std::future<vk::Pipeline> startup_pipeline = pipeline_builder.Build(
+			MakePipelineDesc(pipeline_layout, render_pass, vert_shader, frag_shader));
+
+		scene = CreateScene(device, selected_device, *memory_allocator, uploader, options.num_instances, options.instances_per_draw);
+		MU_LOG("Scene: {} instances in {} draws", scene.num_instances, scene.NumDraws());
 		framebuffers = CreateFramebuffers(device, render_pass, swapchain);
-		command_pool = CreateCommandPool(device, selected_device);
-		command_buffers = CreateCommandBuffers(device, command_pool, uint32_t(framebuffers.Num()));
-		RecordCommandBuffers(Range(command_buffers), Range(framebuffers), pipeline, render_pass, swapchain.extent);
-		CreateSemaphores(device, image_available_semaphore, render_finished_semaphore);
+		frames = CreateFrameResources(device, selected_device, frames_in_flight);
+		if (options.prebaked_command_buffers)
+		{
+			// Each image's command buffer keeps its own profiler slot and set of secondary buffers
+			command_pool = CreateCommandPool(device, selected_device);
+			command_buffers = CreateCommandBuffers(device, command_pool, uint32_t(framebuffers.Num()));
+			gpu_profiler = prof::GpuProfiler(selected_device.m_device, device, graphics_queue, selected_device.m_graphics_queue_family, uint32_t(command_buffers.Num()));
+			recorder = vk::ParallelCommandRecorder(device, selected_device.m_graphics_queue_family, uint32_t(command_buffers.Num()));
+		}
+		else
+		{
+			// Each frame in flight records into its own command pools, slot and set
+			gpu_profiler = prof::GpuProfiler(selected_device.m_device, device, graphics_queue, selected_device.m_graphics_queue_family, frames_in_flight);
+			recorder = vk::ParallelCommandRecorder(device, selected_device.m_graphics_queue_family, frames_in_flight, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		}
+
+		{
+			MU_PROFILE_ZONE("WaitForPipelines");
+			const uint64_t wait_begin = prof::GetTicks();
+			pipeline = startup_pipeline.get();
+			MU_LOG("Pipelines ready {}ms after startup, waited {}ms for them",
+				double(prof::GetTicks() - startup_ticks) * prof::GetSecondsPerTick() * 1000.0,
+				double(prof::GetTicks() - wait_begin) * prof::GetSecondsPerTick() * 1000.0);
+		}
+		if (options.prebaked_command_buffers)
+		{
+			RecordCommandBuffers(Range(command_buffers), Range(framebuffers), pipeline, render_pass, swapchain.extent, scene, gpu_profiler, recorder);
+		}
 	}
-	catch (const std::runtime_error& e)
+	catch (const std::exception& e)
 	{
 		dbg::Log("InitVulkan error: ", e.what());
+		dbg::CloseBinaryLog();
 		return 1;
 	}
 
-	while (!glfwWindowShouldClose(window))
+	prof::EndFrame();
+	prof::LogFrame(prof::GetLastFrame());
+	prof::EndCapture("mu_startup_trace.json");
+
+	// Shaders are recompiled on the reloader's thread and the pipeline using them is rebuilt on
+	//	another, so the frame loop only swaps the finished pipeline in
+	std::unique_ptr<ShaderHotReloader> shader_reloader;
+	if (options.hot_reload_shaders)
+	{
+		try
+		{
+			shader_reloader.reset(new ShaderHotReloader(ShaderSourceDirectory, ShaderOutputDirectory));
+		}
+		catch (const std::exception& e)
+		{
+			dbg::Log("Shader hot reload disabled: ", e.what());
+		}
+	}
+	Array<ShaderHotReloader::CompiledShader> reloaded_shaders;
+	std::future<vk::Pipeline> pending_pipeline;
+	// Replaced pipelines, destroyed once no frame submitted before the swap can still be using them
+	struct RetiredPipeline
+	{
+		vk::Pipeline pipeline;
+		uint32_t retired_at;	// frames rendered when it was replaced
+	};
+	Array<RetiredPipeline> retired_pipelines;
+
+	// The frame loop is expected not to touch the heap, report any frame which does
+	size_t last_heap_allocations = HeapAllocator().GetStats().m_num_allocations;
+
+	// Prebaked command buffers belong to swapchain images, so a frame must also wait for any earlier
+	//	frame still using its image's command buffer. Holds the fence of the frame which last used each image.
+	InlineArray<VkFence, 4> image_fences;
+	for (size_t i = 0; i < swapchain.images.Num(); ++i)
+	{
+		image_fences.Add(nullptr);
+	}
+	uint32_t frame_index = 0;
+
+	// Reported about once a second to compare frames in flight settings
+	uint32_t stats_num_frames = 0;
+	double stats_frame_seconds = 0.0;
+	double stats_wait_seconds = 0.0;
+	double stats_record_seconds = 0.0;
+	double stats_gpu_busy_seconds = gpu_profiler.GetBusySeconds();
+
+	// Rebuilds only what depends on the swapchain's images and extent. The render pass and pipeline
+	//	are kept, as the pipeline's viewport and scissor are set while recording.
+	auto recreate_swapchain = [&]()
+	{
+		// A minimized window has nothing to render to, so wait until it's restored
+		int fb_width = 0, fb_height = 0;
+		glfwGetFramebufferSize(window, &fb_width, &fb_height);
+		while ((fb_width == 0 || fb_height == 0) && !glfwWindowShouldClose(window))
+		{
+			glfwWaitEvents();
+			glfwGetFramebufferSize(window, &fb_width, &fb_height);
+		}
+		if (glfwWindowShouldClose(window))
+		{
+			return;
+		}
+		bFramebufferResized = false;
+
+		MU_PROFILE_ZONE("RecreateSwapchain");
+		const uint64_t recreate_begin = prof::GetTicks();
+		// Frames in flight still use the framebuffers and the old swapchain's images
+		vkDeviceWaitIdle(device);
+		framebuffers.Clear();
+
+		// Nothing allocated from the scratch arena during startup is still alive
+		startup_scratch.Reset();
+		Swapchain new_swapchain = CreateSwapChain(window, selected_device, device, surface, startup_scratch, swapchain.handle);
+		const size_t old_num_images = swapchain.images.Num();
+		swapchain.image_views.Clear();
+		swapchain = std::move(new_swapchain);
+		framebuffers = CreateFramebuffers(device, render_pass, swapchain);
+
+		image_fences.Clear();
+		for (size_t i = 0; i < swapchain.images.Num(); ++i)
+		{
+			image_fences.Add(nullptr);
+		}
+
+		if (options.prebaked_command_buffers)
+		{
+			if (swapchain.images.Num() != old_num_images)
+			{
+				// Each image has its own command buffer, profiler slot and set of secondary buffers
+				command_buffers.Clear();
+				command_pool = CreateCommandPool(device, selected_device);
+				command_buffers = CreateCommandBuffers(device, command_pool, uint32_t(framebuffers.Num()));
+				gpu_profiler = prof::GpuProfiler(selected_device.m_device, device, graphics_queue, selected_device.m_graphics_queue_family, uint32_t(command_buffers.Num()));
+				recorder = vk::ParallelCommandRecorder(device, selected_device.m_graphics_queue_family, uint32_t(command_buffers.Num()));
+				stats_gpu_busy_seconds = gpu_profiler.GetBusySeconds();
+			}
+			else
+			{
+				if (vkResetCommandPool(device, command_pool, 0) != VK_SUCCESS)
+				{
+					throw std::runtime_error("Failed to reset command pool");
+				}
+				for (uint32_t i = 0; i < uint32_t(command_buffers.Num()); ++i)
+				{
+					recorder.Reset(i);
+				}
+			}
+			RecordCommandBuffers(Range(command_buffers), Range(framebuffers), pipeline, render_pass, swapchain.extent, scene, gpu_profiler, recorder);
+		}
+		MU_LOG("Recreated the swapchain at {}x{} in {}ms", swapchain.extent.width, swapchain.extent.height,
+			double(prof::GetTicks() - recreate_begin) * prof::GetSecondsPerTick() * 1000.0);
+	};
+
+	// Totals over the whole run, reported at the end of a headless run
+	uint32_t frames_rendered = 0;
+	double total_wait_seconds = 0.0;
+	double total_record_seconds = 0.0;
+	const double start_gpu_busy_seconds = gpu_profiler.GetBusySeconds();
+	const uint64_t start_ticks = prof::GetTicks();
+	while (headless ? frames_rendered < options.num_frames : !glfwWindowShouldClose(window))
 	{
-		glfwPollEvents();
+		// Zones from the previous iteration make up its frame. A running capture keeps every zone
+		//	on the heap, so expect heap allocation reports until it ends.
+		prof::EndFrame();
+		++stats_num_frames;
+		stats_frame_seconds += prof::GetLastFrame().m_seconds;
+		if (stats_frame_seconds >= 1.0)
+		{
+			// GPU time is only known for frames whose timestamps have been read back, which lags
+			//	by up to the number of frames in flight but evens out over the period
+			const double gpu_busy_seconds = gpu_profiler.GetBusySeconds();
+			const double gpu_idle = gpu_profiler.IsEnabled() ? 1.0 - (gpu_busy_seconds - stats_gpu_busy_seconds) / stats_frame_seconds : 0.0;
+			MU_LOG("{} frames in flight: {}ms per frame, {}ms recording, {}ms waiting for the GPU, GPU idle {}%", frames_in_flight,
+				stats_frame_seconds * 1000.0 / stats_num_frames, stats_record_seconds * 1000.0 / stats_num_frames,
+				stats_wait_seconds * 1000.0 / stats_num_frames, gpu_idle * 100.0);
+			total_wait_seconds += stats_wait_seconds;
+			total_record_seconds += stats_record_seconds;
+			stats_num_frames = 0;
+			stats_frame_seconds = 0.0;
+			stats_wait_seconds = 0.0;
+			stats_record_seconds = 0.0;
+			stats_gpu_busy_seconds = gpu_busy_seconds;
+		}
+
+		if (bToggleProfileCapture)
+		{
+			bToggleProfileCapture = false;
+			if (!prof::IsCapturing())
+			{
+				prof::BeginCapture();
+			}
+			else if (prof::EndCapture("mu_trace.json"))
+			{
+				dbg::Log("Wrote profile capture to mu_trace.json");
+			}
+		}
+
+		MU_PROFILE_ZONE("Frame");
+		if (!headless)
+		{
+			glfwPollEvents();
+		}
+
+		// Only wait for the frame whose semaphores and fence are about to be reused
+		FrameResources& frame = frames[frame_index];
+		VkFence frame_fence = frame.in_flight;
+		{
+			MU_PROFILE_ZONE("WaitForFrame");
+			const uint64_t wait_begin = prof::GetTicks();
+			vkWaitForFences(device, 1, &frame_fence, VK_TRUE, UINT64_MAX);
+			stats_wait_seconds += double(prof::GetTicks() - wait_begin) * prof::GetSecondsPerTick();
+		}
+		// Reads the timestamps of every frame whose fence has signalled, including this one
+		gpu_profiler.Collect();
 
-		uint32_t image_index = 0;
-		vkAcquireNextImageKHR(device, swapchain.handle, UINT64_MAX, image_available_semaphore, nullptr, &image_index);
+		// Frames finish in submission order, so once this frame's fence has signalled every frame
+		//	submitted frames_in_flight or more frames ago has too
+		if (!retired_pipelines.IsEmpty() && frames_rendered >= retired_pipelines[retired_pipelines.Num() - 1].retired_at + frames_in_flight)
+		{
+			retired_pipelines.Clear();
+		}
 
-		VkSemaphore submit_wait_semaphores[] = { image_available_semaphore };
-		VkPipelineStageFlags submit_wait_stages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-		VkSemaphore signal_semaphores[] = { render_finished_semaphore };
+		// A module may only be replaced while no pipeline is being created from it
+		if (shader_reloader && !pending_pipeline.valid() && shader_reloader->TakeCompiled(reloaded_shaders))
+		{
+			MU_PROFILE_ZONE("ReloadShaders");
+			bool rebuild_pipeline = false;
+			for (const ShaderHotReloader::CompiledShader& shader : reloaded_shaders)
+			{
+				try
+				{
+					if (!shader_library.Reload(shader.m_name.c_str(), Range(shader.m_code)))
+					{
+						dbg::Log("Reloaded shader ", shader.m_name.c_str(), " isn't in the shader archive");
+						continue;
+					}
+				}
+				catch (const std::exception& e)
+				{
+					dbg::Log("Failed to reload shader: ", e.what());
+					continue;
+				}
+				rebuild_pipeline = rebuild_pipeline || shader.m_name == VertShaderName || shader.m_name == FragShaderName;
+			}
+			reloaded_shaders.Clear();
+
+			if (rebuild_pipeline)
+			{
+				pending_pipeline = pipeline_builder.Build(MakePipelineDesc(pipeline_layout, render_pass,
+					shader_library.GetModule(VertShaderName), shader_library.GetModule(FragShaderName)));
+			}
+		}
+
+		if (pending_pipeline.valid() && pending_pipeline.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			vk::Pipeline rebuilt_pipeline;
+			try
+			{
+				rebuilt_pipeline = pending_pipeline.get();
+			}
+			catch (const std::exception& e)
+			{
+				dbg::Log("Failed to rebuild pipeline, keeping the old one: ", e.what());
+			}
+			if (rebuilt_pipeline != VK_NULL_HANDLE)
+			{
+				retired_pipelines.Add(RetiredPipeline{ std::move(pipeline), frames_rendered });
+				pipeline = std::move(rebuilt_pipeline);
+				if (options.prebaked_command_buffers)
+				{
+					// Every image's commands bind the old pipeline, so wait for them all and record them again
+					vkDeviceWaitIdle(device);
+					retired_pipelines.Clear();
+					if (vkResetCommandPool(device, command_pool, 0) != VK_SUCCESS)
+					{
+						throw std::runtime_error("Failed to reset command pool");
+					}
+					for (uint32_t i = 0; i < uint32_t(command_buffers.Num()); ++i)
+					{
+						recorder.Reset(i);
+					}
+					RecordCommandBuffers(Range(command_buffers), Range(framebuffers), pipeline, render_pass, swapchain.extent, scene, gpu_profiler, recorder);
+				}
+				dbg::Log("Swapped in the rebuilt pipeline");
+			}
+		}
+
+		// Offscreen images are only reused once the frame's fence has signalled, so need no acquire
+		uint32_t image_index = frame_index;
+		if (!headless)
+		{
+			VkResult acquire_result = VK_SUCCESS;
+			{
+				MU_PROFILE_ZONE("AcquireNextImage");
+				acquire_result = vkAcquireNextImageKHR(device, swapchain.handle, UINT64_MAX, frame.image_available, nullptr, &image_index);
+			}
+			if (acquire_result == VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				// Nothing was acquired, so the frame's semaphore and fence are left as they were for its next try
+				recreate_swapchain();
+				continue;
+			}
+			// A suboptimal image can still be presented, the swapchain is recreated after presenting it
+			if (acquire_result != VK_SUCCESS && acquire_result != VK_SUBOPTIMAL_KHR)
+			{
+				throw std::runtime_error("Failed to acquire swapchain image");
+			}
+		}
+
+		VkCommandBuffer command_buffer = nullptr;
+		uint32_t slot = 0;
+		if (options.prebaked_command_buffers)
+		{
+			if (image_fences[image_index] != nullptr && image_fences[image_index] != frame_fence)
+			{
+				MU_PROFILE_ZONE("WaitForImage");
+				const uint64_t wait_begin = prof::GetTicks();
+				vkWaitForFences(device, 1, &image_fences[image_index], VK_TRUE, UINT64_MAX);
+				stats_wait_seconds += double(prof::GetTicks() - wait_begin) * prof::GetSecondsPerTick();
+			}
+			image_fences[image_index] = frame_fence;
+			command_buffer = command_buffers[image_index];
+			slot = image_index;
+		}
+		else
+		{
+			// The frame's fence has signalled, so nothing recorded from its pools is still executing
+			const uint64_t record_begin = prof::GetTicks();
+			if (vkResetCommandPool(device, frame.command_pool, 0) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to reset command pool");
+			}
+			recorder.Reset(frame_index);
+			RecordCommandBuffer(frame.command_buffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, frame_index, framebuffers[image_index],
+				pipeline, render_pass, swapchain.extent, scene, gpu_profiler, recorder);
+			stats_record_seconds += double(prof::GetTicks() - record_begin) * prof::GetSecondsPerTick();
+			command_buffer = frame.command_buffer;
+			slot = frame_index;
+		}
+
+		// Anything uploaded this frame must land before the frame's commands read it, whatever stage they read it from
+		VkSemaphore upload_done = uploader.Flush();
+		InlineArray<VkSemaphore, 2> submit_wait_semaphores;
+		InlineArray<VkPipelineStageFlags, 2> submit_wait_stages;
+		if (!headless)
+		{
+			submit_wait_semaphores.Add(frame.image_available);
+			submit_wait_stages.Add(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+		}
+		if (upload_done != VK_NULL_HANDLE)
+		{
+			submit_wait_semaphores.Add(upload_done);
+			submit_wait_stages.Add(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+		}
+		VkSemaphore signal_semaphores[] = { frame.render_finished };
 		VkSubmitInfo submit_info = {
 			VK_STRUCTURE_TYPE_SUBMIT_INFO,
 			nullptr,
-			1, submit_wait_semaphores, submit_wait_stages,
-			1, &command_buffers[image_index],
-			1, signal_semaphores,
+			uint32_t(submit_wait_semaphores.Num()), submit_wait_semaphores.Data(), submit_wait_stages.Data(),
+			1, &command_buffer,
+			headless ? 0u : 1u, signal_semaphores,
 		};
 
-		if (vkQueueSubmit(graphics_queue, 1, &submit_info, nullptr) != VK_SUCCESS)
+		gpu_profiler.OnSubmit(slot, frame_fence);
+		vkResetFences(device, 1, &frame_fence);
+		if (vkQueueSubmit(graphics_queue, 1, &submit_info, frame_fence) != VK_SUCCESS)
 		{
 			throw std::runtime_error("Failed to submit command queue");
 		}
+		if (frames_rendered == 0)
+		{
+			MU_LOG("First frame submitted {}ms after startup", double(prof::GetTicks() - startup_ticks) * prof::GetSecondsPerTick() * 1000.0);
+		}
 
-		VkSemaphore present_wait_list[] = { render_finished_semaphore };
-		VkSwapchainKHR present_swapchain[] = { swapchain.handle };
-		VkPresentInfoKHR present_info =	{
-			VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-			nullptr,
-			1, present_wait_list,
-			1, present_swapchain, &image_index,
-			nullptr
-		};
-		vkQueuePresentKHR(present_queue, &present_info);
+		if (!headless)
+		{
+			VkSemaphore present_wait_list[] = { frame.render_finished };
+			VkSwapchainKHR present_swapchain[] = { swapchain.handle };
+			VkPresentInfoKHR present_info =	{
+				VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+				nullptr,
+				1, present_wait_list,
+				1, present_swapchain, &image_index,
+				nullptr
+			};
+			VkResult present_result = VK_SUCCESS;
+			{
+				MU_PROFILE_ZONE("QueuePresent");
+				present_result = vkQueuePresentKHR(present_queue, &present_info);
+			}
+			if (present_result == VK_ERROR_OUT_OF_DATE_KHR || present_result == VK_SUBOPTIMAL_KHR || bFramebufferResized)
+			{
+				recreate_swapchain();
+			}
+			else if (present_result != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to present");
+			}
+		}
+		frame_index = (frame_index + 1) % frames_in_flight;
+		++frames_rendered;
+
+		const size_t heap_allocations = HeapAllocator().GetStats().m_num_allocations;
+		if (heap_allocations != last_heap_allocations)
+		{
+			dbg::Log("Frame made ", heap_allocations - last_heap_allocations, " heap allocations");
+			last_heap_allocations = heap_allocations;
+		}
 	}
 	
 	vkDeviceWaitIdle(device);
 
+	if (headless && frames_rendered > 0)
+	{
+		// Every timestamp can be read back now the device is idle
+		const double elapsed_seconds = double(prof::GetTicks() - start_ticks) * prof::GetSecondsPerTick();
+		gpu_profiler.Collect();
+		const double gpu_busy_seconds = gpu_profiler.GetBusySeconds() - start_gpu_busy_seconds;
+		total_wait_seconds += stats_wait_seconds;
+		total_record_seconds += stats_record_seconds;
+		MU_LOG("Headless: {} frames in {}s, {} frames/sec", frames_rendered, elapsed_seconds, frames_rendered / elapsed_seconds);
+		MU_LOG("Headless: {}ms CPU per frame excluding waits for the GPU, {}ms recording, {}ms waiting",
+			(elapsed_seconds - total_wait_seconds) * 1000.0 / frames_rendered, total_record_seconds * 1000.0 / frames_rendered,
+			total_wait_seconds * 1000.0 / frames_rendered);
+		if (gpu_profiler.IsEnabled())
+		{
+			MU_LOG("Headless: {}ms GPU per frame", gpu_busy_seconds * 1000.0 / frames_rendered);
+		}
+	}
+
+	try
+	{
+		SavePipelineCache(device, pipeline_cache, device_properties, PipelineCachePath);
+	}
+	catch (const std::exception& e)
+	{
+		dbg::Log("Failed to save pipeline cache: ", e.what());
+	}
+
+	const vk::DeviceMemoryStats memory_stats = memory_allocator->GetStats();
+	MU_LOG("Device memory: {} blocks, {} dedicated, {} allocations, {} of {} bytes in use, fragmentation {}",
+		memory_stats.m_num_blocks, memory_stats.m_num_dedicated, memory_stats.m_num_allocations,
+		memory_stats.m_bytes_in_use, memory_stats.m_bytes_allocated, memory_stats.m_fragmentation);
+	MU_LOG("Uploaded {} bytes, {} uploads waited for staging memory", uploader.GetBytesUploaded(), uploader.GetNumStalls());
+
+	dbg::CloseBinaryLog();
 	return 0;
 }
\ No newline at end of file
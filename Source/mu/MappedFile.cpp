@@ -0,0 +1,194 @@
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+#include <codecvt>
+#include <locale>
+#include <string>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile(MappedFile&& other)
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+	if (this != &other)
+	{
+		Close();
+		std::swap(m_data, other.m_data);
+		std::swap(m_size, other.m_size);
+		std::swap(m_valid, other.m_valid);
+#ifdef _WIN32
+		std::swap(m_file, other.m_file);
+		std::swap(m_mapping, other.m_mapping);
+#endif
+	}
+	return *this;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+MappedFile MappedFile::Open(const char* path, FileAccessHint hint)
+{
+	std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> convert{};
+	std::wstring wide_path = convert.from_bytes(path);
+
+	DWORD flags = FILE_ATTRIBUTE_NORMAL;
+	if (hint == FileAccessHint::Sequential) { flags |= FILE_FLAG_SEQUENTIAL_SCAN; }
+	if (hint == FileAccessHint::Random) { flags |= FILE_FLAG_RANDOM_ACCESS; }
+
+	MappedFile file;
+	HANDLE handle = CreateFile(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+	{
+		return file;
+	}
+	file.m_file = handle;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size))
+	{
+		return file;
+	}
+	file.m_size = size_t(size.QuadPart);
+	file.m_valid = true;
+
+	// Empty files can't be mapped, they are valid with an empty range
+	if (file.m_size == 0)
+	{
+		return file;
+	}
+
+	file.m_mapping = CreateFileMapping(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (file.m_mapping)
+	{
+		file.m_data = static_cast<const uint8_t*>(MapViewOfFile(file.m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (!file.m_data)
+	{
+		file.m_valid = false;
+		file.m_size = 0;
+		return file;
+	}
+
+	if (hint == FileAccessHint::WillNeed)
+	{
+		file.Advise(hint);
+	}
+	return file;
+}
+
+void MappedFile::Advise(FileAccessHint hint, size_t offset, size_t size) const
+{
+	// Sequential and random are file handle flags on Windows, only prefetching applies to a view
+	if (hint != FileAccessHint::WillNeed || offset >= m_size) { return; }
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<uint8_t*>(m_data + offset);
+	range.NumberOfBytes = size < m_size - offset ? size : m_size - offset;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::Close()
+{
+	if (m_data) { UnmapViewOfFile(m_data); }
+	if (m_mapping) { CloseHandle(m_mapping); }
+	if (m_file) { CloseHandle(m_file); }
+	m_data = nullptr;
+	m_mapping = nullptr;
+	m_file = nullptr;
+	m_size = 0;
+	m_valid = false;
+}
+
+#else
+
+MappedFile MappedFile::Open(const char* path, FileAccessHint hint)
+{
+	MappedFile file;
+	const int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+	{
+		return file;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		return file;
+	}
+
+	file.m_size = size_t(info.st_size);
+	file.m_valid = true;
+	if (file.m_size > 0)
+	{
+		void* data = mmap(nullptr, file.m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED)
+		{
+			file.m_valid = false;
+			file.m_size = 0;
+		}
+		else
+		{
+			file.m_data = static_cast<const uint8_t*>(data);
+		}
+	}
+
+	// The mapping keeps the file alive
+	close(fd);
+
+	if (file.m_data && hint != FileAccessHint::Normal)
+	{
+		file.Advise(hint);
+	}
+	return file;
+}
+
+void MappedFile::Advise(FileAccessHint hint, size_t offset, size_t size) const
+{
+	if (offset >= m_size) { return; }
+
+	// madvise needs a page aligned start
+	const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+	const size_t aligned_offset = offset - offset % page_size;
+	const size_t end = size < m_size - offset ? offset + size : m_size;
+
+	int advice = MADV_NORMAL;
+	switch (hint)
+	{
+	case FileAccessHint::Normal:		advice = MADV_NORMAL; break;
+	case FileAccessHint::Sequential:	advice = MADV_SEQUENTIAL; break;
+	case FileAccessHint::Random:		advice = MADV_RANDOM; break;
+	case FileAccessHint::WillNeed:		advice = MADV_WILLNEED; break;
+	}
+	madvise(const_cast<uint8_t*>(m_data + aligned_offset), end - aligned_offset, advice);
+}
+
+void MappedFile::Close()
+{
+	if (m_data) { munmap(const_cast<uint8_t*>(m_data), m_size); }
+	m_data = nullptr;
+	m_size = 0;
+	m_valid = false;
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Ranges.h"
+
+// How the mapped pages are expected to be read, passed on to the OS paging heuristics
+enum class FileAccessHint
+{
+	Normal,
+	Sequential,	// read once front to back, read ahead aggressively
+	Random,		// scattered reads, don't read ahead
+	WillNeed,	// start paging in the whole range now
+};
+
+// Read-only memory mapping of a whole file.
+// Pages are loaded on first access, so nothing is read up front and untouched parts of the
+//	file never are, unlike LoadFileToArray which copies the whole file into memory.
+class MappedFile
+{
+	const uint8_t* m_data	= nullptr;
+	size_t m_size			= 0;
+	bool m_valid			= false;
+#ifdef _WIN32
+	void* m_file			= nullptr;
+	void* m_mapping			= nullptr;
+#endif
+
+public:
+	MappedFile() {}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other);
+	MappedFile& operator=(MappedFile&& other);
+	~MappedFile();
+
+	// Returns an invalid mapping if the file can't be opened
+	static MappedFile Open(const char* path, FileAccessHint hint = FileAccessHint::Normal);
+
+	bool IsValidFile() const { return m_valid; }
+	size_t GetFileSize() const { return m_size; }
+
+	mu::ranges::PointerRange<const uint8_t> GetRange() const { return mu::Range(m_data, m_size); }
+
+	// Change the access hint for part of the file, offset and size are in bytes
+	void Advise(FileAccessHint hint, size_t offset = 0, size_t size = SIZE_MAX) const;
+
+private:
+	void Close();
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <type_traits>
+
 // Debugging helper. Specialize this template and read the compiler error to see a typename.
 template<typename T>
 struct TD;
@@ -7,4 +9,22 @@ struct TD;
 
 namespace mu { namespace meta
 {
+	namespace details
+	{
+		template<typename T, typename = void>
+		struct DeclaresTriviallyRelocatable : std::false_type {};
+
+		template<typename T>
+		struct DeclaresTriviallyRelocatable<T, std::enable_if_t<T::IsTriviallyRelocatable>> : std::true_type {};
+	}
+
+	// A type is trivially relocatable if moving an object to a new address and destroying the original
+	//	is equivalent to copying its bytes and forgetting the original. 
+	// Trivially copyable types qualify automatically, other types opt in by declaring:
+	//	static constexpr bool IsTriviallyRelocatable = true;
+	template<typename T>
+	struct IsTriviallyRelocatable : std::integral_constant<bool, 
+		std::is_trivially_copyable<T>::value || details::DeclaresTriviallyRelocatable<T>::value>
+	{
+	};
 } } // namespace mu::meta
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <atomic>
+#include <type_traits>
+
+#include "Ranges.h"
+#include "Algorithms.h"
+#include "Array.h"
+#include "ThreadPool.h"
+
+// Parallel versions of the range algorithms.
+// The range must be sized and random access. It is split into chunks which run as tasks on
+//	the pool, with the calling thread helping until all chunks are done.
+// Functions are called concurrently from several threads.
+namespace mu
+{
+	namespace details
+	{
+		// Below this many elements per chunk the cost of a task outweighs the work
+		static const size_t ParallelMinChunkSize = 4096;
+
+		template<typename RANGE>
+		void CheckParallelRange()
+		{
+			static_assert(ranges::IsRandomAccessRange<RANGE>::value, "Parallel algorithms need a random access range");
+			static_assert(std::decay_t<RANGE>::HasSize, "Parallel algorithms need a sized range");
+		}
+
+		// A few chunks per thread so idle threads can steal work from slow ones
+		inline size_t ParallelChunkSize(size_t size, const ThreadPool& pool)
+		{
+			const size_t max_chunks = (pool.NumThreads() + 1) * 4;
+			const size_t chunk_size = (size + max_chunks - 1) / max_chunks;
+			return chunk_size < ParallelMinChunkSize ? ParallelMinChunkSize : chunk_size;
+		}
+
+		inline size_t NumChunks(size_t size, size_t chunk_size)
+		{
+			return (size + chunk_size - 1) / chunk_size;
+		}
+
+		// Calls func(chunk_index, begin, end) for each chunk of [0, size)
+		template<typename FUNC>
+		void ParallelForChunks(size_t size, size_t chunk_size, ThreadPool& pool, FUNC& func)
+		{
+			TaskGroup group;
+			const size_t num_chunks = NumChunks(size, chunk_size);
+			for (size_t chunk = 1; chunk < num_chunks; ++chunk)
+			{
+				const size_t begin = chunk * chunk_size;
+				const size_t end = begin + chunk_size < size ? begin + chunk_size : size;
+				pool.Run(group, [&func, chunk, begin, end]() { func(chunk, begin, end); });
+			}
+			if (num_chunks > 0)
+			{
+				func(size_t(0), size_t(0), chunk_size < size ? chunk_size : size);
+			}
+			pool.Wait(group);
+		}
+	}
+
+	template<typename RANGE, typename FUNC>
+	void ParallelMap(RANGE&& in_r, FUNC&& f, ThreadPool& pool = ThreadPool::Default())
+	{
+		auto r = Range(std::forward<RANGE>(in_r));
+		details::CheckParallelRange<decltype(r)>();
+
+		auto chunk_func = [&r, &f](size_t, size_t begin, size_t end)
+		{
+			Map(r.Slice(begin, end), f);
+		};
+		details::ParallelForChunks(r.Size(), details::ParallelChunkSize(r.Size(), pool), pool, chunk_func);
+	}
+
+	// Returns the range advanced to the first element matching the predicate, like Find.
+	// Chunks past an already found match stop early.
+	template<typename RANGE, typename FUNC>
+	auto ParallelFind(RANGE&& in_r, FUNC&& f, ThreadPool& pool = ThreadPool::Default())
+	{
+		auto r = Range(std::forward<RANGE>(in_r));
+		details::CheckParallelRange<decltype(r)>();
+
+		const size_t size = r.Size();
+		std::atomic<size_t> first_found{ size };
+		auto chunk_func = [&r, &f, &first_found](size_t, size_t begin, size_t end)
+		{
+			const size_t check_interval = 1024;
+			for (size_t block = begin; block < end; block += check_interval)
+			{
+				if (first_found.load(std::memory_order_relaxed) < begin)
+				{
+					return;
+				}
+
+				const size_t block_end = block + check_interval < end ? block + check_interval : end;
+				auto found = Find(r.Slice(block, block_end), f);
+				if (!found.IsEmpty())
+				{
+					const size_t index = block_end - found.Size();
+					size_t current = first_found.load(std::memory_order_relaxed);
+					while (index < current && !first_found.compare_exchange_weak(current, index, std::memory_order_relaxed))
+					{
+					}
+					return;
+				}
+			}
+		};
+		details::ParallelForChunks(size, details::ParallelChunkSize(size, pool), pool, chunk_func);
+
+		r.AdvanceBy(first_found.load(std::memory_order_relaxed));
+		return r;
+	}
+
+	// Combine all elements with reduce, which must be associative.
+	// identity is the starting value of every chunk, eg. 0 for a sum, and reduce is called
+	//	both as reduce(T, element) and reduce(T, T) to combine the chunk results in order.
+	template<typename RANGE, typename T, typename FUNC>
+	T ParallelReduce(RANGE&& in_r, T identity, FUNC&& reduce, ThreadPool& pool = ThreadPool::Default())
+	{
+		auto r = Range(std::forward<RANGE>(in_r));
+		details::CheckParallelRange<decltype(r)>();
+
+		const size_t size = r.Size();
+		const size_t chunk_size = details::ParallelChunkSize(size, pool);
+		Array<T> partials;
+		partials.Reserve(details::NumChunks(size, chunk_size));
+		for (size_t i = 0; i < details::NumChunks(size, chunk_size); ++i)
+		{
+			partials.Add(identity);
+		}
+
+		auto chunk_func = [&r, &reduce, &partials, &identity](size_t chunk, size_t begin, size_t end)
+		{
+			T value = identity;
+			for (auto slice = r.Slice(begin, end); !slice.IsEmpty(); slice.Advance())
+			{
+				value = reduce(value, slice.Front());
+			}
+			partials[chunk] = std::move(value);
+		};
+		details::ParallelForChunks(size, chunk_size, pool, chunk_func);
+
+		T result = identity;
+		for (T& partial : partials)
+		{
+			result = reduce(result, partial);
+		}
+		return result;
+	}
+
+	// Assign value to every element
+	template<typename RANGE, typename T>
+	void ParallelFill(RANGE&& in_r, const T& value, ThreadPool& pool = ThreadPool::Default())
+	{
+		auto r = Range(std::forward<RANGE>(in_r));
+		details::CheckParallelRange<decltype(r)>();
+
+		auto chunk_func = [&r, &value](size_t, size_t begin, size_t end)
+		{
+			Fill(r.Slice(begin, end), value);
+		};
+		details::ParallelForChunks(r.Size(), details::ParallelChunkSize(r.Size(), pool), pool, chunk_func);
+	}
+}
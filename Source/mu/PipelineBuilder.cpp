@@ -0,0 +1,190 @@
+#include "PipelineBuilder.h"
+
+#include <stdexcept>
+
+#include "Profiler.h"
+
+mu::vk::Pipeline mu::vk::CreateGraphicsPipeline(VkDevice device, VkPipelineCache pipeline_cache, const GraphicsPipelineDesc& desc)
+{
+	MU_PROFILE_ZONE("CreateGraphicsPipeline");
+	VkPipelineShaderStageCreateInfo shader_stages[] = {
+		{
+			VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			nullptr,
+			0,
+			VK_SHADER_STAGE_VERTEX_BIT,
+			desc.m_vert_shader,
+			"main",
+			nullptr
+		},
+		{
+			VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			nullptr,
+			0,
+			VK_SHADER_STAGE_FRAGMENT_BIT,
+			desc.m_frag_shader,
+			"main",
+			nullptr
+		}
+	};
+	VkPipelineVertexInputStateCreateInfo vertex_input_info = {
+		VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+		nullptr,
+		0,
+		uint32_t(desc.m_vertex_bindings.Num()), desc.m_vertex_bindings.Data(),
+		uint32_t(desc.m_vertex_attributes.Num()), desc.m_vertex_attributes.Data(),
+	};
+	VkPipelineInputAssemblyStateCreateInfo input_assembly_info = {
+		VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+		nullptr,
+		0,
+		desc.m_topology,
+		false, // primitive restart enable
+	};
+
+	VkPipelineViewportStateCreateInfo viewport_create_info = {
+		VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+		nullptr,
+		0,
+		1, nullptr, // viewports, dynamic
+		1, nullptr  // scissors, dynamic
+	};
+	VkPipelineRasterizationStateCreateInfo raster_state_create_info = {
+		VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+		nullptr,
+		0,
+		false, // depth clamp
+		false, // raster discard enable
+		VK_POLYGON_MODE_FILL,
+		VK_CULL_MODE_NONE,
+		VK_FRONT_FACE_CLOCKWISE,
+		false, // depth bias enable
+		0.0f, // constant depth bias
+		0.0f,  // depth bias clamp
+		0.0f, // depth bias slope factor
+		1.0f, // line width
+	};
+
+	VkPipelineMultisampleStateCreateInfo multisample_state_create_info = {
+		VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+		nullptr,
+		0,
+		VK_SAMPLE_COUNT_1_BIT,
+		false, // sample shading enable
+		1.0f, // min sample shading
+		nullptr, // sample mask
+		false, // alpha to coverage
+		false, // alpha to one
+	};
+
+	VkPipelineColorBlendAttachmentState color_blend_attachment_state = {
+		false, // blend enable
+		VK_BLEND_FACTOR_ONE, // source color blend factor
+		VK_BLEND_FACTOR_ZERO, // dest color blend factor
+		VK_BLEND_OP_ADD, // color blend op
+		VK_BLEND_FACTOR_ONE, // source alpha blend factor
+		VK_BLEND_FACTOR_ZERO, // dest alpha blend factor
+		VK_BLEND_OP_ADD, // alpha blend op
+		VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT, // color mask
+	};
+
+	VkPipelineColorBlendStateCreateInfo color_blend_state_create_info = {
+		VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+		nullptr,
+		0,
+		false, // logic op enable
+		VK_LOGIC_OP_COPY, // logic op
+		1, &color_blend_attachment_state, // attachments
+		{ 0.0f, 0.0f, 0.0f, 0.0f }, // blend constants
+	};
+
+	VkDynamicState dynamic_states[] = {
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR,
+		VK_DYNAMIC_STATE_LINE_WIDTH,
+	};
+
+	VkPipelineDynamicStateCreateInfo dynamic_state_create_info = {
+		VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+		nullptr,
+		0,
+		sizeof(dynamic_states) / sizeof(VkDynamicState), dynamic_states
+	};
+
+	VkGraphicsPipelineCreateInfo pipeline_info = {
+		VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		nullptr, 
+		0,
+		2, shader_stages,
+		&vertex_input_info,
+		&input_assembly_info,
+		nullptr, // tesselation state
+		&viewport_create_info,
+		&raster_state_create_info,
+		&multisample_state_create_info,
+		nullptr, // depth stencil info
+		&color_blend_state_create_info,
+		&dynamic_state_create_info,
+		desc.m_layout,
+		desc.m_render_pass,
+		desc.m_subpass,
+		nullptr, -1 // base pipeline
+	};
+
+	Pipeline pipeline{ device, nullptr };
+	if (vkCreateGraphicsPipelines(device, pipeline_cache, 1, &pipeline_info, nullptr, pipeline.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create pipeline");
+	}
+	return std::move(pipeline);
+}
+
+mu::vk::PipelineBuilder::PipelineBuilder(VkDevice device, VkPipelineCache pipeline_cache, size_t num_threads)
+	: m_device(device)
+	, m_pipeline_cache(pipeline_cache)
+	, m_group(new TaskGroup)
+	, m_thread_pool(new ThreadPool(num_threads))
+{
+}
+
+mu::vk::PipelineBuilder& mu::vk::PipelineBuilder::operator=(PipelineBuilder&& other)
+{
+	if (this != &other)
+	{
+		WaitAll();
+		m_device = other.m_device;
+		m_pipeline_cache = other.m_pipeline_cache;
+		m_thread_pool = std::move(other.m_thread_pool);
+		m_group = std::move(other.m_group);
+	}
+	return *this;
+}
+
+std::future<mu::vk::Pipeline> mu::vk::PipelineBuilder::Build(const GraphicsPipelineDesc& desc)
+{
+	// Tasks must not throw, so failures reach the caller through the future
+	std::shared_ptr<std::promise<Pipeline>> promise = std::make_shared<std::promise<Pipeline>>();
+	std::future<Pipeline> future = promise->get_future();
+	VkDevice device = m_device;
+	VkPipelineCache pipeline_cache = m_pipeline_cache;
+	m_thread_pool->Run(*m_group, [device, pipeline_cache, desc, promise]()
+	{
+		try
+		{
+			promise->set_value(CreateGraphicsPipeline(device, pipeline_cache, desc));
+		}
+		catch (...)
+		{
+			promise->set_exception(std::current_exception());
+		}
+	});
+	return future;
+}
+
+void mu::vk::PipelineBuilder::WaitAll()
+{
+	if (m_thread_pool)
+	{
+		m_thread_pool->Wait(*m_group);
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <future>
+#include <memory>
+
+#include "InlineArray.h"
+#include "ThreadPool.h"
+#include "VulkanTools.h"
+
+namespace mu
+{
+	namespace vk
+	{
+		// Everything needed to create a graphics pipeline, held by value so it can be handed to another thread.
+		// The layout, render pass and shader modules must outlive the pipeline's creation.
+		struct GraphicsPipelineDesc
+		{
+			VkPipelineLayout m_layout = VK_NULL_HANDLE;
+			VkRenderPass m_render_pass = VK_NULL_HANDLE;
+			uint32_t m_subpass = 0;
+			VkShaderModule m_vert_shader = VK_NULL_HANDLE;
+			VkShaderModule m_frag_shader = VK_NULL_HANDLE;
+			InlineArray<VkVertexInputBindingDescription, 4> m_vertex_bindings;
+			InlineArray<VkVertexInputAttributeDescription, 8> m_vertex_attributes;
+			VkPrimitiveTopology m_topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		};
+
+		// The viewport and scissor are dynamic state, so the pipeline outlives swapchain resizes and
+		//	command buffers using it must set them.
+		// Throws std::runtime_error if the pipeline can't be created
+		Pipeline CreateGraphicsPipeline(VkDevice device, VkPipelineCache pipeline_cache, const GraphicsPipelineDesc& desc);
+
+		// Creates pipelines on worker threads, so drivers compiling shaders doesn't hold up the thread asking for them.
+		// Every build shares the pipeline cache, which Vulkan synchronizes internally.
+		// Has its own threads rather than the default pool, so a frame waiting on recording tasks never
+		//	picks up a long compile instead.
+		class PipelineBuilder
+		{
+			VkDevice m_device = nullptr;
+			VkPipelineCache m_pipeline_cache = VK_NULL_HANDLE;
+			std::unique_ptr<TaskGroup> m_group;
+			std::unique_ptr<ThreadPool> m_thread_pool;	// destroyed first, finishing any builds still queued
+
+		public:
+			PipelineBuilder() {}
+			PipelineBuilder(VkDevice device, VkPipelineCache pipeline_cache, size_t num_threads = ThreadPool::DefaultNumThreads());
+
+			PipelineBuilder(PipelineBuilder&&) = default;
+			// Waits for the builds this one started before taking the other's
+			PipelineBuilder& operator=(PipelineBuilder&& other);
+			PipelineBuilder(const PipelineBuilder&) = delete;
+			PipelineBuilder& operator=(const PipelineBuilder&) = delete;
+
+			// Starts creating a pipeline. The future throws from get if creation failed.
+			std::future<Pipeline> Build(const GraphicsPipelineDesc& desc);
+
+			// Waits for every build started so far, such as before destroying what they use
+			void WaitAll();
+		};
+	}
+}
@@ -0,0 +1,398 @@
+#include "Profiler.h"
+#include "Debug.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	using mu::prof::ZoneSite;
+	using mu::prof::ProfileNode;
+	using mu::prof::ProfileFrame;
+
+	const size_t ZoneBufferSize = 8192;
+
+	struct ZoneEvent
+	{
+		const ZoneSite* m_site;
+		uint64_t m_begin;
+		uint64_t m_end;
+	};
+}
+
+// Single producer single consumer ring, written by one thread's zones or a track's owner and
+//	read by EndFrame. Positions increase forever and are wrapped on access.
+struct mu::prof::ProfileTrack
+{
+	std::atomic<size_t> m_write{ 0 };
+	std::atomic<size_t> m_read{ 0 };
+	std::atomic<bool> m_retired{ false };
+	uint32_t m_thread = 0;
+	ZoneEvent m_events[ZoneBufferSize];
+};
+
+namespace
+{
+	typedef mu::prof::ProfileTrack ZoneBuffer;
+
+	// A zone read back from a thread's buffer
+	struct GatheredZone
+	{
+		const ZoneSite* m_site;
+		uint64_t m_begin;
+		uint64_t m_end;
+		uint32_t m_thread;
+		uint32_t m_order;	// parents end after their children, this breaks ties between equal times
+	};
+
+	// A zone which contains the zones after it until its end, while building the call tree
+	struct OpenZone
+	{
+		uint32_t m_node;
+		uint64_t m_end;
+	};
+
+	typedef std::chrono::steady_clock ProfileClock;
+
+	class Profiler
+	{
+		std::mutex m_mutex;
+		std::vector<std::unique_ptr<ZoneBuffer>> m_buffers;
+		std::vector<const char*> m_thread_names;	// indexed by ZoneBuffer::m_thread, null for threads
+		std::atomic<uint64_t> m_num_dropped{ 0 };
+
+		// Only touched by the thread calling EndFrame
+		ProfileFrame m_frame;
+		uint64_t m_last_frame_ticks;
+		Array<GatheredZone> m_zones;
+		Array<OpenZone> m_open;
+		bool m_capturing = false;
+		uint64_t m_capture_start = 0;
+		Array<GatheredZone> m_captured;
+
+		uint64_t m_calibration_ticks;
+		ProfileClock::time_point m_calibration_time;
+
+	public:
+		Profiler()
+			: m_last_frame_ticks(mu::prof::details::ReadTicks())
+			, m_calibration_ticks(m_last_frame_ticks)
+			, m_calibration_time(ProfileClock::now())
+		{}
+
+		static Profiler& Get()
+		{
+			static Profiler profiler;
+			return profiler;
+		}
+
+		ZoneBuffer* AddBuffer(const char* name)
+		{
+			std::unique_ptr<ZoneBuffer> buffer{ new ZoneBuffer };
+			ZoneBuffer* result = buffer.get();
+			std::lock_guard<std::mutex> lock(m_mutex);
+			buffer->m_thread = uint32_t(m_thread_names.size());
+			m_thread_names.push_back(name);
+			m_buffers.push_back(std::move(buffer));
+			return result;
+		}
+
+		void Push(ZoneBuffer& buffer, const ZoneSite& site, uint64_t begin, uint64_t end)
+		{
+			const size_t write = buffer.m_write.load(std::memory_order_relaxed);
+			if (write - buffer.m_read.load(std::memory_order_acquire) == ZoneBufferSize)
+			{
+				m_num_dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+			buffer.m_events[write % ZoneBufferSize] = ZoneEvent{ &site, begin, end };
+			buffer.m_write.store(write + 1, std::memory_order_release);
+		}
+
+		uint64_t GetNumDropped() const { return m_num_dropped.load(std::memory_order_relaxed); }
+
+		const ProfileFrame& GetLastFrame() const { return m_frame; }
+
+		void EndFrame()
+		{
+			const uint64_t now = mu::prof::details::ReadTicks();
+			const double seconds_per_tick = SecondsPerTick();
+
+			m_zones.Clear();
+			{
+				// Buffers are only removed here, the lock keeps other threads adding new ones safe
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (size_t i = 0; i < m_buffers.size();)
+				{
+					ZoneBuffer& buffer = *m_buffers[i];
+					const bool retired = buffer.m_retired.load(std::memory_order_acquire);
+					Drain(buffer);
+					if (retired)
+					{
+						m_buffers[i] = std::move(m_buffers.back());
+						m_buffers.pop_back();
+					}
+					else
+					{
+						++i;
+					}
+				}
+			}
+
+			if (m_capturing)
+			{
+				m_captured.AppendRaw(m_zones.Data(), m_zones.Num());
+			}
+
+			std::sort(m_zones.Data(), m_zones.Data() + m_zones.Num(), [](const GatheredZone& a, const GatheredZone& b)
+			{
+				if (a.m_thread != b.m_thread) { return a.m_thread < b.m_thread; }
+				if (a.m_begin != b.m_begin) { return a.m_begin < b.m_begin; }
+				if (a.m_end != b.m_end) { return a.m_end > b.m_end; }
+				return a.m_order > b.m_order;
+			});
+
+			BuildCallTree(seconds_per_tick);
+			++m_frame.m_index;
+			m_frame.m_seconds = double(now - m_last_frame_ticks) * seconds_per_tick;
+			m_last_frame_ticks = now;
+		}
+
+		void BeginCapture()
+		{
+			m_captured.Clear();
+			m_capturing = true;
+			m_capture_start = mu::prof::details::ReadTicks();
+		}
+
+		bool IsCapturing() const { return m_capturing; }
+
+		bool EndCapture(const char* path)
+		{
+			m_capturing = false;
+			FILE* f = fopen(path, "wb");
+			if (!f)
+			{
+				return false;
+			}
+
+			// Times are in microseconds from the start of the capture
+			const double us_per_tick = SecondsPerTick() * 1000000.0;
+			fprintf(f, "{\"traceEvents\":[\n");
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (size_t i = 0; i < m_thread_names.size(); ++i)
+				{
+					if (m_thread_names[i])
+					{
+						fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", uint32_t(i));
+						WriteJsonString(f, m_thread_names[i]);
+						fprintf(f, "\"}},\n");
+					}
+				}
+			}
+			for (size_t i = 0; i < m_captured.Num(); ++i)
+			{
+				const GatheredZone& zone = m_captured[i];
+				const double start = zone.m_begin > m_capture_start ? double(zone.m_begin - m_capture_start) * us_per_tick : 0.0;
+				fprintf(f, "{\"name\":\"");
+				WriteJsonString(f, zone.m_site->m_name);
+				fprintf(f, "\",\"cat\":\"mu\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"file\":\"",
+					start, double(zone.m_end - zone.m_begin) * us_per_tick, zone.m_thread);
+				WriteJsonString(f, zone.m_site->m_file);
+				fprintf(f, "\",\"line\":%u}}%s\n", zone.m_site->m_line, i + 1 < m_captured.Num() ? "," : "");
+			}
+			fprintf(f, "],\"displayTimeUnit\":\"ms\"}\n");
+			m_captured = Array<GatheredZone>();
+			return fclose(f) == 0;
+		}
+
+		double SecondsPerTick()
+		{
+#if MU_PROFILE_USE_RDTSC
+			// Measured against steady_clock since startup, the estimate improves as the app runs
+			ProfileClock::time_point now = ProfileClock::now();
+			const std::chrono::milliseconds min_calibration{ 10 };
+			if (now - m_calibration_time < min_calibration)
+			{
+				std::this_thread::sleep_for(min_calibration - (now - m_calibration_time));
+				now = ProfileClock::now();
+			}
+			const uint64_t ticks = mu::prof::details::ReadTicks() - m_calibration_ticks;
+			return std::chrono::duration<double>(now - m_calibration_time).count() / double(ticks);
+#else
+			return double(ProfileClock::period::num) / double(ProfileClock::period::den);
+#endif
+		}
+
+	private:
+		void Drain(ZoneBuffer& buffer)
+		{
+			size_t read = buffer.m_read.load(std::memory_order_relaxed);
+			const size_t write = buffer.m_write.load(std::memory_order_acquire);
+			for (; read != write; ++read)
+			{
+				const ZoneEvent& event = buffer.m_events[read % ZoneBufferSize];
+				m_zones.Add(GatheredZone{ event.m_site, event.m_begin, event.m_end, buffer.m_thread, uint32_t(m_zones.Num()) });
+			}
+			buffer.m_read.store(read, std::memory_order_release);
+		}
+
+		// Zones are sorted by thread then start time, so each zone's parent is the innermost
+		//	zone still open when it starts. A zone whose parent ended in an earlier frame is outermost.
+		void BuildCallTree(double seconds_per_tick)
+		{
+			const uint32_t no_parent = mu::prof::NoParent;
+			m_frame.m_nodes.Clear();
+			size_t thread_start = 0;
+			size_t num_open = 0;
+			for (size_t i = 0; i < m_zones.Num(); ++i)
+			{
+				const GatheredZone& zone = m_zones[i];
+				if (i == 0 || zone.m_thread != m_zones[i - 1].m_thread)
+				{
+					thread_start = m_frame.m_nodes.Num();
+					num_open = 0;
+				}
+				while (num_open > 0 && m_open[num_open - 1].m_end < zone.m_end)
+				{
+					--num_open;
+				}
+				const uint32_t parent = num_open == 0 ? no_parent : m_open[num_open - 1].m_node;
+
+				// Children always come after their parent, and there are few distinct nodes per frame
+				size_t node = parent == no_parent ? thread_start : parent + 1;
+				for (; node < m_frame.m_nodes.Num(); ++node)
+				{
+					const ProfileNode& existing = m_frame.m_nodes[node];
+					if (existing.m_parent == parent && existing.m_site == zone.m_site)
+					{
+						break;
+					}
+				}
+				if (node == m_frame.m_nodes.Num())
+				{
+					m_frame.m_nodes.Add(ProfileNode{ zone.m_site, parent, zone.m_thread, 0, 0.0 });
+				}
+				ProfileNode& profile_node = m_frame.m_nodes[node];
+				++profile_node.m_num_calls;
+				profile_node.m_seconds += double(zone.m_end - zone.m_begin) * seconds_per_tick;
+
+				if (num_open == m_open.Num())
+				{
+					m_open.Add(OpenZone{});
+				}
+				m_open[num_open++] = OpenZone{ uint32_t(node), zone.m_end };
+			}
+		}
+
+		static void WriteJsonString(FILE* f, const char* str)
+		{
+			for (const char* c = str; *c; ++c)
+			{
+				if (*c == '"' || *c == '\\')
+				{
+					fputc('\\', f);
+				}
+				fputc(*c, f);
+			}
+		}
+	};
+
+	// Marks the thread's buffer retired when the thread exits
+	struct ThreadZoneBuffer
+	{
+		ZoneBuffer* m_buffer = nullptr;
+
+		~ThreadZoneBuffer()
+		{
+			if (m_buffer) { m_buffer->m_retired.store(true, std::memory_order_release); }
+		}
+	};
+}
+
+void mu::prof::details::EndZone(const ZoneSite& site, uint64_t begin)
+{
+	const uint64_t end = ReadTicks();
+	Profiler& profiler = Profiler::Get();
+	static thread_local ThreadZoneBuffer thread_buffer;
+	if (!thread_buffer.m_buffer)
+	{
+		thread_buffer.m_buffer = profiler.AddBuffer(nullptr);
+	}
+	profiler.Push(*thread_buffer.m_buffer, site, begin, end);
+}
+
+void mu::prof::EndFrame()
+{
+	Profiler::Get().EndFrame();
+}
+
+const mu::prof::ProfileFrame& mu::prof::GetLastFrame()
+{
+	return Profiler::Get().GetLastFrame();
+}
+
+void mu::prof::LogFrame(const ProfileFrame& frame)
+{
+	// Indent by depth, which is one more than the parent's since parents come first
+	static const char Indent[] = "                                ";
+	const size_t max_depth = (sizeof(Indent) - 1) / 2;
+	Array<uint32_t> depths;
+	depths.Reserve(frame.m_nodes.Num());
+	MU_LOG("Frame {} took {}ms", size_t(frame.m_index), frame.m_seconds * 1000.0);
+	for (const ProfileNode& node : frame.m_nodes)
+	{
+		const uint32_t depth = node.m_parent == NoParent ? 0 : depths[node.m_parent] + 1;
+		depths.Add(depth);
+		const size_t indent = depth < max_depth ? depth : max_depth;
+		MU_LOG("{}[{}] {} {}ms x{}", Indent + sizeof(Indent) - 1 - indent * 2, node.m_thread,
+			node.m_site->m_name, node.m_seconds * 1000.0, node.m_num_calls);
+	}
+}
+
+void mu::prof::BeginCapture()
+{
+	Profiler::Get().BeginCapture();
+}
+
+bool mu::prof::IsCapturing()
+{
+	return Profiler::Get().IsCapturing();
+}
+
+bool mu::prof::EndCapture(const char* path)
+{
+	return Profiler::Get().EndCapture(path);
+}
+
+uint64_t mu::prof::GetNumDroppedZones()
+{
+	return Profiler::Get().GetNumDropped();
+}
+
+mu::prof::ProfileTrack* mu::prof::AddTrack(const char* name)
+{
+	return Profiler::Get().AddBuffer(name);
+}
+
+void mu::prof::AddTrackZone(ProfileTrack* track, const ZoneSite& site, uint64_t begin_ticks, uint64_t end_ticks)
+{
+	Profiler::Get().Push(*track, site, begin_ticks, end_ticks);
+}
+
+uint64_t mu::prof::GetTicks()
+{
+	return details::ReadTicks();
+}
+
+double mu::prof::GetSecondsPerTick()
+{
+	return Profiler::Get().SecondsPerTick();
+}
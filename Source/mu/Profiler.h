@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define MU_PROFILE_USE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MU_PROFILE_USE_RDTSC 1
+#else
+#include <chrono>
+#define MU_PROFILE_USE_RDTSC 0
+#endif
+
+#include "Array.h"
+#include "Scope.h"
+
+// Cheap enough to leave in release builds, define as 0 to compile zones out entirely
+#ifndef MU_PROFILE_ENABLED
+#define MU_PROFILE_ENABLED 1
+#endif
+
+namespace mu
+{
+	namespace prof
+	{
+		// A static profile zone, see MU_PROFILE_ZONE
+		struct ZoneSite
+		{
+			const char* m_name;
+			const char* m_file;
+			uint32_t m_line;
+		};
+
+		static const uint32_t NoParent = UINT32_MAX;
+
+		// Every call of one zone under the same parent zone on one thread during a frame
+		struct ProfileNode
+		{
+			const ZoneSite* m_site;
+			uint32_t m_parent;	// index in ProfileFrame::m_nodes, NoParent for a thread's outermost zones
+			uint32_t m_thread;	// numbered in the order threads first entered a zone
+			uint32_t m_num_calls;
+			double m_seconds;	// total over all calls
+		};
+
+		struct ProfileFrame
+		{
+			uint64_t m_index = 0;
+			double m_seconds = 0.0;	// since the previous EndFrame
+			Array<ProfileNode> m_nodes;	// each thread's nodes are together, parents before children
+		};
+
+		// Gathers the zones which ended since the last call into the frame's call tree.
+		// Call once per frame from the frame loop, outside any zone. Doesn't touch the heap once
+		//	the frame's storage has grown to fit, unless a capture is running.
+		void EndFrame();
+
+		// Valid until the next EndFrame
+		const ProfileFrame& GetLastFrame();
+
+		// Writes the last frame's call tree to the log, one line per node
+		void LogFrame(const ProfileFrame& frame);
+
+		// Keep every zone from now on for a Chrome trace (chrome://tracing or ui.perfetto.dev)
+		void BeginCapture();
+		bool IsCapturing();
+
+		// Writes the zones gathered by EndFrame since BeginCapture as Chrome trace JSON
+		bool EndCapture(const char* path);
+
+		// Zones lost because a thread's buffer filled up between EndFrame calls
+		uint64_t GetNumDroppedZones();
+
+		// Zones timed somewhere other than the calling thread, such as on the GPU, are added to a
+		//	named track which appears alongside the threads. Only one thread may add to a track.
+		struct ProfileTrack;
+		ProfileTrack* AddTrack(const char* name);
+		void AddTrackZone(ProfileTrack* track, const ZoneSite& site, uint64_t begin_ticks, uint64_t end_ticks);
+
+		// The clock zones are timed with
+		uint64_t GetTicks();
+		double GetSecondsPerTick();
+
+		namespace details
+		{
+			inline uint64_t ReadTicks()
+			{
+#if MU_PROFILE_USE_RDTSC
+				return __rdtsc();
+#else
+				return uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+			}
+
+			// Appends the zone to the calling thread's lock free buffer
+			void EndZone(const ZoneSite& site, uint64_t begin);
+
+			inline auto BeginZone(const ZoneSite& site)
+			{
+				const uint64_t begin = ReadTicks();
+				return make_scope_exit([&site, begin]() { EndZone(site, begin); });
+			}
+		}
+	}
+}
+
+// Time the rest of the enclosing scope, nested zones build a call tree:
+//	MU_PROFILE_ZONE("CreatePipeline");
+#if MU_PROFILE_ENABLED
+#define MU_PROFILE_ZONE(NAME) \
+	static const mu::prof::ZoneSite STRING_JOIN2(mu_profile_site_, __LINE__){ NAME, __FILE__, __LINE__ }; \
+	auto STRING_JOIN2(mu_profile_zone_, __LINE__) = mu::prof::details::BeginZone(STRING_JOIN2(mu_profile_site_, __LINE__))
+#else
+#define MU_PROFILE_ZONE(NAME) do {} while (false)
+#endif
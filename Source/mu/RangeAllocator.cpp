@@ -0,0 +1,294 @@
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include <cstring>
+
+#include "RangeAllocator.h"
+
+namespace
+{
+	// mask must not be zero
+	uint32_t LowestBit(uint32_t mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return uint32_t(index);
+#else
+		return uint32_t(__builtin_ctz(mask));
+#endif
+	}
+
+	uint32_t LowestBit(uint64_t mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return uint32_t(index);
+#else
+		return uint32_t(__builtin_ctzll(mask));
+#endif
+	}
+
+	uint32_t HighestBit(uint32_t mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse(&index, mask);
+		return uint32_t(index);
+#else
+		return uint32_t(31 - __builtin_clz(mask));
+#endif
+	}
+
+	uint32_t HighestBit(uint64_t mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse64(&index, mask);
+		return uint32_t(index);
+#else
+		return uint32_t(63 - __builtin_clzll(mask));
+#endif
+	}
+
+	// Sizes below SecondLevelCount all go in the first list, one class per size
+	void MapSize(uint64_t size, uint32_t second_level_bits, uint32_t& out_first, uint32_t& out_second)
+	{
+		const uint64_t second_level_count = uint64_t(1) << second_level_bits;
+		if (size < second_level_count)
+		{
+			out_first = 0;
+			out_second = uint32_t(size);
+		}
+		else
+		{
+			const uint32_t log2 = HighestBit(size);
+			out_first = log2 - second_level_bits + 1;
+			out_second = uint32_t((size >> (log2 - second_level_bits)) ^ second_level_count);
+		}
+	}
+}
+
+mu::RangeAllocator::RangeAllocator()
+{
+	memset(m_second_level_bitmaps, 0, sizeof(m_second_level_bitmaps));
+	memset(m_free_lists, 0xff, sizeof(m_free_lists));
+}
+
+mu::RangeAllocator::RangeAllocator(uint64_t size)
+	: RangeAllocator()
+{
+	m_size = size;
+	if (size > 0)
+	{
+		const uint32_t range = NewRange();
+		m_ranges[range] = Range{ 0, size, InvalidRange, InvalidRange, InvalidRange, InvalidRange, true };
+		m_free_bytes = size;
+		InsertFree(range);
+	}
+}
+
+mu::RangeAllocator::Allocation mu::RangeAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	size = size > 0 ? size : 1;
+	// Any free range at least this big fits the allocation wherever the alignment falls
+	const uint64_t search_size = size + alignment - 1;
+	if (size > m_free_bytes || search_size < size)
+	{
+		return Allocation{ 0, InvalidRange };
+	}
+	uint32_t index = search_size <= m_free_bytes ? FindFree(search_size) : InvalidRange;
+	if (index == InvalidRange)
+	{
+		// Padding for the worst case alignment may be all that stops a fit, such as filling a whole space
+		index = FindFree(size);
+		if (index == InvalidRange)
+		{
+			return Allocation{ 0, InvalidRange };
+		}
+		const Range& r = m_ranges[index];
+		if (((r.m_offset + alignment - 1) & ~(alignment - 1)) + size > r.m_offset + r.m_size)
+		{
+			return Allocation{ 0, InvalidRange };
+		}
+	}
+	RemoveFree(index);
+
+	// Neighbours of a free range are never free, so leftovers either side become free ranges as they are
+	const uint64_t offset = m_ranges[index].m_offset;
+	const uint64_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+	if (aligned > offset)
+	{
+		const uint32_t front = NewRange();
+		Range& r = m_ranges[index];
+		m_ranges[front] = Range{ offset, aligned - offset, r.m_prev, index, InvalidRange, InvalidRange, true };
+		if (r.m_prev != InvalidRange)
+		{
+			m_ranges[r.m_prev].m_next = front;
+		}
+		r.m_prev = front;
+		r.m_offset = aligned;
+		r.m_size -= aligned - offset;
+		InsertFree(front);
+	}
+	if (m_ranges[index].m_size > size)
+	{
+		const uint32_t back = NewRange();
+		Range& r = m_ranges[index];
+		m_ranges[back] = Range{ aligned + size, r.m_size - size, index, r.m_next, InvalidRange, InvalidRange, true };
+		if (r.m_next != InvalidRange)
+		{
+			m_ranges[r.m_next].m_prev = back;
+		}
+		r.m_next = back;
+		r.m_size = size;
+		InsertFree(back);
+	}
+
+	m_ranges[index].m_free = false;
+	m_free_bytes -= size;
+	++m_num_allocations;
+	return Allocation{ aligned, index };
+}
+
+void mu::RangeAllocator::Free(uint32_t index)
+{
+	m_ranges[index].m_free = true;
+	m_free_bytes += m_ranges[index].m_size;
+	--m_num_allocations;
+
+	const uint32_t prev = m_ranges[index].m_prev;
+	if (prev != InvalidRange && m_ranges[prev].m_free)
+	{
+		RemoveFree(prev);
+		m_ranges[prev].m_size += m_ranges[index].m_size;
+		m_ranges[prev].m_next = m_ranges[index].m_next;
+		if (m_ranges[index].m_next != InvalidRange)
+		{
+			m_ranges[m_ranges[index].m_next].m_prev = prev;
+		}
+		ReleaseRange(index);
+		index = prev;
+	}
+
+	const uint32_t next = m_ranges[index].m_next;
+	if (next != InvalidRange && m_ranges[next].m_free)
+	{
+		RemoveFree(next);
+		m_ranges[index].m_size += m_ranges[next].m_size;
+		m_ranges[index].m_next = m_ranges[next].m_next;
+		if (m_ranges[next].m_next != InvalidRange)
+		{
+			m_ranges[m_ranges[next].m_next].m_prev = index;
+		}
+		ReleaseRange(next);
+	}
+	InsertFree(index);
+}
+
+uint64_t mu::RangeAllocator::GetLargestFreeRange() const
+{
+	if (m_first_level_bitmap == 0)
+	{
+		return 0;
+	}
+	// The largest range is somewhere in the highest non-empty class
+	const uint32_t first = HighestBit(m_first_level_bitmap);
+	const uint32_t second = HighestBit(m_second_level_bitmaps[first]);
+	uint64_t largest = 0;
+	for (uint32_t i = m_free_lists[first][second]; i != InvalidRange; i = m_ranges[i].m_next_free)
+	{
+		largest = m_ranges[i].m_size > largest ? m_ranges[i].m_size : largest;
+	}
+	return largest;
+}
+
+uint32_t mu::RangeAllocator::NewRange()
+{
+	if (m_unused != InvalidRange)
+	{
+		const uint32_t index = m_unused;
+		m_unused = m_ranges[index].m_next_free;
+		return index;
+	}
+	m_ranges.Add(Range{});
+	return uint32_t(m_ranges.Num() - 1);
+}
+
+void mu::RangeAllocator::ReleaseRange(uint32_t index)
+{
+	m_ranges[index].m_next_free = m_unused;
+	m_unused = index;
+}
+
+void mu::RangeAllocator::InsertFree(uint32_t index)
+{
+	uint32_t first, second;
+	MapSize(m_ranges[index].m_size, SecondLevelBits, first, second);
+	const uint32_t head = m_free_lists[first][second];
+	m_ranges[index].m_prev_free = InvalidRange;
+	m_ranges[index].m_next_free = head;
+	if (head != InvalidRange)
+	{
+		m_ranges[head].m_prev_free = index;
+	}
+	m_free_lists[first][second] = index;
+	m_first_level_bitmap |= uint64_t(1) << first;
+	m_second_level_bitmaps[first] |= 1u << second;
+}
+
+void mu::RangeAllocator::RemoveFree(uint32_t index)
+{
+	const Range& r = m_ranges[index];
+	if (r.m_next_free != InvalidRange)
+	{
+		m_ranges[r.m_next_free].m_prev_free = r.m_prev_free;
+	}
+	if (r.m_prev_free != InvalidRange)
+	{
+		m_ranges[r.m_prev_free].m_next_free = r.m_next_free;
+		return;
+	}
+
+	uint32_t first, second;
+	MapSize(r.m_size, SecondLevelBits, first, second);
+	m_free_lists[first][second] = r.m_next_free;
+	if (r.m_next_free == InvalidRange)
+	{
+		m_second_level_bitmaps[first] &= ~(1u << second);
+		if (m_second_level_bitmaps[first] == 0)
+		{
+			m_first_level_bitmap &= ~(uint64_t(1) << first);
+		}
+	}
+}
+
+uint32_t mu::RangeAllocator::FindFree(uint64_t size) const
+{
+	// Round up to the next class boundary so every range in the class found is big enough
+	if (size >= SecondLevelCount)
+	{
+		size += (uint64_t(1) << (HighestBit(size) - SecondLevelBits)) - 1;
+	}
+	uint32_t first, second;
+	MapSize(size, SecondLevelBits, first, second);
+	if (first >= FirstLevelCount)
+	{
+		return InvalidRange;
+	}
+
+	uint32_t second_map = m_second_level_bitmaps[first] & (~0u << second);
+	if (second_map == 0)
+	{
+		const uint64_t first_map = first + 1 < 64 ? m_first_level_bitmap & (~uint64_t(0) << (first + 1)) : 0;
+		if (first_map == 0)
+		{
+			return InvalidRange;
+		}
+		first = LowestBit(first_map);
+		second_map = m_second_level_bitmaps[first];
+	}
+	return m_free_lists[first][LowestBit(second_map)];
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Array.h"
+
+namespace mu
+{
+	// Hands out aligned ranges of a fixed size space, such as offsets into a block of GPU memory,
+	//	in constant time using two level segregated fit (TLSF).
+	// Free ranges are kept in lists by size class. The first level is the power of two of the size and
+	//	the second splits each power of two linearly into SecondLevelCount classes. A bitmap of non-empty
+	//	lists for each level finds a big enough free range with two bit scans.
+	// Bookkeeping lives apart from the space it manages, so the space needn't be CPU accessible.
+	class RangeAllocator
+	{
+	public:
+		static const uint32_t InvalidRange = UINT32_MAX;
+
+		struct Allocation
+		{
+			uint64_t m_offset;
+			uint32_t m_range;	// pass to Free, InvalidRange if the allocation failed
+		};
+
+	private:
+		static const uint32_t SecondLevelBits = 5;
+		static const uint32_t SecondLevelCount = 1 << SecondLevelBits;
+		static const uint32_t FirstLevelCount = 64 - SecondLevelBits + 1;
+
+		// Every range of the space, free or not, linked in address order
+		struct Range
+		{
+			uint64_t m_offset;
+			uint64_t m_size;
+			uint32_t m_prev;
+			uint32_t m_next;
+			uint32_t m_prev_free;	// links within the size class's free list
+			uint32_t m_next_free;	//	or the unused entry list once the range is merged away
+			bool m_free;
+		};
+
+		Array<Range> m_ranges;
+		uint32_t m_unused = InvalidRange;
+		uint64_t m_size = 0;
+		uint64_t m_free_bytes = 0;
+		uint32_t m_num_allocations = 0;
+		uint64_t m_first_level_bitmap = 0;
+		uint32_t m_second_level_bitmaps[FirstLevelCount];
+		uint32_t m_free_lists[FirstLevelCount][SecondLevelCount];
+
+	public:
+		RangeAllocator();
+		explicit RangeAllocator(uint64_t size);
+
+		// alignment must be a power of two
+		Allocation Allocate(uint64_t size, uint64_t alignment);
+		void Free(uint32_t range);
+
+		uint64_t GetSize() const { return m_size; }
+		uint64_t GetFreeBytes() const { return m_free_bytes; }
+		uint32_t GetNumAllocations() const { return m_num_allocations; }
+		bool IsEmpty() const { return m_num_allocations == 0; }
+
+		// Together with GetFreeBytes this gives how fragmented the free space is
+		uint64_t GetLargestFreeRange() const;
+
+	private:
+		uint32_t NewRange();
+		void ReleaseRange(uint32_t range);
+		void InsertFree(uint32_t range);
+		void RemoveFree(uint32_t range);
+		uint32_t FindFree(uint64_t size) const;
+	};
+}
@@ -16,12 +16,28 @@
 //		T& Front();
 //		size_t Size(); // if HasSize == 1
 //	};
-
-template<typename T>
+//
+// Random access ranges additionally declare IsRandomAccess and support, all in constant time:
+//		T& operator[](size_t index);			// relative to Front()
+//		void AdvanceBy(size_t num);
+//		RANGE Slice(size_t begin, size_t end);	// same range type, [begin, end) relative to Front()
+// Contiguous ranges are random access ranges whose elements are adjacent in memory:
+//		T* Data();
+
+template<typename T, typename ALLOCATOR>
 class Array;
 
+template<typename T, size_t N, typename ALLOCATOR>
+class InlineArray;
+
 namespace mu
 {
+	template<typename T, typename HASHER, typename EQUAL, typename ALLOCATOR>
+	class HashSet;
+
+	template<typename K, typename V, typename HASHER, typename EQUAL, typename ALLOCATOR>
+	class HashMap;
+
 	// Functions to automatically construct ranges from pointers/arrays
 	template<typename T>
 	auto Range(T* ptr, size_t num)
@@ -41,18 +57,54 @@ namespace mu
 		return Range(arr, arr + SIZE);
 	}
 
-	template<typename T>
-	auto Range(Array<T>& arr)
+	template<typename T, typename ALLOCATOR>
+	auto Range(Array<T, ALLOCATOR>& arr)
 	{
 		return Range(arr.Data(), arr.Num());
 	}
 	
-	template<typename T>
-	auto Range(const Array<T>& arr)
+	template<typename T, typename ALLOCATOR>
+	auto Range(const Array<T, ALLOCATOR>& arr)
+	{
+		return Range(arr.Data(), arr.Num());
+	}
+
+	template<typename T, size_t N, typename ALLOCATOR>
+	auto Range(InlineArray<T, N, ALLOCATOR>& arr)
+	{
+		return Range(arr.Data(), arr.Num());
+	}
+
+	template<typename T, size_t N, typename ALLOCATOR>
+	auto Range(const InlineArray<T, N, ALLOCATOR>& arr)
 	{
 		return Range(arr.Data(), arr.Num());
 	}
 
+	template<typename T, typename HASHER, typename EQUAL, typename ALLOCATOR>
+	auto Range(HashSet<T, HASHER, EQUAL, ALLOCATOR>& set)
+	{
+		return set.All();
+	}
+
+	template<typename T, typename HASHER, typename EQUAL, typename ALLOCATOR>
+	auto Range(const HashSet<T, HASHER, EQUAL, ALLOCATOR>& set)
+	{
+		return set.All();
+	}
+
+	template<typename K, typename V, typename HASHER, typename EQUAL, typename ALLOCATOR>
+	auto Range(HashMap<K, V, HASHER, EQUAL, ALLOCATOR>& map)
+	{
+		return map.All();
+	}
+
+	template<typename K, typename V, typename HASHER, typename EQUAL, typename ALLOCATOR>
+	auto Range(const HashMap<K, V, HASHER, EQUAL, ALLOCATOR>& map)
+	{
+		return map.All();
+	}
+
 	template<typename RANGE>
 	auto Range(RANGE&& r)
 	{
@@ -75,6 +127,7 @@ namespace mu
 	namespace ranges
 	{
 		using mu::functor::Fold;
+		using mu::functor::FoldAnd;
 		using mu::functor::FoldOr;
 		using mu::functor::FMap;
 		using mu::functor::FMapVoid;
@@ -84,20 +137,44 @@ namespace mu
 			template<typename T> struct WithBeginEnd;
 		}
 
+		// Traits for the optional range tiers, false for ranges which don't declare them
+		template<typename RANGE, typename = void>
+		struct IsRandomAccessRange : std::false_type {};
+
+		template<typename RANGE>
+		struct IsRandomAccessRange<RANGE, std::enable_if_t<std::decay_t<RANGE>::IsRandomAccess>> : std::true_type {};
+
+		template<typename RANGE, typename = void>
+		struct IsContiguousRange : std::false_type {};
+
+		template<typename RANGE>
+		struct IsContiguousRange<RANGE, std::enable_if_t<std::decay_t<RANGE>::IsContiguous>> : std::true_type {};
+
 		// A linear forward range over raw memory of a certain type
 		template<typename T>
 		class PointerRange : public details::WithBeginEnd<PointerRange<T>>
 		{
+			template<typename U> friend class PointerRange;
+
 			T* m_start, *m_end;
 
 		public:
 			static constexpr bool HasSize = true;
+			static constexpr bool IsRandomAccess = true;
+			static constexpr bool IsContiguous = true;
 
 			PointerRange(T* start, T* end)
 				: m_start(start)
 				, m_end(end)
 			{}
 
+			// Allow implicit conversion from a range over T to a range over const T
+			template<typename U, typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+			PointerRange(const PointerRange<U>& other)
+				: m_start(other.m_start)
+				, m_end(other.m_end)
+			{}
+
 			void Advance() { ++m_start; }
 			void AdvanceBy(size_t num) { m_start += num; }
 
@@ -105,6 +182,13 @@ namespace mu
 			T& Front() { return *m_start; }
 			const T& Front() const { return *m_start; }
 			size_t Size() const { return m_end - m_start; }
+
+			T& operator[](size_t index) { return m_start[index]; }
+			const T& operator[](size_t index) const { return m_start[index]; }
+			PointerRange Slice(size_t begin, size_t end) const { return PointerRange{ m_start + begin, m_start + end }; }
+
+			T* Data() { return m_start; }
+			const T* Data() const { return m_start; }
 			
 			template<typename U>
 			bool operator==(const PointerRange<U>& other) const
@@ -130,6 +214,7 @@ namespace mu
 			T m_it = 0;
 		public:
 			enum { HasSize = 0 };
+			static constexpr bool IsRandomAccess = true;
 
 			IotaRange() {}
 			IotaRange(T start = 0) : m_it(start)
@@ -137,8 +222,14 @@ namespace mu
 			}
 
 			void Advance() { ++m_it; }
+			void AdvanceBy(size_t num) { m_it += T(num); }
 			bool IsEmpty() const { return false; }
 			T Front() { return m_it; }
+
+			T operator[](size_t index) const { return m_it + T(index); }
+
+			// The range stays infinite, only the start moves. Zipping with a finite range bounds it.
+			IotaRange Slice(size_t begin, size_t /*end*/) const { return IotaRange{ m_it + T(begin) }; }
 		};
 
 		// ZipRange combines multiple ranges and iterates them in lockstep
@@ -153,8 +244,32 @@ namespace mu
 				return ZipRange{ std::get<INDICES>(m_ranges).MakeEmpty()... };
 			}
 
+			template<size_t... INDICES>
+			auto Index(size_t index, std::index_sequence<INDICES...>)
+			{
+				return std::tuple<decltype(std::get<INDICES>(m_ranges)[index])...>(std::get<INDICES>(m_ranges)[index]...);
+			}
+
+			template<size_t... INDICES>
+			void AdvanceBy(size_t num, std::index_sequence<INDICES...>)
+			{
+				int expand[] = { (std::get<INDICES>(m_ranges).AdvanceBy(num), 0)... };
+				(void)expand;
+			}
+
+			template<size_t... INDICES>
+			ZipRange Slice(size_t begin, size_t end, std::index_sequence<INDICES...>) const
+			{
+				return ZipRange{ std::get<INDICES>(m_ranges).Slice(begin, end)... };
+			}
+
+			typedef std::index_sequence_for<RANGES...> Indices;
+
 		public:
 			static constexpr bool HasSize = FoldOr(RANGES::HasSize...);
+			static constexpr bool IsRandomAccess = FoldAnd(IsRandomAccessRange<RANGES>::value...);
+			// Each component may be contiguous, but the zipped tuples are not
+			static constexpr bool IsContiguous = false;
 
 			ZipRange(RANGES... ranges) : m_ranges(ranges...)
 			{
@@ -182,6 +297,15 @@ namespace mu
 					std::numeric_limits<size_t>::max(), m_ranges);
 			}
 
+			template<typename T = ZipRange, typename std::enable_if<T::IsRandomAccess, int>::type = 0>
+			auto operator[](size_t index) { return Index(index, Indices()); }
+
+			template<typename T = ZipRange, typename std::enable_if<T::IsRandomAccess, int>::type = 0>
+			void AdvanceBy(size_t num) { AdvanceBy(num, Indices()); }
+
+			template<typename T = ZipRange, typename std::enable_if<T::IsRandomAccess, int>::type = 0>
+			ZipRange Slice(size_t begin, size_t end) const { return Slice(begin, end, Indices()); }
+
 			ZipRange MakeEmpty() const { return MakeEmpty(mu::functor::details::TupleIndices<decltype(m_ranges)>()); }
 		};
 
@@ -192,6 +316,9 @@ namespace mu
 			FUNC m_func;
 		public:
 			static constexpr bool HasSize = IN_RANGE::HasSize;
+			static constexpr bool IsRandomAccess = IsRandomAccessRange<IN_RANGE>::value;
+			// Elements are computed on access, so never contiguous
+			static constexpr bool IsContiguous = false;
 
 			TransformRange(IN_RANGE r, FUNC f) 
 				: m_range(std::move(r)), m_func(std::move(f))
@@ -205,6 +332,15 @@ namespace mu
 			template<typename T=IN_RANGE, typename = std::enable_if_t<T::HasSize>>
 			size_t Size() const { return m_range.Size(); }
 
+			template<typename T=IN_RANGE, typename = std::enable_if_t<IsRandomAccessRange<T>::value>>
+			auto operator[](size_t index) { return m_func(m_range[index]); }
+
+			template<typename T=IN_RANGE, typename = std::enable_if_t<IsRandomAccessRange<T>::value>>
+			void AdvanceBy(size_t num) { m_range.AdvanceBy(num); }
+
+			template<typename T=IN_RANGE, typename = std::enable_if_t<IsRandomAccessRange<T>::value>>
+			TransformRange Slice(size_t begin, size_t end) const { return TransformRange{ m_range.Slice(begin, end), m_func }; }
+
 			TransformRange MakeEmpty() const { return TransformRange{ m_range.MakeEmpty(), m_func }; }
 		};
 
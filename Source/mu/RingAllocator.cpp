@@ -0,0 +1,31 @@
+#include "RingAllocator.h"
+
+uint64_t mu::RingAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	if (m_head == m_tail && m_size > 0)
+	{
+		// Nothing is in use, so start again from the beginning to leave the most room
+		m_head += (m_size - m_head % m_size) % m_size;
+		m_tail = m_head;
+	}
+	const uint64_t offset = m_size > 0 ? m_head % m_size : 0;
+	uint64_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+	uint64_t start = m_head + (aligned - offset);
+	if (aligned + size > m_size)
+	{
+		// Skip what's left before the end, the allocation must be contiguous
+		start = m_head + (m_size - offset);
+		aligned = 0;
+	}
+	if (start + size - m_tail > m_size)
+	{
+		return InvalidOffset;
+	}
+	m_head = start + size;
+	return aligned;
+}
+
+void mu::RingAllocator::Release(uint64_t position)
+{
+	m_tail = position > m_tail ? position : m_tail;
+}
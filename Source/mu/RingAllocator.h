@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mu
+{
+	// Hands out aligned ranges of a fixed size space in order, wrapping around at the end, and frees
+	//	them in the same order. Suits data written once and consumed a little later, such as staging
+	//	memory for uploads read by the GPU over the next few frames.
+	// Positions count bytes handed out since creation and never wrap, so one allocated before another
+	//	always has a lower position. Release frees everything allocated before a position.
+	class RingAllocator
+	{
+	public:
+		static const uint64_t InvalidOffset = UINT64_MAX;
+
+	private:
+		uint64_t m_size = 0;
+		uint64_t m_head = 0;
+		uint64_t m_tail = 0;
+
+	public:
+		RingAllocator() {}
+		explicit RingAllocator(uint64_t size) : m_size(size) {}
+
+		// Returns the offset into the space, or InvalidOffset if there isn't room until more is released.
+		// alignment must be a power of two.
+		uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+		// The position after everything allocated so far
+		uint64_t GetHead() const { return m_head; }
+
+		// Frees everything allocated before position, which must come from GetHead. Releasing an
+		//	earlier position than before does nothing, so releases needn't arrive in order.
+		void Release(uint64_t position);
+
+		uint64_t GetSize() const { return m_size; }
+		uint64_t GetUsedBytes() const { return m_head - m_tail; }
+	};
+}
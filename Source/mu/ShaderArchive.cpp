@@ -0,0 +1,237 @@
+#include "ShaderArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Hash.h"
+
+// File layout, all offsets from the start of the file:
+//	FileHeader
+//	IndexEntry for each shader, sorted by name hash
+//	Names, not null terminated
+//	Each unique SPIR-V blob, 8 byte aligned
+
+namespace
+{
+	const char ShaderArchiveMagic[8] = { 'M', 'U', 'S', 'H', 'D', 0, 0, 1 };
+	const uint32_t SpirvMagic = 0x07230203;
+
+	struct FileHeader
+	{
+		char m_magic[8];
+		uint32_t m_num_shaders;
+		uint32_t m_pad;
+	};
+
+	struct IndexEntry
+	{
+		uint64_t m_name_hash;
+		uint64_t m_content_hash;
+		uint32_t m_name_offset;
+		uint32_t m_name_size;
+		uint32_t m_code_offset;
+		uint32_t m_code_size;
+	};
+
+	size_t AlignBlob(size_t size)
+	{
+		return (size + 7) & ~size_t(7);
+	}
+
+	uint64_t HashName(mu::StringView name)
+	{
+		return mu::HashBytes(name.Data(), name.Size());
+	}
+
+	IndexEntry ReadEntry(mu::ranges::PointerRange<const uint8_t> data, size_t index)
+	{
+		IndexEntry entry;
+		memcpy(&entry, data.Data() + sizeof(FileHeader) + index * sizeof(IndexEntry), sizeof(entry));
+		return entry;
+	}
+}
+
+void mu::ShaderArchiveWriter::Add(StringView name, ranges::PointerRange<const uint8_t> code)
+{
+	uint32_t first_word = 0;
+	if (code.Size() >= sizeof(first_word))
+	{
+		memcpy(&first_word, code.Data(), sizeof(first_word));
+	}
+	if (first_word != SpirvMagic || code.Size() % 4 != 0)
+	{
+		throw std::runtime_error(std::string("Not SPIR-V: ") + std::string(name.Data(), name.Size()));
+	}
+
+	const uint64_t name_hash = HashName(name);
+	for (const Shader& shader : m_shaders)
+	{
+		if (shader.m_name_hash == name_hash && StringView(shader.m_name.data(), shader.m_name.size()) == name)
+		{
+			throw std::runtime_error(std::string("Shader added twice: ") + shader.m_name);
+		}
+	}
+
+	// Reuse the stored blob when the code is identical. Shaders are found by content hash at runtime,
+	//	so different code with the same hash can't go in one archive.
+	const uint64_t content_hash = HashBytes(code.Data(), code.Size());
+	uint32_t blob_index = uint32_t(m_blobs.Num());
+	if (const uint32_t* existing = m_blob_by_hash.Find(content_hash))
+	{
+		const Array<uint8_t>& existing_code = m_blobs[*existing].m_code;
+		if (existing_code.Num() != code.Size() || memcmp(existing_code.Data(), code.Data(), code.Size()) != 0)
+		{
+			throw std::runtime_error(std::string("Shader content hash collision: ") + std::string(name.Data(), name.Size()));
+		}
+		blob_index = *existing;
+	}
+	else
+	{
+		Blob blob;
+		blob.m_code.AppendRaw(code.Data(), code.Size());
+		blob.m_content_hash = content_hash;
+		m_blobs.Add(std::move(blob));
+		m_blob_by_hash.Add(content_hash, blob_index);
+	}
+
+	m_shaders.Add(Shader{ std::string(name.Data(), name.Size()), name_hash, blob_index });
+}
+
+Array<uint8_t> mu::ShaderArchiveWriter::Build() const
+{
+	Array<uint32_t> order;
+	order.Reserve(m_shaders.Num());
+	size_t names_size = 0;
+	for (size_t i = 0; i < m_shaders.Num(); ++i)
+	{
+		order.Add(uint32_t(i));
+		names_size += m_shaders[i].m_name.size();
+	}
+	std::sort(order.Data(), order.Data() + order.Num(), [this](uint32_t a, uint32_t b)
+	{
+		return m_shaders[a].m_name_hash < m_shaders[b].m_name_hash;
+	});
+
+	const size_t names_offset = sizeof(FileHeader) + m_shaders.Num() * sizeof(IndexEntry);
+	Array<size_t> blob_offsets;
+	size_t size = AlignBlob(names_offset + names_size);
+	for (const Blob& blob : m_blobs)
+	{
+		blob_offsets.Add(size);
+		size = AlignBlob(size + blob.m_code.Num());
+	}
+	if (size > UINT32_MAX)
+	{
+		throw std::runtime_error("Shader archive too large");
+	}
+
+	Array<uint8_t> data = Array<uint8_t>::MakeUninitialized(size);
+	memset(data.Data(), 0, size);
+
+	FileHeader header = {};
+	memcpy(header.m_magic, ShaderArchiveMagic, sizeof(ShaderArchiveMagic));
+	header.m_num_shaders = uint32_t(m_shaders.Num());
+	memcpy(data.Data(), &header, sizeof(header));
+
+	size_t name_offset = names_offset;
+	for (size_t i = 0; i < order.Num(); ++i)
+	{
+		const Shader& shader = m_shaders[order[i]];
+		const Blob& blob = m_blobs[shader.m_blob];
+		const IndexEntry entry = {
+			shader.m_name_hash,
+			blob.m_content_hash,
+			uint32_t(name_offset),
+			uint32_t(shader.m_name.size()),
+			uint32_t(blob_offsets[shader.m_blob]),
+			uint32_t(blob.m_code.Num())
+		};
+		memcpy(data.Data() + sizeof(FileHeader) + i * sizeof(IndexEntry), &entry, sizeof(entry));
+		memcpy(data.Data() + name_offset, shader.m_name.data(), shader.m_name.size());
+		name_offset += shader.m_name.size();
+	}
+	for (size_t i = 0; i < m_blobs.Num(); ++i)
+	{
+		memcpy(data.Data() + blob_offsets[i], m_blobs[i].m_code.Data(), m_blobs[i].m_code.Num());
+	}
+	return std::move(data);
+}
+
+bool mu::ShaderArchive::Open(ranges::PointerRange<const uint8_t> data)
+{
+	m_num_shaders = 0;
+
+	FileHeader header;
+	if (data.Size() < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, data.Data(), sizeof(header));
+	if (memcmp(header.m_magic, ShaderArchiveMagic, sizeof(ShaderArchiveMagic)) != 0
+		|| header.m_num_shaders > (data.Size() - sizeof(header)) / sizeof(IndexEntry))
+	{
+		return false;
+	}
+
+	// Check the whole index up front so lookups can trust it
+	uint64_t last_name_hash = 0;
+	for (size_t i = 0; i < header.m_num_shaders; ++i)
+	{
+		const IndexEntry entry = ReadEntry(data, i);
+		if (entry.m_name_hash < last_name_hash
+			|| uint64_t(entry.m_name_offset) + entry.m_name_size > data.Size()
+			|| uint64_t(entry.m_code_offset) + entry.m_code_size > data.Size()
+			|| entry.m_code_offset % 4 != 0)
+		{
+			return false;
+		}
+		last_name_hash = entry.m_name_hash;
+	}
+
+	m_data = data;
+	m_num_shaders = header.m_num_shaders;
+	return true;
+}
+
+mu::ShaderArchive::Shader mu::ShaderArchive::GetShader(size_t index) const
+{
+	const IndexEntry entry = ReadEntry(m_data, index);
+	Shader shader;
+	shader.m_name = StringView(reinterpret_cast<const char*>(m_data.Data()) + entry.m_name_offset, entry.m_name_size);
+	shader.m_content_hash = entry.m_content_hash;
+	shader.m_code = Range(m_data.Data() + entry.m_code_offset, entry.m_code_size);
+	return shader;
+}
+
+bool mu::ShaderArchive::Find(StringView name, Shader& out_shader) const
+{
+	const uint64_t name_hash = HashName(name);
+
+	// Find the first entry with the hash, then check the names of every entry sharing it
+	size_t first = 0;
+	size_t count = m_num_shaders;
+	while (count > 0)
+	{
+		const size_t half = count / 2;
+		if (ReadEntry(m_data, first + half).m_name_hash < name_hash)
+		{
+			first += half + 1;
+			count -= half + 1;
+		}
+		else
+		{
+			count = half;
+		}
+	}
+	for (size_t i = first; i < m_num_shaders && ReadEntry(m_data, i).m_name_hash == name_hash; ++i)
+	{
+		const Shader shader = GetShader(i);
+		if (shader.m_name == name)
+		{
+			out_shader = shader;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "Array.h"
+#include "HashTable.h"
+#include "Ranges.h"
+#include "StringView.h"
+
+// A single file holding every compiled shader, built by the mu_shader_packer tool after the shaders
+//	are compiled and memory mapped at startup, so loading thousands of shaders opens one file.
+// The index is sorted by name hash for lookup without reading the whole file, and SPIR-V shared by
+//	several shaders is stored once with its content hash so users can share one module between them.
+namespace mu
+{
+	class ShaderArchiveWriter
+	{
+		struct Shader
+		{
+			std::string m_name;
+			uint64_t m_name_hash;
+			uint32_t m_blob;
+		};
+
+		struct Blob
+		{
+			Array<uint8_t> m_code;
+			uint64_t m_content_hash;
+		};
+
+		Array<Shader> m_shaders;
+		Array<Blob> m_blobs;
+		HashMap<uint64_t, uint32_t> m_blob_by_hash;
+
+	public:
+		// Throws std::runtime_error if name was already added or code isn't SPIR-V
+		void Add(StringView name, ranges::PointerRange<const uint8_t> code);
+
+		size_t GetNumShaders() const { return m_shaders.Num(); }
+		size_t GetNumBlobs() const { return m_blobs.Num(); }
+
+		// The archive file's contents
+		Array<uint8_t> Build() const;
+	};
+
+	// Reads an archive in place, such as from a MappedFile. Shader code points into the data,
+	//	which is at least as aligned as the data itself so may be handed straight to Vulkan.
+	class ShaderArchive
+	{
+		ranges::PointerRange<const uint8_t> m_data{ nullptr, nullptr };
+		uint32_t m_num_shaders = 0;
+
+	public:
+		struct Shader
+		{
+			StringView m_name;
+			uint64_t m_content_hash = 0;
+			ranges::PointerRange<const uint8_t> m_code{ nullptr, nullptr };
+		};
+
+		// Returns false if data isn't a whole shader archive
+		bool Open(ranges::PointerRange<const uint8_t> data);
+
+		size_t GetNumShaders() const { return m_num_shaders; }
+		Shader GetShader(size_t index) const;
+
+		// Returns false if no shader is called name
+		bool Find(StringView name, Shader& out_shader) const;
+	};
+}
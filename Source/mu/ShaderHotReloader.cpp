@@ -0,0 +1,133 @@
+#include "ShaderHotReloader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "Debug.h"
+#include "FileReader.h"
+
+namespace
+{
+	bool IsShaderSource(const std::string& name)
+	{
+		const char* extensions[] = { ".vert", ".frag" };
+		for (const char* extension : extensions)
+		{
+			const size_t length = strlen(extension);
+			if (name.size() > length && name.compare(name.size() - length, length, extension) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+ShaderHotReloader::ShaderHotReloader(const char* source_directory, const char* output_directory, const char* compiler)
+	: m_source_directory(source_directory)
+	, m_output_directory(output_directory)
+	, m_compiler(compiler)
+{
+	m_watcher = FileWatcher::Open(source_directory);
+	if (!m_watcher.IsValid())
+	{
+		throw std::runtime_error(std::string("Failed to watch ") + source_directory);
+	}
+	m_thread = std::thread([this]() { WatchLoop(); });
+}
+
+ShaderHotReloader::~ShaderHotReloader()
+{
+	m_stop = true;
+	m_thread.join();
+}
+
+bool ShaderHotReloader::TakeCompiled(Array<CompiledShader>& out_shaders)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_compiled.IsEmpty())
+	{
+		return false;
+	}
+	for (CompiledShader& shader : m_compiled)
+	{
+		out_shaders.Add(std::move(shader));
+	}
+	m_compiled.Clear();
+	return true;
+}
+
+void ShaderHotReloader::WatchLoop()
+{
+	Array<std::string> names;
+	while (!m_stop)
+	{
+		// Wake regularly to notice m_stop
+		names.Clear();
+		if (!m_watcher.Wait(100, names))
+		{
+			continue;
+		}
+		// A save is often several writes, let them finish so each shader compiles once
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		m_watcher.Wait(0, names);
+
+		for (const std::string& name : names)
+		{
+			CompiledShader compiled;
+			if (!IsShaderSource(name) || !Compile(name, compiled.m_code))
+			{
+				continue;
+			}
+			compiled.m_name = name;
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			bool replaced = false;
+			for (CompiledShader& existing : m_compiled)
+			{
+				if (existing.m_name == name)
+				{
+					existing = std::move(compiled);
+					replaced = true;
+					break;
+				}
+			}
+			if (!replaced)
+			{
+				m_compiled.Add(std::move(compiled));
+			}
+		}
+	}
+}
+
+bool ShaderHotReloader::Compile(const std::string& name, Array<uint8_t>& out_code) const
+{
+	const std::string source_path = m_source_directory + "/" + name;
+	const std::string output_path = m_output_directory + "/" + name + ".reload.spv";
+	std::string command = "\"" + m_compiler + "\" -V \"" + source_path + "\" -o \"" + output_path + "\"";
+#ifdef _WIN32
+	// cmd.exe strips the first and last quote of the whole command line
+	command = "\"" + command + "\"";
+#endif
+	// The compiler prints its errors to the console itself
+	if (std::system(command.c_str()) != 0)
+	{
+		mu::dbg::Log("Failed to compile shader ", name.c_str());
+		return false;
+	}
+	try
+	{
+		out_code = LoadFileToArray(output_path.c_str());
+	}
+	catch (const std::runtime_error& e)
+	{
+		mu::dbg::Log("Failed to load recompiled shader ", name.c_str(), ": ", e.what());
+		return false;
+	}
+	remove(output_path.c_str());
+	mu::dbg::Log("Recompiled shader ", name.c_str());
+	return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Array.h"
+#include "FileWatcher.h"
+
+// Recompiles GLSL shaders to SPIR-V on a background thread whenever their source changes, so shader
+//	edits show up without rebuilding or restarting. The frame loop collects the results with TakeCompiled.
+// Only the running program sees the new code, rebuild to update the shader archive.
+class ShaderHotReloader
+{
+public:
+	struct CompiledShader
+	{
+		std::string m_name;	// the source file name, such as shader.vert, as named in the shader archive
+		Array<uint8_t> m_code;
+	};
+
+private:
+	std::string m_source_directory;
+	std::string m_output_directory;
+	std::string m_compiler;
+	FileWatcher m_watcher;
+	std::thread m_thread;
+	std::atomic<bool> m_stop{ false };
+	std::mutex m_mutex;
+	Array<CompiledShader> m_compiled;	// guarded by m_mutex
+
+public:
+	// Compiles with compiler, which must take glslangValidator's arguments, writing temporary files
+	//	to output_directory. Throws std::runtime_error if source_directory can't be watched.
+	ShaderHotReloader(const char* source_directory, const char* output_directory, const char* compiler = "glslangValidator");
+	ShaderHotReloader(const ShaderHotReloader&) = delete;
+	ShaderHotReloader& operator=(const ShaderHotReloader&) = delete;
+
+	// Waits for any compile in progress
+	~ShaderHotReloader();
+
+	// Moves the shaders compiled since the last call into out_shaders, which only holds the latest
+	//	code for each. Returns false if there are none. Never waits for a compile.
+	bool TakeCompiled(Array<CompiledShader>& out_shaders);
+
+private:
+	void WatchLoop();
+	bool Compile(const std::string& name, Array<uint8_t>& out_code) const;
+};
@@ -0,0 +1,68 @@
+#include "ShaderLibrary.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "Profiler.h"
+
+mu::vk::ShaderLibrary::ShaderLibrary(VkDevice device, const char* path)
+	: m_device(device)
+{
+	// Shaders are read in whatever order pipelines ask for them
+	m_file = MappedFile::Open(path, FileAccessHint::Random);
+	if (!m_file.IsValidFile())
+	{
+		throw std::runtime_error(std::string("Failed to open shader archive ") + path);
+	}
+	if (!m_archive.Open(m_file.GetRange()))
+	{
+		throw std::runtime_error(std::string("Not a shader archive: ") + path);
+	}
+}
+
+VkShaderModule mu::vk::ShaderLibrary::GetModule(StringView name)
+{
+	ShaderArchive::Shader shader;
+	if (!m_archive.Find(name, shader))
+	{
+		throw std::runtime_error("No shader called " + std::string(name.Data(), name.Size()));
+	}
+	if (const ShaderModule* reloaded = m_reloaded.Find(shader.m_name))
+	{
+		return *reloaded;
+	}
+	if (const ShaderModule* existing = m_modules.Find(shader.m_content_hash))
+	{
+		return *existing;
+	}
+	return m_modules.Add(shader.m_content_hash, CreateModule(name, shader.m_code));
+}
+
+bool mu::vk::ShaderLibrary::Reload(StringView name, ranges::PointerRange<const uint8_t> code)
+{
+	ShaderArchive::Shader shader;
+	if (!m_archive.Find(name, shader))
+	{
+		return false;
+	}
+	// Keyed by the archive's copy of the name, which lives as long as the mapping
+	m_reloaded.Add(shader.m_name, CreateModule(name, code));
+	return true;
+}
+
+mu::vk::ShaderModule mu::vk::ShaderLibrary::CreateModule(StringView name, ranges::PointerRange<const uint8_t> code) const
+{
+	MU_PROFILE_ZONE("ShaderLibrary::CreateModule");
+	VkShaderModuleCreateInfo create_info = {
+		VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		nullptr,
+		0,
+		code.Size(), reinterpret_cast<const uint32_t*>(code.Data()),
+	};
+	ShaderModule shader_module{ m_device, nullptr };
+	if (vkCreateShaderModule(m_device, &create_info, nullptr, shader_module.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create shader module " + std::string(name.Data(), name.Size()));
+	}
+	return std::move(shader_module);
+}
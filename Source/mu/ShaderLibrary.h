@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "HashTable.h"
+#include "MappedFile.h"
+#include "ShaderArchive.h"
+#include "StringView.h"
+#include "VulkanTools.h"
+
+namespace mu
+{
+	namespace vk
+	{
+		// Shader modules by name from a memory mapped ShaderArchive.
+		// A module is only created the first time a shader needing it is asked for, and shaders with
+		//	identical SPIR-V share one module, so large archives cost little until they're used.
+		// Not thread safe.
+		class ShaderLibrary
+		{
+			VkDevice m_device = nullptr;
+			MappedFile m_file;
+			ShaderArchive m_archive;
+			HashMap<uint64_t, ShaderModule> m_modules;	// by content hash
+			HashMap<StringView, ShaderModule> m_reloaded;	// by the name stored in the archive
+
+		public:
+			ShaderLibrary() {}
+			// Throws std::runtime_error if path isn't a shader archive
+			ShaderLibrary(VkDevice device, const char* path);
+
+			ShaderLibrary(ShaderLibrary&&) = default;
+			ShaderLibrary& operator=(ShaderLibrary&&) = default;
+			ShaderLibrary(const ShaderLibrary&) = delete;
+			ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+			size_t GetNumShaders() const { return m_archive.GetNumShaders(); }
+			size_t GetNumModules() const { return m_modules.Num(); }
+
+			// Throws std::runtime_error if there's no shader called name or its module can't be created
+			VkShaderModule GetModule(StringView name);
+
+			// Replaces the code of a shader in the archive, such as after recompiling it while running.
+			// Destroys any module from an earlier Reload of the shader, which must no longer be in use
+			//	by a pipeline being created. Returns false if there's no shader called name.
+			// Throws std::runtime_error if the module can't be created.
+			bool Reload(StringView name, ranges::PointerRange<const uint8_t> code);
+
+		private:
+			ShaderModule CreateModule(StringView name, ranges::PointerRange<const uint8_t> code) const;
+		};
+	}
+}
@@ -0,0 +1,303 @@
+#include "StagingUploader.h"
+#include "Profiler.h"
+
+#include <cstring>
+#include <stdexcept>
+
+mu::vk::StagingUploader::StagingUploader(VkPhysicalDevice physical_device, VkDevice device, DeviceMemoryAllocator& allocator,
+	uint32_t queue_family, VkQueue queue, VkDeviceSize size, uint32_t num_batches)
+	: m_device(device)
+	, m_queue(queue)
+	, m_queue_family(queue_family)
+	, m_ring(size)
+{
+	// Copies to images need offsets aligned to the texel size, which is at most 16 bytes
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physical_device, &properties);
+	m_alignment = properties.limits.optimalBufferCopyOffsetAlignment > 16 ? properties.limits.optimalBufferCopyOffsetAlignment : 16;
+
+	const VkBufferCreateInfo buffer_info = {
+		VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+		nullptr,
+		0,
+		size,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_SHARING_MODE_EXCLUSIVE,
+		0, nullptr
+	};
+	m_buffer = Buffer{ device, nullptr };
+	if (vkCreateBuffer(device, &buffer_info, nullptr, m_buffer.Replace()) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to create staging buffer");
+	}
+	m_memory = allocator.AllocateForBuffer(m_buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	const VkCommandPoolCreateInfo pool_info = {
+		VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		nullptr,
+		VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		queue_family
+	};
+	const VkFenceCreateInfo fence_info = {
+		VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+		nullptr,
+		0
+	};
+	const VkSemaphoreCreateInfo semaphore_info = {
+		VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+		nullptr,
+		0
+	};
+	m_batches.Reserve(num_batches);
+	for (uint32_t i = 0; i < num_batches; ++i)
+	{
+		m_batches.Emplace();
+		Batch& batch = m_batches[i];
+		batch.m_pool = CommandPool{ device, nullptr };
+		if (vkCreateCommandPool(device, &pool_info, nullptr, batch.m_pool.Replace()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create command pool");
+		}
+		const VkCommandBufferAllocateInfo alloc_info = {
+			VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			nullptr,
+			batch.m_pool,
+			VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			1
+		};
+		if (vkAllocateCommandBuffers(device, &alloc_info, &batch.m_command_buffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate command buffers");
+		}
+		batch.m_fence = Fence{ device, nullptr };
+		if (vkCreateFence(device, &fence_info, nullptr, batch.m_fence.Replace()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create fence");
+		}
+		batch.m_done = Semaphore{ device, nullptr };
+		if (vkCreateSemaphore(device, &semaphore_info, nullptr, batch.m_done.Replace()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create semaphore");
+		}
+	}
+
+	// Enough for a frame's worth of uploads without touching the heap
+	m_buffer_copies.Reserve(256);
+	m_image_copies.Reserve(64);
+	m_scratch_regions.Reserve(256);
+	m_scratch_barriers.Reserve(64);
+}
+
+void* mu::vk::StagingUploader::UploadToBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size)
+{
+	const VkDeviceSize staging_offset = Allocate(size);
+	m_buffer_copies.Add(BufferCopy{ buffer, VkBufferCopy{ staging_offset, offset, size } });
+	return m_memory->m_mapped + staging_offset;
+}
+
+void mu::vk::StagingUploader::UploadToBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+	// Smaller pieces can go in while earlier ones are still being copied
+	const VkDeviceSize max_piece = m_ring.GetSize() / 4;
+	const uint8_t* bytes = (const uint8_t*)data;
+	while (size > 0)
+	{
+		const VkDeviceSize piece = size < max_piece ? size : max_piece;
+		memcpy(UploadToBuffer(buffer, offset, piece), bytes, size_t(piece));
+		offset += piece;
+		bytes += piece;
+		size -= piece;
+	}
+}
+
+void* mu::vk::StagingUploader::UploadToImage(VkImage image, const VkBufferImageCopy& region, VkDeviceSize size, VkImageLayout final_layout)
+{
+	const VkDeviceSize staging_offset = Allocate(size);
+	ImageCopy copy{ image, region, final_layout };
+	copy.m_region.bufferOffset = staging_offset;
+	m_image_copies.Add(copy);
+	return m_memory->m_mapped + staging_offset;
+}
+
+VkSemaphore mu::vk::StagingUploader::Flush()
+{
+	MU_PROFILE_ZONE("StagingUploader::Flush");
+	ReclaimFinished();
+
+	// A submit made when the ring filled up still needs a semaphore, an empty one signals after it
+	if (m_buffer_copies.IsEmpty() && m_image_copies.IsEmpty() && !m_submitted_unsignalled)
+	{
+		return VK_NULL_HANDLE;
+	}
+	const VkSemaphore done = m_batches[m_next_batch].m_done;
+	Submit(true);
+	m_submitted_unsignalled = false;
+	return done;
+}
+
+VkDeviceSize mu::vk::StagingUploader::Allocate(VkDeviceSize size)
+{
+	if (size > m_ring.GetSize())
+	{
+		throw std::runtime_error("Upload is larger than the staging buffer");
+	}
+	m_bytes_uploaded += size;
+
+	uint64_t offset = m_ring.Allocate(size, m_alignment);
+	if (offset == RingAllocator::InvalidOffset)
+	{
+		ReclaimFinished();
+		offset = m_ring.Allocate(size, m_alignment);
+	}
+	while (offset == RingAllocator::InvalidOffset)
+	{
+		MU_PROFILE_ZONE("StagingUploader::Stall");
+		// Queued copies hold on to their staging memory until they are submitted
+		if (!m_buffer_copies.IsEmpty() || !m_image_copies.IsEmpty())
+		{
+			Submit(false);
+			m_submitted_unsignalled = true;
+		}
+
+		// Batches are submitted in order, so the oldest in flight is the first after the next to be used
+		const uint32_t num_batches = uint32_t(m_batches.Num());
+		for (uint32_t i = 0; i < num_batches; ++i)
+		{
+			Batch& batch = m_batches[(m_next_batch + i) % num_batches];
+			if (batch.m_submitted)
+			{
+				++m_num_stalls;
+				VkFence fence = batch.m_fence;
+				vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+				ReclaimBatch(batch);
+				break;
+			}
+		}
+		offset = m_ring.Allocate(size, m_alignment);
+	}
+	return offset;
+}
+
+void mu::vk::StagingUploader::Submit(bool signal)
+{
+	Batch& batch = m_batches[m_next_batch];
+	VkFence fence = batch.m_fence;
+	if (batch.m_submitted)
+	{
+		++m_num_stalls;
+		vkWaitForFences(m_device, 1, &fence, VK_TRUE, UINT64_MAX);
+		ReclaimBatch(batch);
+	}
+	vkResetFences(m_device, 1, &fence);
+
+	const bool has_copies = !m_buffer_copies.IsEmpty() || !m_image_copies.IsEmpty();
+	if (has_copies)
+	{
+		if (vkResetCommandPool(m_device, batch.m_pool, 0) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to reset command pool");
+		}
+		const VkCommandBufferBeginInfo begin_info = {
+			VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			nullptr,
+			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+			nullptr
+		};
+		VkCommandBuffer cb = batch.m_command_buffer;
+		if (vkBeginCommandBuffer(cb, &begin_info) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to begin recording command buffer");
+		}
+
+		// One copy command for each run of uploads to the same buffer
+		for (size_t i = 0; i < m_buffer_copies.Num();)
+		{
+			const VkBuffer dst = m_buffer_copies[i].m_buffer;
+			m_scratch_regions.Clear();
+			for (; i < m_buffer_copies.Num() && m_buffer_copies[i].m_buffer == dst; ++i)
+			{
+				m_scratch_regions.Add(m_buffer_copies[i].m_region);
+			}
+			vkCmdCopyBuffer(cb, m_buffer, dst, uint32_t(m_scratch_regions.Num()), m_scratch_regions.Data());
+		}
+
+		if (!m_image_copies.IsEmpty())
+		{
+			// All images move to TRANSFER_DST in one barrier and to their final layouts in another
+			m_scratch_barriers.Clear();
+			for (const ImageCopy& copy : m_image_copies)
+			{
+				const VkImageSubresourceLayers& layers = copy.m_region.imageSubresource;
+				m_scratch_barriers.Add(VkImageMemoryBarrier{
+					VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+					nullptr,
+					0, VK_ACCESS_TRANSFER_WRITE_BIT,
+					VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+					VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
+					copy.m_image,
+					VkImageSubresourceRange{ layers.aspectMask, layers.mipLevel, 1, layers.baseArrayLayer, layers.layerCount }
+				});
+			}
+			vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+				0, nullptr, 0, nullptr, uint32_t(m_scratch_barriers.Num()), m_scratch_barriers.Data());
+
+			for (const ImageCopy& copy : m_image_copies)
+			{
+				vkCmdCopyBufferToImage(cb, m_buffer, copy.m_image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy.m_region);
+			}
+
+			// The semaphore the user waits on makes the writes visible, so the barrier only changes layouts
+			for (size_t i = 0; i < m_image_copies.Num(); ++i)
+			{
+				VkImageMemoryBarrier& barrier = m_scratch_barriers[i];
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = 0;
+				barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+				barrier.newLayout = m_image_copies[i].m_final_layout;
+			}
+			vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+				0, nullptr, 0, nullptr, uint32_t(m_scratch_barriers.Num()), m_scratch_barriers.Data());
+		}
+
+		if (vkEndCommandBuffer(cb) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to record command buffer");
+		}
+	}
+
+	VkSemaphore done = batch.m_done;
+	const VkSubmitInfo submit_info = {
+		VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		nullptr,
+		0, nullptr, nullptr,
+		has_copies ? 1u : 0u, &batch.m_command_buffer,
+		signal ? 1u : 0u, &done
+	};
+	if (vkQueueSubmit(m_queue, 1, &submit_info, fence) != VK_SUCCESS)
+	{
+		throw std::runtime_error("Failed to submit uploads");
+	}
+	batch.m_ring_end = m_ring.GetHead();
+	batch.m_submitted = true;
+	m_next_batch = (m_next_batch + 1) % uint32_t(m_batches.Num());
+	m_buffer_copies.Clear();
+	m_image_copies.Clear();
+}
+
+void mu::vk::StagingUploader::ReclaimFinished()
+{
+	// Free the staging memory of every submit which has finished, not just the oldest
+	for (Batch& batch : m_batches)
+	{
+		if (batch.m_submitted && vkGetFenceStatus(m_device, batch.m_fence) == VK_SUCCESS)
+		{
+			ReclaimBatch(batch);
+		}
+	}
+}
+
+void mu::vk::StagingUploader::ReclaimBatch(Batch& batch)
+{
+	m_ring.Release(batch.m_ring_end);
+	batch.m_submitted = false;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include "Array.h"
+#include "DeviceMemory.h"
+#include "RingAllocator.h"
+#include "VulkanTools.h"
+
+namespace mu
+{
+	namespace vk
+	{
+		// Streams data into buffers and images through a persistently mapped staging buffer.
+		// Uploads write into a ring of staging memory and queue a copy. Flush records every queued copy
+		//	into one command buffer and submits it, ideally to a transfer queue so copies overlap rendering.
+		// Each submit has a fence, and the staging memory it read is reused once the fence signals. Only when
+		//	the ring is full does an upload wait for the GPU.
+		// When the queue family differs from the one using the data, resources must be created with
+		//	VK_SHARING_MODE_CONCURRENT across both families.
+		class StagingUploader
+		{
+			struct Batch
+			{
+				CommandPool m_pool;
+				VkCommandBuffer m_command_buffer = nullptr;
+				Fence m_fence;
+				Semaphore m_done;
+				uint64_t m_ring_end = 0;	// staging memory before this is free once m_fence signals
+				bool m_submitted = false;
+			};
+
+			struct BufferCopy
+			{
+				VkBuffer m_buffer;
+				VkBufferCopy m_region;
+			};
+
+			struct ImageCopy
+			{
+				VkImage m_image;
+				VkBufferImageCopy m_region;
+				VkImageLayout m_final_layout;
+			};
+
+			VkDevice m_device = nullptr;
+			VkQueue m_queue = nullptr;
+			uint32_t m_queue_family = 0;
+			DeviceAllocation m_memory;
+			Buffer m_buffer;
+			RingAllocator m_ring;
+			VkDeviceSize m_alignment = 1;
+
+			Array<Batch> m_batches;
+			uint32_t m_next_batch = 0;
+			bool m_submitted_unsignalled = false;	// submitted since the last Flush without signalling a semaphore
+
+			Array<BufferCopy> m_buffer_copies;
+			Array<ImageCopy> m_image_copies;
+			Array<VkBufferCopy> m_scratch_regions;
+			Array<VkImageMemoryBarrier> m_scratch_barriers;
+
+			uint64_t m_bytes_uploaded = 0;
+			uint32_t m_num_stalls = 0;
+
+		public:
+			StagingUploader() {}
+			// num_batches is how many submits may be in flight at once, such as one more than the frames in flight
+			StagingUploader(VkPhysicalDevice physical_device, VkDevice device, DeviceMemoryAllocator& allocator,
+				uint32_t queue_family, VkQueue queue, VkDeviceSize size, uint32_t num_batches);
+
+			StagingUploader(StagingUploader&&) = default;
+			StagingUploader& operator=(StagingUploader&&) = default;
+			StagingUploader(const StagingUploader&) = delete;
+			StagingUploader& operator=(const StagingUploader&) = delete;
+
+			uint32_t GetQueueFamily() const { return m_queue_family; }
+			uint64_t GetBytesUploaded() const { return m_bytes_uploaded; }
+			// Uploads which had to wait for the GPU to free staging memory
+			uint32_t GetNumStalls() const { return m_num_stalls; }
+
+			// Returns where to write size bytes which the next Flush copies to buffer at offset.
+			// Throws if size is more than the whole ring.
+			void* UploadToBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size);
+			// Copies data in pieces of up to a quarter of the ring, so it may be any size
+			void UploadToBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+			// Returns where to write size bytes which the next Flush copies to the image as region describes,
+			//	ignoring its bufferOffset. The region's subresource is left in final_layout and its previous
+			//	contents are discarded, so upload each subresource whole.
+			void* UploadToImage(VkImage image, const VkBufferImageCopy& region, VkDeviceSize size, VkImageLayout final_layout);
+
+			// Submits the queued copies. Returns a semaphore which the first submit using the data must wait
+			//	on before Flush is called again, or VK_NULL_HANDLE if nothing was uploaded.
+			VkSemaphore Flush();
+
+		private:
+			VkDeviceSize Allocate(VkDeviceSize size);
+			void Submit(bool signal);
+			void ReclaimFinished();
+			void ReclaimBatch(Batch& batch);
+		};
+	}
+}
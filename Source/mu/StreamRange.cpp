@@ -0,0 +1,157 @@
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "StreamRange.h"
+#include "Array.h"
+#include "FileReader.h"
+
+struct StreamRange::State
+{
+	FileReader m_reader;
+	int64_t m_unread_bytes;
+	size_t m_chunk_size;
+
+	// The consumer reads from the front buffer while the read thread fills the other one
+	Array<uint8_t> m_buffers[2];
+	size_t m_front_buffer = 0;
+	mu::ranges::PointerRange<const uint8_t> m_front;
+
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	bool m_read_requested = false;
+	bool m_read_done = false;
+	bool m_stop = false;
+	size_t m_read_size = 0;
+	std::exception_ptr m_read_error;
+
+	State(FileReader reader, size_t chunk_size)
+		: m_reader(std::move(reader))
+		, m_unread_bytes(m_reader.GetFileSize())
+		, m_chunk_size(chunk_size > 0 ? chunk_size : 1)
+		, m_front(nullptr, nullptr)
+	{
+		const size_t buffer_size = int64_t(m_chunk_size) < m_unread_bytes ? m_chunk_size : size_t(m_unread_bytes);
+		m_buffers[0] = Array<uint8_t>::MakeUninitialized(buffer_size);
+		m_buffers[1] = Array<uint8_t>::MakeUninitialized(buffer_size);
+		m_thread = std::thread([this]() { ReadLoop(); });
+	}
+
+	~State()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		m_thread.join();
+	}
+
+	// Start reading the next chunk into the back buffer
+	void RequestRead()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_read_requested = true;
+			m_read_done = false;
+		}
+		m_wake.notify_all();
+	}
+
+	// Wait for the requested chunk and make it the front
+	void FlipBuffers()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_wake.wait(lock, [this]() { return m_read_done; });
+		if (m_read_error)
+		{
+			std::rethrow_exception(m_read_error);
+		}
+
+		m_front_buffer = 1 - m_front_buffer;
+		const uint8_t* data = m_buffers[m_front_buffer].Data();
+		m_front = mu::Range(data, m_read_size);
+	}
+
+	void Advance()
+	{
+		FlipBuffers();
+		if (!m_front.IsEmpty())
+		{
+			RequestRead();
+		}
+	}
+
+	void ReadLoop()
+	{
+		for (;;)
+		{
+			uint8_t* back_buffer = nullptr;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [this]() { return m_stop || m_read_requested; });
+				if (m_stop)
+				{
+					return;
+				}
+				m_read_requested = false;
+				back_buffer = m_buffers[1 - m_front_buffer].Data();
+			}
+
+			// The back buffer is only touched by this thread until the read is marked done
+			size_t read_size = 0;
+			std::exception_ptr error;
+			try
+			{
+				read_size = int64_t(m_chunk_size) < m_unread_bytes ? m_chunk_size : size_t(m_unread_bytes);
+				m_reader.Read(mu::Range(back_buffer, read_size));
+				m_unread_bytes -= int64_t(read_size);
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_read_size = read_size;
+				m_read_error = error;
+				m_read_done = true;
+			}
+			m_wake.notify_all();
+		}
+	}
+};
+
+StreamRange StreamRange::Open(const char* path, size_t chunk_size)
+{
+	FileReader reader = FileReader::Open(path);
+	if (!reader.IsValidFile())
+	{
+		throw std::runtime_error("Failed to open file");
+	}
+
+	StreamRange stream;
+	stream.m_state = std::make_shared<State>(std::move(reader), chunk_size);
+	stream.m_state->RequestRead();
+	stream.m_state->Advance();
+	return stream;
+}
+
+void StreamRange::Advance()
+{
+	m_state->Advance();
+}
+
+bool StreamRange::IsEmpty() const
+{
+	return !m_state || m_state->m_front.IsEmpty();
+}
+
+mu::ranges::PointerRange<const uint8_t> StreamRange::Front() const
+{
+	return m_state->m_front;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Ranges.h"
+
+// Single pass forward range over a file in fixed size chunks, for processing files which don't
+//	fit in memory:
+//	Map(StreamRange::Open(path), [&](PointerRange<const uint8_t> chunk) { ... });
+// The next chunk is read on a background thread while the current one is processed, using
+//	two chunk buffers whatever the size of the file.
+// Front() is valid until the next Advance(). Copies share the same stream and read position.
+class StreamRange : public mu::ranges::details::WithBeginEnd<StreamRange>
+{
+	struct State;
+	std::shared_ptr<State> m_state;
+
+public:
+	enum { HasSize = 0 };
+
+	StreamRange() {}
+
+	// Throws std::runtime_error if the file can't be opened
+	static StreamRange Open(const char* path, size_t chunk_size = 1024 * 1024);
+
+	// Throws std::runtime_error if a read fails
+	void Advance();
+	bool IsEmpty() const;
+	mu::ranges::PointerRange<const uint8_t> Front() const;
+
+	StreamRange MakeEmpty() const { return StreamRange(); }
+};
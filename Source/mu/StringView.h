@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+namespace mu
+{
+	// Non-owning view of a run of characters, not necessarily null terminated
+	class StringView
+	{
+		const char* m_data	= nullptr;
+		size_t m_size		= 0;
+
+	public:
+		StringView() {}
+
+		StringView(const char* c_str)
+			: m_data(c_str)
+			, m_size(c_str ? strlen(c_str) : 0)
+		{
+		}
+
+		StringView(const char* data, size_t size)
+			: m_data(data)
+			, m_size(size)
+		{
+		}
+
+		const char* Data() const { return m_data; }
+		size_t Size() const { return m_size; }
+		bool IsEmpty() const { return m_size == 0; }
+
+		char operator[](size_t index) const { return m_data[index]; }
+
+		bool operator==(const StringView& other) const
+		{
+			return m_size == other.m_size
+				&& (m_data == other.m_data || memcmp(m_data, other.m_data, m_size) == 0);
+		}
+
+		bool operator!=(const StringView& other) const
+		{
+			return !(*this == other);
+		}
+	};
+}
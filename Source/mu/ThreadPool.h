@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Fixed set of worker threads, each with its own task deque.
+// A worker pushes and pops tasks at the back of its own deque and steals from the front of
+//	the others when it runs dry, so nested work stays on the thread that created it.
+// Threads waiting on a TaskGroup run queued tasks instead of blocking.
+// Tasks must not throw.
+namespace mu
+{
+	// Counts outstanding tasks so a caller can wait for a batch of them
+	class TaskGroup
+	{
+		friend class ThreadPool;
+		std::atomic<size_t> m_pending{ 0 };
+
+	public:
+		TaskGroup() {}
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+	};
+
+	class ThreadPool
+	{
+	public:
+		typedef std::function<void()> Task;
+
+	private:
+		struct QueuedTask
+		{
+			Task m_task;
+			TaskGroup* m_group;
+		};
+
+		struct Worker
+		{
+			std::mutex m_mutex;
+			std::deque<QueuedTask> m_tasks;
+			std::thread m_thread;
+		};
+
+		// Identifies the pool and worker the current thread belongs to, if any
+		struct ThreadIdentity
+		{
+			const ThreadPool* m_pool = nullptr;
+			size_t m_index = 0;
+		};
+
+		std::unique_ptr<Worker[]> m_workers;
+		size_t m_num_workers;
+		std::atomic<size_t> m_num_queued{ 0 };
+		std::atomic<size_t> m_next_worker{ 0 };
+		std::atomic<bool> m_stop{ false };
+		std::mutex m_sleep_mutex;
+		std::condition_variable m_wake;
+
+	public:
+		// The thread calling Wait also runs tasks, so by default leave one core for it
+		static size_t DefaultNumThreads()
+		{
+			const size_t hardware_threads = std::thread::hardware_concurrency();
+			return hardware_threads > 1 ? hardware_threads - 1 : 1;
+		}
+
+		explicit ThreadPool(size_t num_threads = DefaultNumThreads())
+			: m_workers(new Worker[num_threads > 0 ? num_threads : 1])
+			, m_num_workers(num_threads > 0 ? num_threads : 1)
+		{
+			for (size_t i = 0; i < m_num_workers; ++i)
+			{
+				m_workers[i].m_thread = std::thread([this, i]() { WorkerLoop(i); });
+			}
+		}
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Runs all queued tasks before returning
+		~ThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_sleep_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+			for (size_t i = 0; i < m_num_workers; ++i)
+			{
+				m_workers[i].m_thread.join();
+			}
+		}
+
+		// Process wide pool shared by the parallel algorithms
+		static ThreadPool& Default()
+		{
+			static ThreadPool pool;
+			return pool;
+		}
+
+		size_t NumThreads() const { return m_num_workers; }
+
+		void Run(TaskGroup& group, Task task)
+		{
+			group.m_pending.fetch_add(1, std::memory_order_relaxed);
+
+			ThreadIdentity& identity = CurrentThread();
+			const size_t index = identity.m_pool == this
+				? identity.m_index
+				: m_next_worker.fetch_add(1, std::memory_order_relaxed) % m_num_workers;
+
+			// Count before pushing so a thief never sees more tasks than are counted
+			m_num_queued.fetch_add(1, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> lock(m_workers[index].m_mutex);
+				m_workers[index].m_tasks.push_back(QueuedTask{ std::move(task), &group });
+			}
+			{
+				// Pairs with the predicate check in WorkerLoop so the wake up can't be missed
+				std::lock_guard<std::mutex> lock(m_sleep_mutex);
+			}
+			m_wake.notify_one();
+		}
+
+		// Run queued tasks until every task in the group has finished
+		void Wait(TaskGroup& group)
+		{
+			ThreadIdentity& identity = CurrentThread();
+			const size_t home = identity.m_pool == this ? identity.m_index : 0;
+			while (!group.IsDone())
+			{
+				if (!TryRunTask(home, identity.m_pool == this))
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+	private:
+		static ThreadIdentity& CurrentThread()
+		{
+			static thread_local ThreadIdentity identity;
+			return identity;
+		}
+
+		bool PopBack(size_t index, QueuedTask& out_task)
+		{
+			Worker& worker = m_workers[index];
+			std::lock_guard<std::mutex> lock(worker.m_mutex);
+			if (worker.m_tasks.empty()) { return false; }
+
+			out_task = std::move(worker.m_tasks.back());
+			worker.m_tasks.pop_back();
+			return true;
+		}
+
+		bool StealFront(size_t index, QueuedTask& out_task)
+		{
+			Worker& worker = m_workers[index];
+			std::lock_guard<std::mutex> lock(worker.m_mutex);
+			if (worker.m_tasks.empty()) { return false; }
+
+			out_task = std::move(worker.m_tasks.front());
+			worker.m_tasks.pop_front();
+			return true;
+		}
+
+		// Newest task from our own deque, otherwise the oldest task of another worker
+		bool TryRunTask(size_t home, bool is_worker)
+		{
+			if (m_num_queued.load(std::memory_order_acquire) == 0) { return false; }
+
+			QueuedTask task;
+			bool found = is_worker && PopBack(home, task);
+			for (size_t i = is_worker ? 1 : 0; !found && i < m_num_workers; ++i)
+			{
+				found = StealFront((home + i) % m_num_workers, task);
+			}
+			if (!found) { return false; }
+
+			m_num_queued.fetch_sub(1, std::memory_order_relaxed);
+			task.m_task();
+			task.m_group->m_pending.fetch_sub(1, std::memory_order_release);
+			return true;
+		}
+
+		void WorkerLoop(size_t index)
+		{
+			ThreadIdentity& identity = CurrentThread();
+			identity.m_pool = this;
+			identity.m_index = index;
+
+			for (;;)
+			{
+				if (TryRunTask(index, true)) { continue; }
+
+				std::unique_lock<std::mutex> lock(m_sleep_mutex);
+				m_wake.wait(lock, [this]() { return m_stop || m_num_queued.load(std::memory_order_acquire) > 0; });
+				if (m_stop && m_num_queued.load(std::memory_order_acquire) == 0)
+				{
+					return;
+				}
+			}
+		}
+	};
+}
@@ -4,6 +4,7 @@
 #include <tuple>
 
 #include "Array.h"
+#include "Allocators.h"
 
 namespace mu
 {
@@ -33,6 +34,9 @@ namespace mu
 			}
 
 		public:
+			// Handles and their deleter arguments are plain values, so Array can move them with memcpy
+			static constexpr bool IsTriviallyRelocatable = true;
+
 			VkHandle(T h, std::tuple<ARGS...> args)
 				: m_handle(h)
 				, m_args(args...)
@@ -213,26 +217,96 @@ namespace mu
 		using PipelineLayout			= VkHandleDeviceObject<VkPipelineLayout,	vkDestroyPipelineLayout>;
 		using RenderPass				= VkHandleDeviceObject<VkRenderPass,		vkDestroyRenderPass>;
 		using Pipeline					= VkHandleDeviceObject<VkPipeline,			vkDestroyPipeline>;
+		using PipelineCache				= VkHandleDeviceObject<VkPipelineCache,	vkDestroyPipelineCache>;
 		using Framebuffer				= VkHandleDeviceObject<VkFramebuffer,		vkDestroyFramebuffer>;
 		using CommandPool				= VkHandleDeviceObject<VkCommandPool,		vkDestroyCommandPool>;
 		using Semaphore					= VkHandleDeviceObject<VkSemaphore,			vkDestroySemaphore>;
+		using Fence						= VkHandleDeviceObject<VkFence,				vkDestroyFence>;
+		using QueryPool					= VkHandleDeviceObject<VkQueryPool,			vkDestroyQueryPool>;
+		using DeviceMemory				= VkHandleDeviceObject<VkDeviceMemory,		vkFreeMemory>;
+		using Buffer					= VkHandleDeviceObject<VkBuffer,			vkDestroyBuffer>;
+		using Image						= VkHandleDeviceObject<VkImage,				vkDestroyImage>;
+
+		namespace details
+		{
+			// Calls a Vulkan enumeration function once for the count and again to fill the result
+			template<typename T, typename ALLOCATOR, typename FUNC, typename... ARGS>
+			Array<T, ALLOCATOR> Enumerate(ALLOCATOR allocator, FUNC func, ARGS... args)
+			{
+				uint32_t count = 0;
+				func(args..., &count, nullptr);
+				auto items = Array<T, ALLOCATOR>::MakeUninitialized(count, allocator);
+				func(args..., &count, items.Data());
+				return std::move(items);
+			}
+		}
+
+		// Enumeration results are usually short-lived, so callers can supply a scratch allocator
+		template<typename ALLOCATOR = HeapAllocator>
+		Array<VkLayerProperties, ALLOCATOR> EnumerateInstanceLayerProperties(ALLOCATOR allocator = ALLOCATOR())
+		{
+			return details::Enumerate<VkLayerProperties>(allocator, vkEnumerateInstanceLayerProperties);
+		}
+
+		template<typename ALLOCATOR = HeapAllocator>
+		Array<VkExtensionProperties, ALLOCATOR> EnumerateInstanceExtensionProperties(const char* layer_name, ALLOCATOR allocator = ALLOCATOR())
+		{
+			return details::Enumerate<VkExtensionProperties>(allocator, vkEnumerateInstanceExtensionProperties, layer_name);
+		}
+
+		template<typename ALLOCATOR = HeapAllocator>
+		Array<VkExtensionProperties, ALLOCATOR> EnumerateDeviceExtensionProperties(VkPhysicalDevice device, ALLOCATOR allocator = ALLOCATOR())
+		{
+			return details::Enumerate<VkExtensionProperties>(allocator, vkEnumerateDeviceExtensionProperties, device, (const char*)nullptr);
+		}
+
+		template<typename ALLOCATOR = HeapAllocator>
+		Array<VkPhysicalDevice, ALLOCATOR> EnumeratePhysicalDevices(VkInstance instance, ALLOCATOR allocator = ALLOCATOR())
+		{
+			return details::Enumerate<VkPhysicalDevice>(allocator, vkEnumeratePhysicalDevices, instance);
+		}
+
+		template<typename ALLOCATOR = HeapAllocator>
+		Array<VkQueueFamilyProperties, ALLOCATOR> GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice device, ALLOCATOR allocator = ALLOCATOR())
+		{
+			return details::Enumerate<VkQueueFamilyProperties>(allocator, vkGetPhysicalDeviceQueueFamilyProperties, device);
+		}
+
+		template<typename ALLOCATOR = HeapAllocator>
+		Array<VkSurfaceFormatKHR, ALLOCATOR> GetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevice device, VkSurfaceKHR surface, ALLOCATOR allocator = ALLOCATOR())
+		{
+			return details::Enumerate<VkSurfaceFormatKHR>(allocator, vkGetPhysicalDeviceSurfaceFormatsKHR, device, surface);
+		}
 
-		Array<VkLayerProperties>		EnumerateInstanceLayerProperties();
-		Array<VkExtensionProperties>	EnumerateInstanceExtensionProperties(const char* layer_name);
-		Array<VkExtensionProperties>	EnumerateDeviceExtensionProperties(VkPhysicalDevice device);
-		Array<VkPhysicalDevice>			EnumeratePhysicalDevices(VkInstance instance);
-		Array<VkQueueFamilyProperties>	GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice device);
-		Array<VkSurfaceFormatKHR>		GetPhysicalDeviceSurfaceFormatsKHR(VkPhysicalDevice device, VkSurfaceKHR surface);
-		Array<VkPresentModeKHR>			GetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevice device, VkSurfaceKHR surface);
-		Array<VkImage>					GetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swap_chain);
+		template<typename ALLOCATOR = HeapAllocator>
+		Array<VkPresentModeKHR, ALLOCATOR> GetPhysicalDeviceSurfacePresentModesKHR(VkPhysicalDevice device, VkSurfaceKHR surface, ALLOCATOR allocator = ALLOCATOR())
+		{
+			return details::Enumerate<VkPresentModeKHR>(allocator, vkGetPhysicalDeviceSurfacePresentModesKHR, device, surface);
+		}
+
+		template<typename ALLOCATOR = HeapAllocator>
+		Array<VkImage, ALLOCATOR> GetSwapchainImagesKHR(VkDevice device, VkSwapchainKHR swapchain, ALLOCATOR allocator = ALLOCATOR())
+		{
+			return details::Enumerate<VkImage>(allocator, vkGetSwapchainImagesKHR, device, swapchain);
+		}
 
+		template<typename ALLOCATOR = HeapAllocator>
 		struct SwapChainSupport
 		{
-			VkSurfaceCapabilitiesKHR	capabilities;
-			Array<VkSurfaceFormatKHR>	surface_formats;
-			Array<VkPresentModeKHR>		present_modes;
+			VkSurfaceCapabilitiesKHR				capabilities;
+			Array<VkSurfaceFormatKHR, ALLOCATOR>	surface_formats;
+			Array<VkPresentModeKHR, ALLOCATOR>		present_modes;
 		};
-		SwapChainSupport QuerySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface);
+
+		template<typename ALLOCATOR = HeapAllocator>
+		SwapChainSupport<ALLOCATOR> QuerySwapChainSupport(VkPhysicalDevice device, VkSurfaceKHR surface, ALLOCATOR allocator = ALLOCATOR())
+		{
+			SwapChainSupport<ALLOCATOR> details = {};
+			vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
+			details.surface_formats = GetPhysicalDeviceSurfaceFormatsKHR(device, surface, allocator);
+			details.present_modes = GetPhysicalDeviceSurfacePresentModesKHR(device, surface, allocator);
+			return std::move(details);
+		}
 		
 		inline bool ExtentWithin(VkExtent2D extent, VkExtent2D min, VkExtent2D max)
 		{
@@ -0,0 +1,172 @@
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <direct.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+#include "Benchmark.h"
+#include "../mu/AsyncFileReader.h"
+#include "../mu/FileReader.h"
+
+// Loading a directory of small files, the shape of a startup asset load, with a blocking
+//	LoadFileToArray loop against a batch of AsyncFileReader reads.
+// Cold runs drop the files from the OS file cache before each iteration, outside of the timing.
+
+namespace mu_benchmarks
+{
+	static const size_t NumSmallFiles = 4096;
+	static const char* SmallFileDirectory = "mu_benchmarks_small_files";
+
+	class SmallFiles
+	{
+		Array<std::string> m_paths;
+
+	public:
+		SmallFiles()
+		{
+#ifdef _WIN32
+			_mkdir(SmallFileDirectory);
+#else
+			mkdir(SmallFileDirectory, 0755);
+#endif
+			Array<uint8_t> contents = Array<uint8_t>::MakeUninitialized(8192);
+			for (size_t i = 0; i < contents.Num(); ++i)
+			{
+				contents[i] = uint8_t(i);
+			}
+
+			for (size_t i = 0; i < NumSmallFiles; ++i)
+			{
+				std::string path = std::string(SmallFileDirectory) + "/" + std::to_string(i) + ".bin";
+				FILE* f = fopen(path.c_str(), "wb");
+				// Between 1KB and 8KB
+				fwrite(contents.Data(), 1, 1024 + (i * 7919) % 7168, f);
+				fclose(f);
+				m_paths.Add(std::move(path));
+			}
+		}
+
+		~SmallFiles()
+		{
+			for (const std::string& path : m_paths)
+			{
+				remove(path.c_str());
+			}
+#ifdef _WIN32
+			_rmdir(SmallFileDirectory);
+#else
+			rmdir(SmallFileDirectory);
+#endif
+		}
+
+		const Array<std::string>& Paths() const { return m_paths; }
+
+		// Best effort, the OS may keep some pages cached
+		void EvictFromCache() const
+		{
+			for (const std::string& path : m_paths)
+			{
+#ifdef _WIN32
+				// Opening a file unbuffered discards its cached pages
+				std::wstring wide_path(path.begin(), path.end());
+				HANDLE handle = CreateFile(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+				if (handle != INVALID_HANDLE_VALUE) { CloseHandle(handle); }
+#else
+				const int fd = open(path.c_str(), O_RDONLY);
+				if (fd >= 0)
+				{
+					posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+					close(fd);
+				}
+#endif
+			}
+		}
+	};
+
+	static const SmallFiles& GetSmallFiles()
+	{
+		static SmallFiles files;
+		return files;
+	}
+
+	static void LoadSmallFilesBlocking(const SmallFiles& files)
+	{
+		for (const std::string& path : files.Paths())
+		{
+			Consume(LoadFileToArray(path.c_str()).Num());
+		}
+	}
+
+	static void LoadSmallFilesAsync(const SmallFiles& files)
+	{
+		std::atomic<size_t> total_bytes{ 0 };
+		AsyncFileReader reader{ 256 };
+		for (const std::string& path : files.Paths())
+		{
+			reader.Read(path.c_str(), [&total_bytes](Array<uint8_t>&& data, const char*)
+			{
+				total_bytes += data.Num();
+			});
+		}
+		reader.WaitIdle();
+		Consume(total_bytes.load());
+	}
+}
+
+MU_BENCHMARK_ITEMS(LoadSmallFilesWarm, mu_benchmarks::NumSmallFiles)
+{
+	using namespace mu_benchmarks;
+	const SmallFiles& files = GetSmallFiles();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		LoadSmallFilesBlocking(files);
+	}
+}
+
+MU_BENCHMARK_ITEMS(AsyncLoadSmallFilesWarm, mu_benchmarks::NumSmallFiles)
+{
+	using namespace mu_benchmarks;
+	const SmallFiles& files = GetSmallFiles();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		LoadSmallFilesAsync(files);
+	}
+}
+
+MU_BENCHMARK_ITEMS(LoadSmallFilesCold, mu_benchmarks::NumSmallFiles)
+{
+	using namespace mu_benchmarks;
+	const SmallFiles& files = GetSmallFiles();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		{
+			ScopedPauseTiming pause;
+			files.EvictFromCache();
+		}
+		LoadSmallFilesBlocking(files);
+	}
+}
+
+MU_BENCHMARK_ITEMS(AsyncLoadSmallFilesCold, mu_benchmarks::NumSmallFiles)
+{
+	using namespace mu_benchmarks;
+	const SmallFiles& files = GetSmallFiles();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		{
+			ScopedPauseTiming pause;
+			files.EvictFromCache();
+		}
+		LoadSmallFilesAsync(files);
+	}
+}
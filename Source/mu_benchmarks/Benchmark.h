@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../mu/Scope.h"
+
+// Minimal microbenchmark harness.
+// Each benchmark is a function which runs its workload the given number of times:
+//	MU_BENCHMARK(ArrayAdd)
+//	{
+//		for (size_t i = 0; i < iterations; ++i) { ... }
+//	}
+// The runner picks an iteration count so that each benchmark runs for a measurable time
+//	and reports the average time per item, where an iteration processes ITEMS items.
+// Each benchmark is first called once with zero iterations outside of the timed runs,
+//	so function local statics can hold data which is expensive to set up.
+
+#define MU_BENCHMARK(NAME) MU_BENCHMARK_ITEMS(NAME, 1)
+
+#define MU_BENCHMARK_ITEMS(NAME, ITEMS) \
+	static void NAME(size_t iterations); \
+	static mu_benchmarks::BenchmarkRegistration STRING_JOIN2(benchmark_registration_, NAME)(#NAME, NAME, ITEMS); \
+	static void NAME(size_t iterations)
+
+namespace mu_benchmarks
+{
+	typedef void(*BenchmarkFunc)(size_t iterations);
+
+	struct BenchmarkRegistration
+	{
+		BenchmarkRegistration(const char* name, BenchmarkFunc func, size_t items_per_iteration);
+	};
+
+	// Excludes its lifetime from the timed run, for per iteration setup such as evicting caches
+	struct ScopedPauseTiming
+	{
+		ScopedPauseTiming();
+		~ScopedPauseTiming();
+	};
+
+	// Keep the compiler from optimizing away a computed result
+	void Consume(uint64_t value);
+
+	template<typename T>
+	void Consume(T* ptr) { Consume(reinterpret_cast<uintptr_t>(ptr)); }
+
+	// Make a value opaque to the optimizer so workloads can't be constant folded
+	template<typename T>
+	T Opaque(T value)
+	{
+		volatile T v = value;
+		return v;
+	}
+}
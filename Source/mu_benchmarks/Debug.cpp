@@ -0,0 +1,52 @@
+#include "Benchmark.h"
+#include "../mu/BinaryLog.h"
+
+#include <cstdio>
+
+// Cost of a dbg::Log call on the logging thread, shaped like a validation layer message.
+// Output is disabled so only the hand off is timed, the logger thread formats in the background
+//	and messages which don't fit in the thread's buffer are dropped.
+
+MU_BENCHMARK(LogMessage)
+{
+	using namespace mu_benchmarks;
+	mu::dbg::SetLogToStderr(false);
+	const char* message = Opaque("vkCreateGraphicsPipelines: pCreateInfos[0].pStages[1] uses an undeclared input");
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		mu::dbg::Log("Validation: ", message, " object ", i);
+	}
+	mu::dbg::FlushLog();
+}
+
+MU_BENCHMARK(LogMessageFlushed)
+{
+	// Flushing every 256 messages keeps the buffer from filling, so this includes the formatting
+	using namespace mu_benchmarks;
+	mu::dbg::SetLogToStderr(false);
+	const char* message = Opaque("vkCreateGraphicsPipelines: pCreateInfos[0].pStages[1] uses an undeclared input");
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		mu::dbg::Log("Validation: ", message, " object ", i);
+		if ((i & 255) == 255)
+		{
+			mu::dbg::FlushLog();
+		}
+	}
+	mu::dbg::FlushLog();
+}
+
+MU_BENCHMARK(LogMessageBinary)
+{
+	// MU_LOG with a binary log open, the arguments are appended to the mapped file on this thread
+	using namespace mu_benchmarks;
+	const char* path = "mu_benchmarks_log.bin";
+	mu::dbg::OpenBinaryLog(path, 1024 * 1024 * 1024);
+	const void* object = Opaque((const void*)0x7f001234);
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		MU_LOG("Validation: pipeline {} stage {} object {}", object, 1u, i);
+	}
+	mu::dbg::CloseBinaryLog();
+	remove(path);
+}
@@ -0,0 +1,202 @@
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+
+#include "Benchmark.h"
+#include "../mu/Array.h"
+#include "../mu/HashTable.h"
+
+// HashMap against std::unordered_map with 64 bit keys and values, from cache resident
+//	to main memory sized tables, plus the device extension matching done in Main.cpp.
+
+namespace mu_benchmarks
+{
+	using namespace mu;
+
+	typedef HashMap<uint64_t, uint64_t> MuMap;
+	typedef std::unordered_map<uint64_t, uint64_t> StdMap;
+
+	static uint64_t MakeKey(size_t i) { return HashMix(i + 1); }
+
+	static void Insert(MuMap& map, uint64_t key, uint64_t value) { map.Add(key, value); }
+	static void Insert(StdMap& map, uint64_t key, uint64_t value) { map.emplace(key, value); }
+
+	static size_t Num(const MuMap& map) { return map.Num(); }
+	static size_t Num(const StdMap& map) { return map.size(); }
+
+	static const uint64_t* Lookup(const MuMap& map, uint64_t key) { return map.Find(key); }
+	static const uint64_t* Lookup(const StdMap& map, uint64_t key)
+	{
+		auto it = map.find(key);
+		return it == map.end() ? nullptr : &it->second;
+	}
+
+	static uint64_t SumValues(const MuMap& map)
+	{
+		uint64_t sum = 0;
+		for (std::tuple<const uint64_t&, const uint64_t&> kv : map)
+		{
+			sum += std::get<1>(kv);
+		}
+		return sum;
+	}
+
+	static uint64_t SumValues(const StdMap& map)
+	{
+		uint64_t sum = 0;
+		for (const auto& kv : map)
+		{
+			sum += kv.second;
+		}
+		return sum;
+	}
+
+	// Built once per map type and size by the untimed setup run
+	template<typename MAP, size_t N>
+	const MAP& Prebuilt()
+	{
+		static MAP map = []()
+		{
+			MAP m;
+			for (size_t i = 0; i < N; ++i)
+			{
+				Insert(m, MakeKey(i), i);
+			}
+			return m;
+		}();
+		return map;
+	}
+
+	template<typename MAP, size_t N>
+	void InsertN(size_t iterations)
+	{
+		for (size_t it = 0; it < iterations; ++it)
+		{
+			MAP map;
+			for (size_t i = 0; i < N; ++i)
+			{
+				Insert(map, MakeKey(i), i);
+			}
+			Consume(Num(map));
+		}
+	}
+
+	template<typename MAP, size_t N>
+	void LookupHitN(size_t iterations)
+	{
+		const MAP& map = Prebuilt<MAP, N>();
+		for (size_t it = 0; it < iterations; ++it)
+		{
+			uint64_t sum = 0;
+			for (size_t i = 0; i < N; ++i)
+			{
+				sum += *Lookup(map, MakeKey(i));
+			}
+			Consume(sum);
+		}
+	}
+
+	template<typename MAP, size_t N>
+	void LookupMissN(size_t iterations)
+	{
+		const MAP& map = Prebuilt<MAP, N>();
+		for (size_t it = 0; it < iterations; ++it)
+		{
+			size_t found = 0;
+			for (size_t i = N; i < 2 * N; ++i)
+			{
+				found += Lookup(map, MakeKey(i)) != nullptr;
+			}
+			Consume(found);
+		}
+	}
+
+	template<typename MAP, size_t N>
+	void IterateN(size_t iterations)
+	{
+		const MAP& map = Prebuilt<MAP, N>();
+		for (size_t it = 0; it < iterations; ++it)
+		{
+			Consume(SumValues(map));
+		}
+	}
+}
+
+#define MU_HASH_MAP_BENCHMARKS(SIZE_NAME, SIZE) \
+	MU_BENCHMARK_ITEMS(HashMapInsert_##SIZE_NAME, SIZE) { mu_benchmarks::InsertN<mu_benchmarks::MuMap, SIZE>(iterations); } \
+	MU_BENCHMARK_ITEMS(UnorderedMapInsert_##SIZE_NAME, SIZE) { mu_benchmarks::InsertN<mu_benchmarks::StdMap, SIZE>(iterations); } \
+	MU_BENCHMARK_ITEMS(HashMapLookupHit_##SIZE_NAME, SIZE) { mu_benchmarks::LookupHitN<mu_benchmarks::MuMap, SIZE>(iterations); } \
+	MU_BENCHMARK_ITEMS(UnorderedMapLookupHit_##SIZE_NAME, SIZE) { mu_benchmarks::LookupHitN<mu_benchmarks::StdMap, SIZE>(iterations); } \
+	MU_BENCHMARK_ITEMS(HashMapLookupMiss_##SIZE_NAME, SIZE) { mu_benchmarks::LookupMissN<mu_benchmarks::MuMap, SIZE>(iterations); } \
+	MU_BENCHMARK_ITEMS(UnorderedMapLookupMiss_##SIZE_NAME, SIZE) { mu_benchmarks::LookupMissN<mu_benchmarks::StdMap, SIZE>(iterations); } \
+	MU_BENCHMARK_ITEMS(HashMapIterate_##SIZE_NAME, SIZE) { mu_benchmarks::IterateN<mu_benchmarks::MuMap, SIZE>(iterations); } \
+	MU_BENCHMARK_ITEMS(UnorderedMapIterate_##SIZE_NAME, SIZE) { mu_benchmarks::IterateN<mu_benchmarks::StdMap, SIZE>(iterations); }
+
+MU_HASH_MAP_BENCHMARKS(1K, 1000)
+MU_HASH_MAP_BENCHMARKS(100K, 100000)
+MU_HASH_MAP_BENCHMARKS(1M, 1000000)
+MU_HASH_MAP_BENCHMARKS(10M, 10000000)
+
+namespace mu_benchmarks
+{
+	// Roughly the number of extensions a desktop driver reports
+	static const Array<Array<char>>& AvailableExtensionNames()
+	{
+		static Array<Array<char>> names = []()
+		{
+			Array<Array<char>> ns;
+			for (size_t i = 0; i < 150; ++i)
+			{
+				char name[64];
+				const int len = snprintf(name, sizeof(name), "VK_EXT_extension_number_%zu", i);
+				ns.Add(Array<char>{ mu::Range(name, size_t(len) + 1) });
+			}
+			return ns;
+		}();
+		return names;
+	}
+
+	static const char* RequiredExtensionNames[] = {
+		"VK_EXT_extension_number_149",
+		"VK_EXT_extension_number_75",
+		"VK_EXT_extension_number_3",
+	};
+}
+
+MU_BENCHMARK(ExtensionMatchLinear)
+{
+	using namespace mu_benchmarks;
+	const auto& available = AvailableExtensionNames();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		bool all_found = true;
+		for (const char* needed : RequiredExtensionNames)
+		{
+			auto f = mu::Find(mu::Range(available), [needed](const Array<char>& name) { return strcmp(name.Data(), needed) == 0; });
+			all_found = all_found && !f.IsEmpty();
+		}
+		Consume(all_found);
+	}
+}
+
+MU_BENCHMARK(ExtensionMatchHashSet)
+{
+	using namespace mu_benchmarks;
+	const auto& available = AvailableExtensionNames();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		HashSet<StringView> names;
+		names.Reserve(available.Num());
+		for (const Array<char>& name : available)
+		{
+			names.Add(name.Data());
+		}
+
+		bool all_found = true;
+		for (const char* needed : RequiredExtensionNames)
+		{
+			all_found = all_found && names.Contains(needed);
+		}
+		Consume(all_found);
+	}
+}
@@ -0,0 +1,76 @@
+#include "Benchmark.h"
+#include "../mu/Array.h"
+#include "../mu/InlineArray.h"
+
+// Small construction patterns from the Vulkan setup code in Main.cpp
+
+namespace mu_benchmarks
+{
+	// Stand-in for a non-trivial RAII handle such as vk::ImageView
+	struct Handle
+	{
+		static constexpr bool IsTriviallyRelocatable = true;
+
+		void* m_handle;
+
+		Handle(void* h) : m_handle(h) {}
+		Handle(Handle&& other) : m_handle(other.m_handle) { other.m_handle = nullptr; }
+		~Handle() { if (m_handle) { Consume(m_handle); } }
+	};
+
+	template<typename ARRAY>
+	void QueueFamilies(size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			auto families = ARRAY::MakeUnique(Opaque(0u), Opaque(1u));
+			Consume(families.Num());
+		}
+	}
+
+	template<typename ARRAY>
+	void LayerNames(size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			ARRAY layers = { "VK_LAYER_LUNARG_standard_validation" };
+			Consume(layers.Data());
+		}
+	}
+
+	template<typename ARRAY>
+	void InstanceExtensions(size_t iterations)
+	{
+		const char* required[] = { "VK_KHR_surface", "VK_KHR_win32_surface" };
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			ARRAY extensions;
+			extensions.AppendRaw(required, Opaque(size_t(2)));
+			extensions.Emplace("VK_EXT_debug_report");
+			Consume(extensions.Num());
+		}
+	}
+
+	template<typename ARRAY>
+	void SwapchainImageViews(size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			ARRAY views;
+			for (size_t image = 0, num = Opaque(size_t(3)); image < num; ++image)
+			{
+				views.Add(Handle{ reinterpret_cast<void*>(image + 1) });
+			}
+			Consume(views.Num());
+		}
+	}
+}
+
+MU_BENCHMARK(QueueFamilies_Array)				{ mu_benchmarks::QueueFamilies<Array<uint32_t>>(iterations); }
+MU_BENCHMARK(QueueFamilies_InlineArray)			{ mu_benchmarks::QueueFamilies<InlineArray<uint32_t, 2>>(iterations); }
+MU_BENCHMARK(LayerNames_Array)					{ mu_benchmarks::LayerNames<Array<const char*>>(iterations); }
+MU_BENCHMARK(LayerNames_InlineArray)			{ mu_benchmarks::LayerNames<InlineArray<const char*, 8>>(iterations); }
+MU_BENCHMARK(InstanceExtensions_Array)			{ mu_benchmarks::InstanceExtensions<Array<const char*>>(iterations); }
+MU_BENCHMARK(InstanceExtensions_InlineArray)	{ mu_benchmarks::InstanceExtensions<InlineArray<const char*, 8>>(iterations); }
+MU_BENCHMARK(SwapchainImageViews_Array)			{ mu_benchmarks::SwapchainImageViews<Array<mu_benchmarks::Handle>>(iterations); }
+MU_BENCHMARK(SwapchainImageViews_InlineArray)	{ mu_benchmarks::SwapchainImageViews<InlineArray<mu_benchmarks::Handle, 4>>(iterations); }
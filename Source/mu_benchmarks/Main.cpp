@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "Benchmark.h"
+#include "../mu/Array.h"
+
+namespace mu_benchmarks
+{
+	struct Benchmark
+	{
+		const char* m_name;
+		BenchmarkFunc m_func;
+		size_t m_items_per_iteration;
+	};
+
+	static Array<Benchmark>& GetBenchmarks()
+	{
+		static Array<Benchmark> benchmarks;
+		return benchmarks;
+	}
+
+	BenchmarkRegistration::BenchmarkRegistration(const char* name, BenchmarkFunc func, size_t items_per_iteration)
+	{
+		GetBenchmarks().Add(Benchmark{ name, func, items_per_iteration });
+	}
+
+	static volatile uint64_t s_sink = 0;
+
+	void Consume(uint64_t value)
+	{
+		s_sink = s_sink + value;
+	}
+
+	static double s_paused_seconds = 0.0;
+	static std::chrono::steady_clock::time_point s_pause_start;
+
+	ScopedPauseTiming::ScopedPauseTiming()
+	{
+		s_pause_start = std::chrono::steady_clock::now();
+	}
+
+	ScopedPauseTiming::~ScopedPauseTiming()
+	{
+		s_paused_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - s_pause_start).count();
+	}
+
+	static double RunSeconds(BenchmarkFunc func, size_t iterations)
+	{
+		s_paused_seconds = 0.0;
+		auto start = std::chrono::steady_clock::now();
+		func(iterations);
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(end - start).count() - s_paused_seconds;
+	}
+}
+
+// Usage: mu_benchmarks [name filter]
+int main(int argc, char** argv)
+{
+	using namespace mu_benchmarks;
+
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+	const double target_seconds = 0.25;
+
+	printf("%-48s %14s %14s\n", "Benchmark", "Iterations", "ns/item");
+	for (const Benchmark& benchmark : GetBenchmarks())
+	{
+		if (filter && !strstr(benchmark.m_name, filter))
+		{
+			continue;
+		}
+
+		// Untimed setup run
+		benchmark.m_func(0);
+
+		// Grow the iteration count until the run is long enough to time reliably
+		size_t iterations = 1;
+		double seconds = RunSeconds(benchmark.m_func, iterations);
+		while (seconds < target_seconds && iterations < (size_t(1) << 40))
+		{
+			const double scale = seconds > 0.0 ? target_seconds / seconds : 100.0;
+			iterations = size_t(double(iterations) * (scale > 100.0 ? 100.0 : scale + 0.5)) + 1;
+			seconds = RunSeconds(benchmark.m_func, iterations);
+		}
+
+		const double items = double(iterations) * double(benchmark.m_items_per_iteration);
+		printf("%-48s %14zu %14.2f\n", benchmark.m_name, iterations, seconds * 1e9 / items);
+	}
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include "Benchmark.h"
+#include "../mu/Array.h"
+#include "../mu/ParallelAlgorithms.h"
+
+// Single threaded algorithms against their parallel versions over a buffer the size of
+//	a large file loaded with LoadFileToArray
+
+namespace mu_benchmarks
+{
+	static const size_t BufferSize = 256 * 1024 * 1024;
+
+	static Array<uint8_t>& Buffer()
+	{
+		static Array<uint8_t> buffer = []()
+		{
+			auto b = Array<uint8_t>::MakeUninitialized(BufferSize);
+			mu::Fill(mu::Range(b), uint8_t(1));
+			return b;
+		}();
+		return buffer;
+	}
+}
+
+MU_BENCHMARK_ITEMS(SumBytes, mu_benchmarks::BufferSize)
+{
+	using namespace mu_benchmarks;
+	auto& buffer = Buffer();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		uint64_t sum = 0;
+		mu::Map(mu::Range(buffer), [&sum](uint8_t b) { sum += b; });
+		Consume(sum);
+	}
+}
+
+MU_BENCHMARK_ITEMS(ParallelSumBytes, mu_benchmarks::BufferSize)
+{
+	using namespace mu_benchmarks;
+	auto& buffer = Buffer();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		Consume(mu::ParallelReduce(mu::Range(buffer), uint64_t(0), [](uint64_t a, uint64_t b) { return a + b; }));
+	}
+}
+
+MU_BENCHMARK_ITEMS(FillBytes, mu_benchmarks::BufferSize)
+{
+	using namespace mu_benchmarks;
+	auto& buffer = Buffer();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		mu::Fill(mu::Range(buffer), uint8_t(1));
+		Consume(buffer.Data());
+	}
+}
+
+MU_BENCHMARK_ITEMS(ParallelFillBytes, mu_benchmarks::BufferSize)
+{
+	using namespace mu_benchmarks;
+	auto& buffer = Buffer();
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		mu::ParallelFill(mu::Range(buffer), uint8_t(1));
+		Consume(buffer.Data());
+	}
+}
+
+MU_BENCHMARK_ITEMS(FindByte, mu_benchmarks::BufferSize)
+{
+	using namespace mu_benchmarks;
+	auto& buffer = Buffer();
+	const uint8_t needle = Opaque(uint8_t(2));
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		Consume(mu::Find(mu::Range(buffer), [needle](uint8_t b) { return b == needle; }).Size());
+	}
+}
+
+MU_BENCHMARK_ITEMS(ParallelFindByte, mu_benchmarks::BufferSize)
+{
+	using namespace mu_benchmarks;
+	auto& buffer = Buffer();
+	const uint8_t needle = Opaque(uint8_t(2));
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		Consume(mu::ParallelFind(mu::Range(buffer), [needle](uint8_t b) { return b == needle; }).Size());
+	}
+}
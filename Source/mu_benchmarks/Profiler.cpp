@@ -0,0 +1,41 @@
+#include "Benchmark.h"
+#include "../mu/Profiler.h"
+
+// Cost of an empty profile zone, which should stay in the tens of nanoseconds to leave zones
+//	in release builds. EndFrame runs every 1024 zones so the thread's buffer never fills.
+
+MU_BENCHMARK(ProfileZone)
+{
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		MU_PROFILE_ZONE("Zone");
+		if ((i & 1023) == 1023)
+		{
+			mu_benchmarks::ScopedPauseTiming pause;
+			mu::prof::EndFrame();
+		}
+	}
+	mu::prof::EndFrame();
+}
+
+MU_BENCHMARK_ITEMS(ProfileEndFrame, 1024)
+{
+	// Gathering and building the call tree for 1024 nested zones
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		for (size_t j = 0; j < 256; ++j)
+		{
+			MU_PROFILE_ZONE("Outer");
+			{
+				MU_PROFILE_ZONE("Middle");
+				{
+					MU_PROFILE_ZONE("Inner");
+				}
+				{
+					MU_PROFILE_ZONE("Inner2");
+				}
+			}
+		}
+		mu::prof::EndFrame();
+	}
+}
@@ -148,6 +148,39 @@ namespace mu_core_tests_algorithms
 			Assert::AreEqual(10, MoveCount);
 			Assert::AreEqual(0, DestructCount);
 		}
+
+		TEST_METHOD(RelocateConstructPrimitive)
+		{
+			int from[] = { 0,1,2,3,4,5,6,7,8,9 };
+			int to[10] = {};
+
+			auto dest = RelocateConstruct(to, from);
+			Assert::IsTrue(dest.IsEmpty(), nullptr, LINE_INFO());
+			for (size_t i = 0; i < 10; ++i)
+			{
+				Assert::AreEqual(from[i], to[i], nullptr, LINE_INFO());
+			}
+		}
+
+		TEST_METHOD(RelocateConstructObject)
+		{
+			alignas(Element) uint8_t from_storage[sizeof(Element) * 10];
+			alignas(Element) uint8_t to_storage[sizeof(Element) * 10];
+			auto from = Range(reinterpret_cast<Element*>(from_storage), 10);
+			auto to = Range(reinterpret_cast<Element*>(to_storage), 10);
+			FillConstruct(from, 7);
+			Assert::AreEqual(10, ConstructCount);
+
+			RelocateConstruct(to, from);
+			Assert::AreEqual(10, ConstructCount);
+			Assert::AreEqual(10, MoveCount);
+			Assert::AreEqual(10, DestructCount);
+			for (const Element& e : to)
+			{
+				Assert::AreEqual(7, e.data);
+			}
+			Map(to, [](Element& e) { e.~Element(); });
+		}
 	};
 
 	int MoveTests::ConstructCount;
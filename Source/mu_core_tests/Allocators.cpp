@@ -0,0 +1,137 @@
+#include "CppUnitTest.h"
+#include "../mu/Allocators.h"
+#include "../mu/Array.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_allocators
+{
+	using namespace mu;
+
+	TEST_CLASS(LinearArenaTests)
+	{
+	public:
+		TEST_METHOD(AllocateAligned)
+		{
+			LinearArena arena{ 1024 };
+			void* a = arena.Allocate(3, 1);
+			void* b = arena.Allocate(8, 8);
+			Assert::IsNotNull(a, nullptr, LINE_INFO());
+			Assert::AreEqual(uintptr_t(0), reinterpret_cast<uintptr_t>(b) % 8, nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(2), arena.GetStats().m_num_allocations, nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(11), arena.GetStats().m_bytes_in_use, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(FreeLastAllocationReclaims)
+		{
+			LinearArena arena{ 1024 };
+			void* a = arena.Allocate(16, 8);
+			void* b = arena.Allocate(32, 8);
+			arena.Free(b, 32);
+			Assert::AreEqual(size_t(16), arena.Used(), nullptr, LINE_INFO());
+			arena.Free(a, 16);
+			Assert::AreEqual(size_t(0), arena.Used(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(2), arena.GetStats().m_num_frees, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ReallocateInPlace)
+		{
+			LinearArena arena{ 1024 };
+			void* a = arena.Allocate(16, 8);
+			void* b = arena.Reallocate(a, 16, 64, 8);
+			Assert::IsTrue(a == b, nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(64), arena.Used(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ExhaustedThrows)
+		{
+			LinearArena arena{ 64 };
+			arena.Allocate(60, 1);
+			bool thrown = false;
+			try
+			{
+				arena.Allocate(8, 1);
+			}
+			catch (const std::bad_alloc&)
+			{
+				thrown = true;
+			}
+			Assert::IsTrue(thrown, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ArrayInArena)
+		{
+			const size_t heap_allocations = HeapAllocator().GetStats().m_num_allocations;
+			LinearArena arena{ 4096 };
+			{
+				Array<int, AllocatorRef<LinearArena>> arr{ arena };
+				for (int i = 0; i < 100; ++i)
+				{
+					arr.Add(i);
+				}
+				Assert::AreEqual(size_t(100), arr.Num(), nullptr, LINE_INFO());
+				Assert::AreEqual(99, arr[99], nullptr, LINE_INFO());
+			}
+			Assert::AreEqual(size_t(0), arena.Used(), nullptr, LINE_INFO());
+			// Only the arena's own block came from the heap
+			Assert::AreEqual(heap_allocations + 1, HeapAllocator().GetStats().m_num_allocations, nullptr, LINE_INFO());
+		}
+	};
+
+	TEST_CLASS(FrameArenaTests)
+	{
+	public:
+		TEST_METHOD(BeginFrameResets)
+		{
+			FrameArena arena{ 1024 };
+			arena.BeginFrame();
+			arena.Allocate(100, 4);
+			arena.Allocate(100, 4);
+			Assert::AreEqual(size_t(2), arena.NumFrameAllocations(), nullptr, LINE_INFO());
+
+			arena.BeginFrame();
+			Assert::AreEqual(size_t(0), arena.Used(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(0), arena.NumFrameAllocations(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(200), arena.PeakFrameUsed(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(2), arena.GetStats().m_num_allocations, nullptr, LINE_INFO());
+		}
+	};
+
+	TEST_CLASS(PoolAllocatorTests)
+	{
+	public:
+		TEST_METHOD(AllocateAndFree)
+		{
+			PoolAllocator pool{ 24, 4 };
+			Assert::AreEqual(size_t(4), pool.NumFreeBlocks(), nullptr, LINE_INFO());
+
+			void* blocks[4];
+			for (void*& block : blocks)
+			{
+				block = pool.Allocate(24, 8);
+			}
+			Assert::AreEqual(size_t(0), pool.NumFreeBlocks(), nullptr, LINE_INFO());
+			Assert::IsTrue(blocks[0] != blocks[1], nullptr, LINE_INFO());
+
+			pool.Free(blocks[2], 24);
+			Assert::IsTrue(blocks[2] == pool.Allocate(16, 8), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(5), pool.GetStats().m_num_allocations, nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(1), pool.GetStats().m_num_frees, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(OversizedThrows)
+		{
+			PoolAllocator pool{ 16, 1 };
+			bool thrown = false;
+			try
+			{
+				pool.Allocate(pool.BlockSize() + 1, 8);
+			}
+			catch (const std::bad_alloc&)
+			{
+				thrown = true;
+			}
+			Assert::IsTrue(thrown, nullptr, LINE_INFO());
+		}
+	};
+}
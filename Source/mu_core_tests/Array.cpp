@@ -54,6 +54,15 @@ namespace mu_core_tests_array
 		}
 	};
 
+	struct RelocatableElement : Element
+	{
+		static constexpr bool IsTriviallyRelocatable = true;
+
+		RelocatableElement(int32_t d) : Element(d)
+		{
+		}
+	};
+
 	TEST_CLASS(ArrayTests)
 	{
 	public:
@@ -113,5 +122,62 @@ namespace mu_core_tests_array
 
 			Assert::AreEqual(3, DestructCount, nullptr, LINE_INFO());
 		}
+
+		TEST_METHOD(TestGrowRelocatesElements)
+		{
+			{
+				Array<Element> arr;
+				arr.Reserve(2);
+				arr.Emplace(1);
+				arr.Emplace(2);
+
+				ResetCounts();
+				arr.Reserve(10);
+				Assert::AreEqual(0, CopyCount, nullptr, LINE_INFO());
+				Assert::AreEqual(2, MoveCount, nullptr, LINE_INFO());
+				Assert::AreEqual(2, DestructCount, nullptr, LINE_INFO());
+				Assert::AreEqual((size_t)10, arr.Max(), nullptr, LINE_INFO());
+				Assert::AreEqual(1, arr[0].data, nullptr, LINE_INFO());
+				Assert::AreEqual(2, arr[1].data, nullptr, LINE_INFO());
+			}
+			Assert::AreEqual(4, DestructCount, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(TestGrowTriviallyRelocatable)
+		{
+			Assert::IsTrue(mu::meta::IsTriviallyRelocatable<int32_t>::value, nullptr, LINE_INFO());
+			Assert::IsFalse(mu::meta::IsTriviallyRelocatable<Element>::value, nullptr, LINE_INFO());
+			Assert::IsTrue(mu::meta::IsTriviallyRelocatable<RelocatableElement>::value, nullptr, LINE_INFO());
+			{
+				Array<RelocatableElement> arr;
+				arr.Reserve(2);
+				arr.Emplace(1);
+				arr.Emplace(2);
+
+				ResetCounts();
+				arr.Reserve(10);
+				Assert::AreEqual(0, CopyCount, nullptr, LINE_INFO());
+				Assert::AreEqual(0, MoveCount, nullptr, LINE_INFO());
+				Assert::AreEqual(0, DestructCount, nullptr, LINE_INFO());
+				Assert::AreEqual((size_t)10, arr.Max(), nullptr, LINE_INFO());
+				Assert::AreEqual(1, arr[0].data, nullptr, LINE_INFO());
+				Assert::AreEqual(2, arr[1].data, nullptr, LINE_INFO());
+			}
+			Assert::AreEqual(2, DestructCount, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(TestClearKeepsStorage)
+		{
+			Array<Element> arr;
+			arr.Emplace(1);
+			arr.Emplace(2);
+			const size_t max = arr.Max();
+
+			ResetCounts();
+			arr.Clear();
+			Assert::AreEqual(2, DestructCount, nullptr, LINE_INFO());
+			Assert::AreEqual((size_t)0, arr.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(max, arr.Max(), nullptr, LINE_INFO());
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "CppUnitTest.h"
+#include "../mu/AsyncFileReader.h"
+#include "../mu/FileReader.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_async_file_reader
+{
+	static const int NumTestFiles = 40;
+
+	static std::string TestFilePath(int index)
+	{
+		return "mu_core_tests_async_" + std::to_string(index) + ".bin";
+	}
+
+	// File i holds i * 1000 bytes counting up from i
+	static void WriteTestFile(int index)
+	{
+		FILE* f = fopen(TestFilePath(index).c_str(), "wb");
+		for (int i = 0; i < index * 1000; ++i)
+		{
+			fputc((index + i) % 256, f);
+		}
+		fclose(f);
+	}
+
+	static void CheckContents(int index, const Array<uint8_t>& data)
+	{
+		Assert::AreEqual(size_t(index * 1000), data.Num(), nullptr, LINE_INFO());
+		for (int i = 0; i < index * 1000; ++i)
+		{
+			Assert::AreEqual(uint8_t((index + i) % 256), data[i], nullptr, LINE_INFO());
+		}
+	}
+
+	TEST_CLASS(AsyncFileReaderTests)
+	{
+	public:
+		TEST_METHOD_CLEANUP(MethodCleanup)
+		{
+			for (int i = 0; i < NumTestFiles; ++i)
+			{
+				remove(TestFilePath(i).c_str());
+			}
+		}
+
+		TEST_METHOD(ReadFutures)
+		{
+			for (int i = 0; i < NumTestFiles; ++i)
+			{
+				WriteTestFile(i);
+			}
+
+			// A small queue so most reads wait for a free slot
+			AsyncFileReader reader{ 4 };
+			std::future<Array<uint8_t>> files[NumTestFiles];
+			for (int i = 0; i < NumTestFiles; ++i)
+			{
+				files[i] = reader.Read(TestFilePath(i).c_str());
+			}
+			for (int i = 0; i < NumTestFiles; ++i)
+			{
+				CheckContents(i, files[i].get());
+			}
+		}
+
+		TEST_METHOD(ReadCallbacks)
+		{
+			for (int i = 0; i < NumTestFiles; ++i)
+			{
+				WriteTestFile(i);
+			}
+
+			std::atomic<size_t> total_bytes{ 0 };
+			std::atomic<int> num_errors{ 0 };
+			AsyncFileReader reader;
+			for (int i = 0; i < NumTestFiles; ++i)
+			{
+				reader.Read(TestFilePath(i).c_str(), [&](Array<uint8_t>&& data, const char* error)
+				{
+					total_bytes += data.Num();
+					num_errors += error ? 1 : 0;
+				});
+			}
+			reader.WaitIdle();
+			Assert::AreEqual(size_t(1000 * NumTestFiles * (NumTestFiles - 1) / 2), total_bytes.load(), nullptr, LINE_INFO());
+			Assert::AreEqual(0, num_errors.load(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(MissingFile)
+		{
+			AsyncFileReader reader;
+			std::future<Array<uint8_t>> missing = reader.Read("mu_core_tests_no_such_file.bin");
+			bool threw = false;
+			try
+			{
+				missing.get();
+			}
+			catch (const std::runtime_error&)
+			{
+				threw = true;
+			}
+			Assert::IsTrue(threw, nullptr, LINE_INFO());
+
+			threw = false;
+			try
+			{
+				LoadFileToArray("mu_core_tests_no_such_file.bin");
+			}
+			catch (const std::runtime_error&)
+			{
+				threw = true;
+			}
+			Assert::IsTrue(threw, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(DestructorFinishesReads)
+		{
+			WriteTestFile(5);
+			std::atomic<int> num_done{ 0 };
+			{
+				AsyncFileReader reader;
+				for (int i = 0; i < 100; ++i)
+				{
+					reader.Read(TestFilePath(5).c_str(), [&num_done](Array<uint8_t>&& data, const char*)
+					{
+						num_done += data.Num() == 5000 ? 1 : 0;
+					});
+				}
+			}
+			Assert::AreEqual(100, num_done.load(), nullptr, LINE_INFO());
+		}
+	};
+}
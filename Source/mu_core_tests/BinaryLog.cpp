@@ -0,0 +1,166 @@
+#include "CppUnitTest.h"
+#include "../mu/BinaryLog.h"
+#include "../mu/MappedFile.h"
+#include "../mu/Array.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_binary_log
+{
+	using namespace mu;
+
+	static const char* TestLogPath = "mu_core_tests_log.bin";
+	static const char* TestTextLogPath = "mu_core_tests_binary_text_log.txt";
+
+	static Array<dbg::DecodedLogMessage> DecodeTestLog()
+	{
+		Array<dbg::DecodedLogMessage> messages;
+		MappedFile file = MappedFile::Open(TestLogPath);
+		Assert::IsTrue(file.IsValidFile(), nullptr, LINE_INFO());
+		Assert::IsTrue(dbg::DecodeBinaryLog(file.GetRange(), [&](const dbg::DecodedLogMessage& message)
+		{
+			messages.Add(message);
+		}), nullptr, LINE_INFO());
+		return messages;
+	}
+
+	TEST_CLASS(BinaryLogTests)
+	{
+	public:
+		TEST_METHOD_CLEANUP(MethodCleanup)
+		{
+			dbg::CloseBinaryLog();
+			dbg::SetLogFile(nullptr);
+			dbg::SetLogToStderr(true);
+			remove(TestLogPath);
+			remove(TestTextLogPath);
+		}
+
+		TEST_METHOD(RoundTrip)
+		{
+			Assert::IsTrue(dbg::OpenBinaryLog(TestLogPath, 1024 * 1024), nullptr, LINE_INFO());
+			const uint32_t first_line = __LINE__ + 3;
+			for (int32_t i = 0; i < 3; ++i)
+			{
+				MU_LOG("Frame {} took {}ms", i, 16.5);
+			}
+			MU_LOG("Buffer {} bound to {}", "vertices", (const void*)0x1234);
+			dbg::CloseBinaryLog();
+
+			Array<dbg::DecodedLogMessage> messages = DecodeTestLog();
+			Assert::AreEqual(size_t(4), messages.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(std::string("Frame 0 took 16.5ms"), messages[0].m_text, nullptr, LINE_INFO());
+			Assert::AreEqual(std::string("Frame 2 took 16.5ms"), messages[2].m_text, nullptr, LINE_INFO());
+			Assert::AreEqual(std::string("Buffer vertices bound to 0x1234"), messages[3].m_text, nullptr, LINE_INFO());
+			Assert::AreEqual(first_line, messages[0].m_line, nullptr, LINE_INFO());
+			Assert::AreEqual(first_line + 2, messages[3].m_line, nullptr, LINE_INFO());
+			Assert::IsTrue(messages[0].m_file.find("BinaryLog.cpp") != std::string::npos, nullptr, LINE_INFO());
+			Assert::IsTrue(messages[0].m_seconds <= messages[3].m_seconds, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(SignedAndExtraArgs)
+		{
+			Assert::IsTrue(dbg::OpenBinaryLog(TestLogPath, 1024 * 1024), nullptr, LINE_INFO());
+			MU_LOG("Offset {}", int64_t(-5), " extra ", 7u);
+			dbg::CloseBinaryLog();
+
+			Array<dbg::DecodedLogMessage> messages = DecodeTestLog();
+			Assert::AreEqual(size_t(1), messages.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(std::string("Offset -5 extra 7"), messages[0].m_text, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ReopenWritesSitesAgain)
+		{
+			// A site written to an earlier log must be described again in the new one
+			for (int32_t pass = 0; pass < 2; ++pass)
+			{
+				Assert::IsTrue(dbg::OpenBinaryLog(TestLogPath, 1024 * 1024), nullptr, LINE_INFO());
+				MU_LOG("Pass {}", pass);
+				dbg::CloseBinaryLog();
+
+				Array<dbg::DecodedLogMessage> messages = DecodeTestLog();
+				Assert::AreEqual(size_t(1), messages.Num(), nullptr, LINE_INFO());
+				Assert::AreEqual(std::string("Pass ") + std::to_string(pass), messages[0].m_text, nullptr, LINE_INFO());
+			}
+		}
+
+		TEST_METHOD(DropsWhenFull)
+		{
+			Assert::IsTrue(dbg::OpenBinaryLog(TestLogPath, 4096), nullptr, LINE_INFO());
+			const size_t num_messages = 1000;
+			for (size_t i = 0; i < num_messages; ++i)
+			{
+				MU_LOG("Message {}", i);
+			}
+			const uint64_t dropped = dbg::GetNumDroppedBinaryLogs();
+			dbg::CloseBinaryLog();
+
+			Array<dbg::DecodedLogMessage> messages = DecodeTestLog();
+			Assert::IsTrue(dropped > 0, nullptr, LINE_INFO());
+			Assert::AreEqual(num_messages, size_t(messages.Num() + dropped), nullptr, LINE_INFO());
+			Assert::AreEqual(std::string("Message 0"), messages[0].m_text, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ManyThreads)
+		{
+			Assert::IsTrue(dbg::OpenBinaryLog(TestLogPath, 16 * 1024 * 1024), nullptr, LINE_INFO());
+			const size_t num_threads = 4;
+			const size_t num_messages = 2000;
+			std::thread threads[num_threads];
+			for (size_t t = 0; t < num_threads; ++t)
+			{
+				threads[t] = std::thread([t, num_messages]()
+				{
+					for (size_t i = 0; i < num_messages; ++i)
+					{
+						MU_LOG("Thread {} message {}", t, i);
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+			dbg::CloseBinaryLog();
+
+			size_t counts[num_threads] = {};
+			MappedFile file = MappedFile::Open(TestLogPath);
+			dbg::DecodeBinaryLog(file.GetRange(), [&](const dbg::DecodedLogMessage& message)
+			{
+				unsigned thread, index;
+				Assert::AreEqual(2, sscanf(message.m_text.c_str(), "Thread %u message %u", &thread, &index), nullptr, LINE_INFO());
+				++counts[thread];
+			});
+			for (size_t count : counts)
+			{
+				Assert::AreEqual(num_messages, count, nullptr, LINE_INFO());
+			}
+		}
+
+		TEST_METHOD(TextWithoutBinaryLog)
+		{
+			dbg::SetLogToStderr(false);
+			dbg::SetLogFile(TestTextLogPath);
+			MU_LOG("Loaded {} shaders", 3u);
+			dbg::FlushLog();
+			dbg::SetLogFile(nullptr);
+
+			char buffer[64] = {};
+			FILE* f = fopen(TestTextLogPath, "rb");
+			Assert::IsNotNull(f, nullptr, LINE_INFO());
+			fread(buffer, 1, sizeof(buffer) - 1, f);
+			fclose(f);
+			Assert::AreEqual(std::string("Loaded 3 shaders\n"), std::string(buffer), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(RejectsOtherFiles)
+		{
+			const char text[] = "Not a binary log at all, just some text";
+			Assert::IsFalse(dbg::DecodeBinaryLog(Range((const uint8_t*)text, sizeof(text)), [](const dbg::DecodedLogMessage&) {}), nullptr, LINE_INFO());
+		}
+	};
+}
@@ -0,0 +1,105 @@
+#include "CppUnitTest.h"
+#include "../mu/Debug.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_debug
+{
+	using namespace mu;
+
+	static const char* TestLogPath = "mu_core_tests_log.txt";
+
+	static std::string ReadLogFile()
+	{
+		std::string contents;
+		FILE* f = fopen(TestLogPath, "rb");
+		if (!f) { return contents; }
+		char buffer[4096];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		{
+			contents.append(buffer, read);
+		}
+		fclose(f);
+		return contents;
+	}
+
+	static size_t CountOccurrences(const std::string& text, const char* pattern)
+	{
+		size_t count = 0;
+		for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+		{
+			++count;
+		}
+		return count;
+	}
+
+	TEST_CLASS(LogTests)
+	{
+	public:
+		TEST_METHOD_INITIALIZE(MethodInitialize)
+		{
+			remove(TestLogPath);
+			dbg::SetLogToStderr(false);
+			dbg::SetLogFile(TestLogPath);
+		}
+
+		TEST_METHOD_CLEANUP(MethodCleanup)
+		{
+			dbg::SetLogFile(nullptr);
+			dbg::SetLogToStderr(true);
+			remove(TestLogPath);
+		}
+
+		TEST_METHOD(FormatArgs)
+		{
+			dbg::Log("Value ", 42u, ", size ", size_t(7));
+			dbg::FlushLog();
+			Assert::AreEqual(std::string("Value 42, size 7\n"), ReadLogFile(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(CopiesStrings)
+		{
+			// The caller's string can change before the logger thread formats it
+			char message[] = "first";
+			dbg::Log(message);
+			strcpy(message, "later");
+			dbg::FlushLog();
+			Assert::AreEqual(std::string("first\n"), ReadLogFile(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ManyThreads)
+		{
+			const uint64_t dropped_before = dbg::GetNumDroppedLogs();
+			const size_t num_threads = 4;
+			const size_t num_messages = 2000;
+			std::thread threads[num_threads];
+			for (size_t t = 0; t < num_threads; ++t)
+			{
+				threads[t] = std::thread([t, num_messages]()
+				{
+					for (size_t i = 0; i < num_messages; ++i)
+					{
+						dbg::Log("Thread ", t, " message ", i);
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+			{
+				thread.join();
+			}
+			dbg::FlushLog();
+
+			// Every message is either written or counted as dropped
+			const uint64_t dropped = dbg::GetNumDroppedLogs() - dropped_before;
+			const std::string log = ReadLogFile();
+			Assert::AreEqual(num_threads * num_messages, size_t(CountOccurrences(log, " message ") + dropped), nullptr, LINE_INFO());
+			Assert::IsTrue(log.find("Thread 0 message 0\n") != std::string::npos || dropped > 0, nullptr, LINE_INFO());
+		}
+	};
+}
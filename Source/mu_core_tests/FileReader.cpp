@@ -0,0 +1,59 @@
+#include "CppUnitTest.h"
+#include "../mu/FileReader.h"
+
+#include <cstdio>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_file_reader
+{
+	using namespace mu;
+
+	static const char* TestFilePath = "mu_core_tests_file_reader.bin";
+
+	static Array<uint8_t> MakeTestData(size_t size, uint8_t first)
+	{
+		auto data = Array<uint8_t>::MakeUninitialized(size);
+		for (size_t i = 0; i < size; ++i)
+		{
+			data[i] = uint8_t(first + i);
+		}
+		return std::move(data);
+	}
+
+	TEST_CLASS(FileReaderTests)
+	{
+	public:
+		TEST_METHOD_CLEANUP(MethodCleanup)
+		{
+			remove(TestFilePath);
+		}
+
+		TEST_METHOD(SaveFileAtomically)
+		{
+			const Array<uint8_t> data = MakeTestData(10000, 7);
+			::SaveFileAtomically(TestFilePath, Range(data));
+
+			const Array<uint8_t> loaded = LoadFileToArray(TestFilePath);
+			Assert::AreEqual(data.Num(), loaded.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(0, memcmp(data.Data(), loaded.Data(), data.Num()), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(SaveFileAtomicallyReplaces)
+		{
+			const Array<uint8_t> first = MakeTestData(10000, 1);
+			const Array<uint8_t> second = MakeTestData(100, 2);
+			::SaveFileAtomically(TestFilePath, Range(first));
+			::SaveFileAtomically(TestFilePath, Range(second));
+
+			const Array<uint8_t> loaded = LoadFileToArray(TestFilePath);
+			Assert::AreEqual(second.Num(), loaded.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(0, memcmp(second.Data(), loaded.Data(), second.Num()), nullptr, LINE_INFO());
+
+			// Nothing is left behind beside the file
+			FILE* temp = fopen((std::string(TestFilePath) + ".tmp").c_str(), "rb");
+			Assert::IsNull(temp, nullptr, LINE_INFO());
+		}
+	};
+}
@@ -0,0 +1,87 @@
+#include "CppUnitTest.h"
+#include "../mu/FileWatcher.h"
+#include "../mu/Array.h"
+
+#include <cstdio>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_file_watcher
+{
+	using namespace mu;
+
+	static const char* TestFilePath = "mu_core_tests_watched.txt";
+	static const char* TestRenamedPath = "mu_core_tests_watched_renamed.txt";
+
+	// Waits until name is reported, as other changes to the directory may be reported first
+	static bool WaitFor(FileWatcher& watcher, const char* name)
+	{
+		Array<std::string> names;
+		for (int i = 0; i < 20 && !names.Contains(name); ++i)
+		{
+			watcher.Wait(100, names);
+		}
+		return names.Contains(name);
+	}
+
+	TEST_CLASS(FileWatcherTests)
+	{
+	public:
+		TEST_METHOD_CLEANUP(MethodCleanup)
+		{
+			remove(TestFilePath);
+			remove(TestRenamedPath);
+		}
+
+		TEST_METHOD(NothingChanged)
+		{
+			FileWatcher watcher = FileWatcher::Open(".");
+			Assert::IsTrue(watcher.IsValid(), nullptr, LINE_INFO());
+			Array<std::string> names;
+			watcher.Wait(0, names);
+			Assert::IsFalse(names.Contains(TestFilePath), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(MissingDirectory)
+		{
+			FileWatcher watcher = FileWatcher::Open("mu_core_tests_no_such_directory");
+			Assert::IsFalse(watcher.IsValid(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ReportsWrite)
+		{
+			FileWatcher watcher = FileWatcher::Open(".");
+			Assert::IsTrue(watcher.IsValid(), nullptr, LINE_INFO());
+			FILE* f = fopen(TestFilePath, "wb");
+			fputs("changed", f);
+			fclose(f);
+			Assert::IsTrue(WaitFor(watcher, TestFilePath), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ReportsRename)
+		{
+			// Like an editor which saves to a temporary file and renames it over the original
+			FILE* f = fopen(TestFilePath, "wb");
+			fputs("changed", f);
+			fclose(f);
+			FileWatcher watcher = FileWatcher::Open(".");
+			Assert::IsTrue(watcher.IsValid(), nullptr, LINE_INFO());
+			rename(TestFilePath, TestRenamedPath);
+			Assert::IsTrue(WaitFor(watcher, TestRenamedPath), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(MovedWatcher)
+		{
+			FileWatcher watcher;
+			Assert::IsFalse(watcher.IsValid(), nullptr, LINE_INFO());
+			watcher = FileWatcher::Open(".");
+			FileWatcher moved = std::move(watcher);
+			Assert::IsFalse(watcher.IsValid(), nullptr, LINE_INFO());
+			Assert::IsTrue(moved.IsValid(), nullptr, LINE_INFO());
+			FILE* f = fopen(TestFilePath, "wb");
+			fclose(f);
+			Assert::IsTrue(WaitFor(moved, TestFilePath), nullptr, LINE_INFO());
+		}
+	};
+}
@@ -0,0 +1,243 @@
+#include "CppUnitTest.h"
+#include "../mu/HashTable.h"
+#include "../mu/Array.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_hash_table
+{
+	using namespace mu;
+
+	static int LiveCount = 0;
+
+	struct Element
+	{
+		int32_t data;
+
+		Element(int32_t d) : data(d) { ++LiveCount; }
+		Element(const Element& other) : data(other.data) { ++LiveCount; }
+		Element(Element&& other) : data(other.data) { ++LiveCount; }
+		~Element() { --LiveCount; }
+
+		Element& operator=(const Element& other) { data = other.data; return *this; }
+
+		bool operator==(const Element& other) const { return data == other.data; }
+	};
+
+	struct ElementHash
+	{
+		size_t operator()(const Element& e) const { return Hash<int32_t>()(e.data); }
+	};
+
+	// Sends every key to the same group and tag so probing and tombstones get exercised
+	struct CollidingHash
+	{
+		size_t operator()(uint32_t) const { return 0; }
+	};
+
+	TEST_CLASS(HashSetTests)
+	{
+	public:
+		TEST_METHOD(AddContains)
+		{
+			HashSet<uint32_t> set;
+			Assert::IsTrue(set.Add(1), nullptr, LINE_INFO());
+			Assert::IsTrue(set.Add(2), nullptr, LINE_INFO());
+			Assert::IsFalse(set.Add(1), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(2), set.Num(), nullptr, LINE_INFO());
+			Assert::IsTrue(set.Contains(1), nullptr, LINE_INFO());
+			Assert::IsTrue(set.Contains(2), nullptr, LINE_INFO());
+			Assert::IsFalse(set.Contains(3), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ManyElements)
+		{
+			HashSet<uint32_t> set;
+			for (uint32_t i = 0; i < 10000; ++i)
+			{
+				set.Add(i * 7);
+			}
+			Assert::AreEqual(size_t(10000), set.Num(), nullptr, LINE_INFO());
+			Assert::IsTrue(set.Num() <= set.Capacity() - set.Capacity() / 8, nullptr, LINE_INFO());
+			for (uint32_t i = 0; i < 10000; ++i)
+			{
+				Assert::IsTrue(set.Contains(i * 7), nullptr, LINE_INFO());
+				Assert::IsFalse(set.Contains(i * 7 + 1), nullptr, LINE_INFO());
+			}
+		}
+
+		TEST_METHOD(Remove)
+		{
+			HashSet<uint32_t> set{ 1, 2, 3 };
+			Assert::IsTrue(set.Remove(2), nullptr, LINE_INFO());
+			Assert::IsFalse(set.Remove(2), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(2), set.Num(), nullptr, LINE_INFO());
+			Assert::IsFalse(set.Contains(2), nullptr, LINE_INFO());
+			Assert::IsTrue(set.Contains(3), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(RemoveWithCollisions)
+		{
+			HashSet<uint32_t, CollidingHash> set;
+			for (uint32_t i = 0; i < 40; ++i)
+			{
+				set.Add(i);
+			}
+			for (uint32_t i = 0; i < 40; i += 2)
+			{
+				set.Remove(i);
+			}
+			for (uint32_t i = 0; i < 40; ++i)
+			{
+				Assert::AreEqual(i % 2 == 1, set.Contains(i), nullptr, LINE_INFO());
+			}
+
+			// Churn through tombstones without growing forever
+			const size_t capacity = set.Capacity();
+			for (uint32_t i = 100; i < 1000; ++i)
+			{
+				set.Add(i);
+				set.Remove(i);
+			}
+			Assert::AreEqual(capacity, set.Capacity(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(20), set.Num(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ElementLifetimes)
+		{
+			LiveCount = 0;
+			{
+				HashSet<Element, ElementHash> set;
+				for (int32_t i = 0; i < 100; ++i)
+				{
+					set.Add(Element{ i });
+				}
+				Assert::AreEqual(100, LiveCount, nullptr, LINE_INFO());
+				set.Remove(Element{ 5 });
+				Assert::AreEqual(99, LiveCount, nullptr, LINE_INFO());
+
+				HashSet<Element, ElementHash> copy{ set };
+				Assert::AreEqual(198, LiveCount, nullptr, LINE_INFO());
+				Assert::IsTrue(copy.Contains(Element{ 99 }), nullptr, LINE_INFO());
+
+				HashSet<Element, ElementHash> moved{ std::move(copy) };
+				Assert::AreEqual(198, LiveCount, nullptr, LINE_INFO());
+				Assert::AreEqual(size_t(0), copy.Num(), nullptr, LINE_INFO());
+
+				moved.Clear();
+				Assert::AreEqual(99, LiveCount, nullptr, LINE_INFO());
+			}
+			Assert::AreEqual(0, LiveCount, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Iterate)
+		{
+			HashSet<uint32_t> empty;
+			for (uint32_t v : empty)
+			{
+				Assert::Fail(nullptr, LINE_INFO());
+			}
+
+			Array<uint32_t> values{ 5, 10, 15, 20 };
+			HashSet<uint32_t> from_range{ Range(values) };
+			uint32_t sum = 0, count = 0;
+			for (uint32_t v : from_range)
+			{
+				sum += v;
+				++count;
+			}
+			Assert::AreEqual(4u, count, nullptr, LINE_INFO());
+			Assert::AreEqual(50u, sum, nullptr, LINE_INFO());
+
+			Array<uint32_t> copied{ Range(from_range) };
+			Assert::AreEqual(size_t(4), copied.Num(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(StringViews)
+		{
+			const char* names[] = { "VK_KHR_swapchain", "VK_KHR_surface", "VK_EXT_debug_report" };
+			HashSet<StringView> set{ Range(names) };
+
+			char buffer[] = "VK_KHR_swapchain";
+			Assert::IsTrue(set.Contains(buffer), nullptr, LINE_INFO());
+			Assert::IsTrue(set.Contains(StringView{ "VK_KHR_surface_extra", 14 }), nullptr, LINE_INFO());
+			Assert::IsFalse(set.Contains("VK_KHR_surfac"), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(UsesAllocator)
+		{
+			LinearArena arena{ 64 * 1024 };
+			{
+				HashSet<uint32_t, Hash<uint32_t>, std::equal_to<uint32_t>, AllocatorRef<LinearArena>> set{ arena };
+				for (uint32_t i = 0; i < 100; ++i)
+				{
+					set.Add(i);
+				}
+				Assert::IsTrue(arena.GetStats().m_num_allocations > 0, nullptr, LINE_INFO());
+			}
+			Assert::AreEqual(size_t(0), arena.GetStats().m_bytes_in_use, nullptr, LINE_INFO());
+		}
+	};
+
+	TEST_CLASS(HashMapTests)
+	{
+	public:
+		TEST_METHOD(AddFind)
+		{
+			HashMap<uint32_t, Element> map;
+			map.Add(1, Element{ 10 });
+			map.Add(2, Element{ 20 });
+			Assert::AreEqual(10, map.Find(1)->data, nullptr, LINE_INFO());
+			Assert::AreEqual(20, map.Find(2)->data, nullptr, LINE_INFO());
+			Assert::IsNull(map.Find(3), nullptr, LINE_INFO());
+
+			map.Add(1, Element{ 11 });
+			Assert::AreEqual(size_t(2), map.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(11, map.Find(1)->data, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(FindOrAdd)
+		{
+			HashMap<StringView, uint32_t> counts;
+			const char* words[] = { "a", "b", "a", "c", "a", "b" };
+			for (const char* word : words)
+			{
+				++counts.FindOrAdd(word, 0u);
+			}
+			Assert::AreEqual(size_t(3), counts.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(3u, *counts.Find("a"), nullptr, LINE_INFO());
+			Assert::AreEqual(2u, *counts.Find("b"), nullptr, LINE_INFO());
+			Assert::AreEqual(1u, *counts.Find("c"), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Iterate)
+		{
+			HashMap<uint32_t, uint32_t> map;
+			for (uint32_t i = 0; i < 50; ++i)
+			{
+				map.Add(i, i * 2);
+			}
+			for (std::tuple<const uint32_t&, uint32_t&> kv : map)
+			{
+				std::get<1>(kv) += std::get<0>(kv);
+			}
+			uint32_t count = 0;
+			for (std::tuple<const uint32_t&, const uint32_t&> kv : Range(static_cast<const HashMap<uint32_t, uint32_t>&>(map)))
+			{
+				Assert::AreEqual(std::get<0>(kv) * 3, std::get<1>(kv), nullptr, LINE_INFO());
+				++count;
+			}
+			Assert::AreEqual(50u, count, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Remove)
+		{
+			HashMap<uint32_t, uint32_t> map;
+			map.Add(1, 1u);
+			map.Add(2, 2u);
+			Assert::IsTrue(map.Remove(1), nullptr, LINE_INFO());
+			Assert::IsFalse(map.Contains(1), nullptr, LINE_INFO());
+			Assert::IsTrue(map.Contains(2), nullptr, LINE_INFO());
+		}
+	};
+}
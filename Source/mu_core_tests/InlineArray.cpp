@@ -0,0 +1,148 @@
+#include "CppUnitTest.h"
+#include "../mu/InlineArray.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_inline_array
+{
+	using namespace mu;
+
+	static int ConstructCount = 0;
+	static int DestructCount = 0;
+	static int MoveCount = 0;
+
+	static void ResetCounts()
+	{
+		ConstructCount = 0;
+		DestructCount = 0;
+		MoveCount = 0;
+	}
+
+	struct Element
+	{
+		int32_t data;
+
+		Element(int32_t d) : data(d)
+		{
+			++ConstructCount;
+		}
+		Element(const Element& other) : data(other.data)
+		{
+			++ConstructCount;
+		}
+		Element(Element&& other) : data(other.data)
+		{
+			++MoveCount;
+		}
+		~Element()
+		{
+			++DestructCount;
+		}
+	};
+
+	TEST_CLASS(InlineArrayTests)
+	{
+	public:
+		TEST_METHOD_INITIALIZE(MethodInit)
+		{
+			ResetCounts();
+		}
+
+		TEST_METHOD(StaysInline)
+		{
+			const size_t heap_allocations = HeapAllocator().GetStats().m_num_allocations;
+			{
+				InlineArray<uint32_t, 4> arr{ 1, 2, 3 };
+				arr.Add(4);
+				Assert::IsTrue(arr.IsInline(), nullptr, LINE_INFO());
+				Assert::AreEqual(size_t(4), arr.Num(), nullptr, LINE_INFO());
+				Assert::AreEqual(size_t(4), arr.Max(), nullptr, LINE_INFO());
+				Assert::AreEqual(4u, arr[3], nullptr, LINE_INFO());
+			}
+			Assert::AreEqual(heap_allocations, HeapAllocator().GetStats().m_num_allocations, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Spills)
+		{
+			InlineArray<uint32_t, 2> arr;
+			for (uint32_t i = 0; i < 10; ++i)
+			{
+				arr.Add(i);
+			}
+			Assert::IsFalse(arr.IsInline(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(10), arr.Num(), nullptr, LINE_INFO());
+			for (uint32_t i = 0; i < 10; ++i)
+			{
+				Assert::AreEqual(i, arr[i], nullptr, LINE_INFO());
+			}
+		}
+
+		TEST_METHOD(SpillRelocatesObjects)
+		{
+			{
+				InlineArray<Element, 2> arr;
+				arr.Emplace(1);
+				arr.Emplace(2);
+				ResetCounts();
+
+				arr.Emplace(3);
+				Assert::IsFalse(arr.IsInline(), nullptr, LINE_INFO());
+				Assert::AreEqual(1, ConstructCount, nullptr, LINE_INFO());
+				Assert::AreEqual(3, MoveCount, nullptr, LINE_INFO()); // two relocated, one added
+				Assert::AreEqual(3, DestructCount, nullptr, LINE_INFO());
+				Assert::AreEqual(1, arr[0].data, nullptr, LINE_INFO());
+				Assert::AreEqual(3, arr[2].data, nullptr, LINE_INFO());
+			}
+			Assert::AreEqual(6, DestructCount, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(MoveInline)
+		{
+			InlineArray<Element, 4> a;
+			a.Emplace(7);
+			a.Emplace(8);
+			ResetCounts();
+
+			InlineArray<Element, 4> b{ std::move(a) };
+			Assert::IsTrue(b.IsInline(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(0), a.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(2), b.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(2, MoveCount, nullptr, LINE_INFO());
+			Assert::AreEqual(8, b[1].data, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(MoveHeap)
+		{
+			InlineArray<uint32_t, 1> a{ 1, 2, 3 };
+			const uint32_t* data = a.Data();
+
+			InlineArray<uint32_t, 1> b{ std::move(a) };
+			Assert::IsTrue(data == b.Data(), nullptr, LINE_INFO());
+			Assert::IsTrue(a.IsInline(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(0), a.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(3), b.Num(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(MakeUnique)
+		{
+			auto arr = InlineArray<uint32_t, 2>::MakeUnique(5u, 5u);
+			Assert::AreEqual(size_t(1), arr.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(5u, arr[0], nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Ranges)
+		{
+			InlineArray<int, 4> as{ 1, 2, 3 };
+			InlineArray<int, 4> bs{ Transform(Range(as), [](int a) { return a * 10; }) };
+			Assert::AreEqual(size_t(3), bs.Num(), nullptr, LINE_INFO());
+
+			int index = 0;
+			for (std::tuple<int&, int&> pair : Zip(Range(as), Range(bs)))
+			{
+				Assert::AreEqual(std::get<0>(pair) * 10, std::get<1>(pair), nullptr, LINE_INFO());
+				++index;
+			}
+			Assert::AreEqual(3, index, nullptr, LINE_INFO());
+		}
+	};
+}
@@ -0,0 +1,85 @@
+#include "CppUnitTest.h"
+#include "../mu/MappedFile.h"
+#include "../mu/Array.h"
+
+#include <cstdio>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_mapped_file
+{
+	using namespace mu;
+
+	static const char* TestFilePath = "mu_core_tests_mapped_file.bin";
+
+	static void WriteTestFile(size_t size)
+	{
+		FILE* f = fopen(TestFilePath, "wb");
+		for (size_t i = 0; i < size; ++i)
+		{
+			fputc(int(i % 251), f);
+		}
+		fclose(f);
+	}
+
+	TEST_CLASS(MappedFileTests)
+	{
+	public:
+		TEST_METHOD_CLEANUP(MethodCleanup)
+		{
+			remove(TestFilePath);
+		}
+
+		TEST_METHOD(MapContents)
+		{
+			const size_t size = 100000;
+			WriteTestFile(size);
+
+			MappedFile file = MappedFile::Open(TestFilePath, FileAccessHint::Sequential);
+			Assert::IsTrue(file.IsValidFile(), nullptr, LINE_INFO());
+			Assert::AreEqual(size, file.GetFileSize(), nullptr, LINE_INFO());
+
+			auto r = file.GetRange();
+			Assert::AreEqual(size, r.Size(), nullptr, LINE_INFO());
+			for (size_t i = 0; i < size; ++i)
+			{
+				Assert::AreEqual(uint8_t(i % 251), r[i], nullptr, LINE_INFO());
+			}
+
+			file.Advise(FileAccessHint::Random, 5000, 10000);
+			file.Advise(FileAccessHint::WillNeed);
+			Assert::AreEqual(uint8_t(5000 % 251), file.GetRange()[5000], nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(MissingFile)
+		{
+			MappedFile file = MappedFile::Open("mu_core_tests_no_such_file.bin");
+			Assert::IsFalse(file.IsValidFile(), nullptr, LINE_INFO());
+			Assert::IsTrue(file.GetRange().IsEmpty(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(EmptyFile)
+		{
+			WriteTestFile(0);
+			MappedFile file = MappedFile::Open(TestFilePath);
+			Assert::IsTrue(file.IsValidFile(), nullptr, LINE_INFO());
+			Assert::IsTrue(file.GetRange().IsEmpty(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Move)
+		{
+			WriteTestFile(16);
+			MappedFile a = MappedFile::Open(TestFilePath);
+			const uint8_t* data = a.GetRange().Data();
+
+			MappedFile b{ std::move(a) };
+			Assert::IsFalse(a.IsValidFile(), nullptr, LINE_INFO());
+			Assert::IsTrue(b.IsValidFile(), nullptr, LINE_INFO());
+			Assert::IsTrue(data == b.GetRange().Data(), nullptr, LINE_INFO());
+
+			Array<uint8_t> copy{ b.GetRange() };
+			Assert::AreEqual(size_t(16), copy.Num(), nullptr, LINE_INFO());
+			Assert::AreEqual(uint8_t(15), copy[15], nullptr, LINE_INFO());
+		}
+	};
+}
@@ -0,0 +1,120 @@
+#include "CppUnitTest.h"
+#include "../mu/ParallelAlgorithms.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_parallel_algorithms
+{
+	using namespace mu;
+
+	TEST_CLASS(ThreadPoolTests)
+	{
+	public:
+		TEST_METHOD(RunsAllTasks)
+		{
+			ThreadPool pool{ 4 };
+			TaskGroup group;
+			std::atomic<int> count{ 0 };
+			for (int i = 0; i < 1000; ++i)
+			{
+				pool.Run(group, [&count]() { ++count; });
+			}
+			pool.Wait(group);
+			Assert::IsTrue(group.IsDone(), nullptr, LINE_INFO());
+			Assert::AreEqual(1000, count.load(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(NestedTasks)
+		{
+			// Waiting inside a task runs other tasks instead of blocking a worker
+			ThreadPool pool{ 2 };
+			TaskGroup outer;
+			std::atomic<int> count{ 0 };
+			for (int i = 0; i < 8; ++i)
+			{
+				pool.Run(outer, [&pool, &count]()
+				{
+					TaskGroup inner;
+					for (int j = 0; j < 8; ++j)
+					{
+						pool.Run(inner, [&count]() { ++count; });
+					}
+					pool.Wait(inner);
+				});
+			}
+			pool.Wait(outer);
+			Assert::AreEqual(64, count.load(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(DestructorFinishesQueuedTasks)
+		{
+			std::atomic<int> count{ 0 };
+			TaskGroup group;
+			{
+				ThreadPool pool{ 1 };
+				for (int i = 0; i < 100; ++i)
+				{
+					pool.Run(group, [&count]() { ++count; });
+				}
+			}
+			Assert::AreEqual(100, count.load(), nullptr, LINE_INFO());
+		}
+	};
+
+	TEST_CLASS(ParallelAlgorithmTests)
+	{
+	public:
+		TEST_METHOD(Map)
+		{
+			ThreadPool pool{ 4 };
+			auto values = Array<uint32_t>::MakeUninitialized(100000);
+			ParallelMap(Zip(Range(values), Iota<uint32_t>()), [](std::tuple<uint32_t&, uint32_t> item)
+			{
+				std::get<0>(item) = std::get<1>(item) * 2;
+			}, pool);
+			for (uint32_t i = 0; i < 100000; ++i)
+			{
+				Assert::AreEqual(i * 2, values[i], nullptr, LINE_INFO());
+			}
+		}
+
+		TEST_METHOD(FindFirstMatch)
+		{
+			ThreadPool pool{ 4 };
+			auto values = Array<uint32_t>::MakeUninitialized(200000);
+			ParallelFill(Range(values), 0u, pool);
+			values[150000] = 1;
+			values[60000] = 1;
+			values[199999] = 1;
+
+			auto found = ParallelFind(Range(values), [](uint32_t v) { return v == 1; }, pool);
+			Assert::AreEqual(size_t(200000 - 60000), found.Size(), nullptr, LINE_INFO());
+
+			auto missing = ParallelFind(Range(values), [](uint32_t v) { return v == 2; }, pool);
+			Assert::IsTrue(missing.IsEmpty(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Reduce)
+		{
+			ThreadPool pool{ 4 };
+			auto bytes = Array<uint8_t>::MakeUninitialized(1000000);
+			ParallelFill(Range(bytes), uint8_t(3), pool);
+
+			const uint64_t sum = ParallelReduce(Range(bytes), uint64_t(0), [](uint64_t a, uint64_t b) { return a + b; }, pool);
+			Assert::AreEqual(uint64_t(3000000), sum, nullptr, LINE_INFO());
+
+			const uint64_t empty_sum = ParallelReduce(Range(bytes).Slice(0, 0), uint64_t(0), [](uint64_t a, uint64_t b) { return a + b; }, pool);
+			Assert::AreEqual(uint64_t(0), empty_sum, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(FillSmallRange)
+		{
+			int values[10] = {};
+			ParallelFill(Range(values), 7);
+			for (int v : values)
+			{
+				Assert::AreEqual(7, v, nullptr, LINE_INFO());
+			}
+		}
+	};
+}
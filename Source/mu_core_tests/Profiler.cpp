@@ -0,0 +1,189 @@
+#include "CppUnitTest.h"
+#include "../mu/Profiler.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_profiler
+{
+	using namespace mu;
+
+	static const char* TestTracePath = "mu_core_tests_trace.json";
+
+	static void Inner()
+	{
+		MU_PROFILE_ZONE("Inner");
+	}
+
+	static void Outer()
+	{
+		MU_PROFILE_ZONE("Outer");
+		for (int i = 0; i < 3; ++i)
+		{
+			Inner();
+		}
+	}
+
+	static const prof::ProfileNode* FindNode(const prof::ProfileFrame& frame, const char* name, uint32_t parent)
+	{
+		for (const prof::ProfileNode& node : frame.m_nodes)
+		{
+			if (strcmp(node.m_site->m_name, name) == 0 && node.m_parent == parent)
+			{
+				return &node;
+			}
+		}
+		return nullptr;
+	}
+
+	static size_t CountOccurrences(const std::string& text, const char* pattern)
+	{
+		size_t count = 0;
+		for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+		{
+			++count;
+		}
+		return count;
+	}
+
+	static std::string ReadTraceFile()
+	{
+		std::string trace;
+		FILE* f = fopen(TestTracePath, "rb");
+		if (!f) { return trace; }
+		char buffer[4096];
+		size_t read;
+		while ((read = fread(buffer, 1, sizeof(buffer), f)) > 0)
+		{
+			trace.append(buffer, read);
+		}
+		fclose(f);
+		return trace;
+	}
+
+	TEST_CLASS(ProfilerTests)
+	{
+	public:
+		TEST_METHOD_INITIALIZE(MethodInitialize)
+		{
+			// Start each test from an empty frame
+			prof::EndFrame();
+		}
+
+		TEST_METHOD_CLEANUP(MethodCleanup)
+		{
+			remove(TestTracePath);
+		}
+
+		TEST_METHOD(CallTree)
+		{
+			Outer();
+			Outer();
+			Inner();
+			prof::EndFrame();
+
+			const prof::ProfileFrame& frame = prof::GetLastFrame();
+			Assert::AreEqual(size_t(3), frame.m_nodes.Num(), nullptr, LINE_INFO());
+			const prof::ProfileNode* outer = FindNode(frame, "Outer", prof::NoParent);
+			Assert::IsNotNull(outer, nullptr, LINE_INFO());
+			Assert::AreEqual(2u, outer->m_num_calls, nullptr, LINE_INFO());
+
+			const prof::ProfileNode* inner = FindNode(frame, "Inner", uint32_t(outer - frame.m_nodes.Data()));
+			Assert::IsNotNull(inner, nullptr, LINE_INFO());
+			Assert::AreEqual(6u, inner->m_num_calls, nullptr, LINE_INFO());
+			Assert::IsTrue(inner->m_seconds <= outer->m_seconds, nullptr, LINE_INFO());
+
+			const prof::ProfileNode* top_inner = FindNode(frame, "Inner", prof::NoParent);
+			Assert::IsNotNull(top_inner, nullptr, LINE_INFO());
+			Assert::AreEqual(1u, top_inner->m_num_calls, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(FrameTime)
+		{
+			{
+				MU_PROFILE_ZONE("Sleep");
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			}
+			prof::EndFrame();
+
+			const prof::ProfileFrame& frame = prof::GetLastFrame();
+			Assert::AreEqual(size_t(1), frame.m_nodes.Num(), nullptr, LINE_INFO());
+			Assert::IsTrue(frame.m_nodes[0].m_seconds > 0.015 && frame.m_nodes[0].m_seconds < 1.0, nullptr, LINE_INFO());
+			Assert::IsTrue(frame.m_seconds >= frame.m_nodes[0].m_seconds, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Threads)
+		{
+			std::thread thread([]() { Outer(); });
+			thread.join();
+			Outer();
+			prof::EndFrame();
+
+			// Each thread gets its own tree
+			const prof::ProfileFrame& frame = prof::GetLastFrame();
+			Assert::AreEqual(size_t(4), frame.m_nodes.Num(), nullptr, LINE_INFO());
+			Assert::AreNotEqual(frame.m_nodes[0].m_thread, frame.m_nodes[3].m_thread, nullptr, LINE_INFO());
+			for (const prof::ProfileNode& node : frame.m_nodes)
+			{
+				Assert::AreEqual(strcmp(node.m_site->m_name, "Outer") == 0 ? 1u : 3u, node.m_num_calls, nullptr, LINE_INFO());
+			}
+		}
+
+		TEST_METHOD(NoHeapAllocations)
+		{
+			Outer();
+			prof::EndFrame();
+
+			const size_t allocations = HeapAllocator().GetStats().m_num_allocations;
+			for (int i = 0; i < 10; ++i)
+			{
+				Outer();
+				prof::EndFrame();
+			}
+			Assert::AreEqual(allocations, HeapAllocator().GetStats().m_num_allocations, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ChromeTrace)
+		{
+			prof::BeginCapture();
+			Outer();
+			prof::EndFrame();
+			Outer();
+			prof::EndFrame();
+			Assert::IsTrue(prof::EndCapture(TestTracePath), nullptr, LINE_INFO());
+			Assert::IsFalse(prof::IsCapturing(), nullptr, LINE_INFO());
+
+			const std::string trace = ReadTraceFile();
+			Assert::AreEqual(size_t(0), trace.find("{\"traceEvents\":["), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(2), CountOccurrences(trace, "\"name\":\"Outer\""), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(6), CountOccurrences(trace, "\"name\":\"Inner\""), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(Track)
+		{
+			static prof::ProfileTrack* track = prof::AddTrack("GPU");
+			static const prof::ZoneSite outer_site = { "GpuOuter", __FILE__, __LINE__ };
+			static const prof::ZoneSite inner_site = { "GpuInner", __FILE__, __LINE__ };
+			const uint64_t now = prof::GetTicks();
+			prof::AddTrackZone(track, inner_site, now + 10, now + 20);
+			prof::AddTrackZone(track, outer_site, now, now + 100);
+
+			prof::BeginCapture();
+			prof::EndFrame();
+			Assert::IsTrue(prof::EndCapture(TestTracePath), nullptr, LINE_INFO());
+
+			const prof::ProfileFrame& frame = prof::GetLastFrame();
+			const prof::ProfileNode* outer = FindNode(frame, "GpuOuter", prof::NoParent);
+			Assert::IsNotNull(outer, nullptr, LINE_INFO());
+			Assert::IsNotNull(FindNode(frame, "GpuInner", uint32_t(outer - frame.m_nodes.Data())), nullptr, LINE_INFO());
+			Assert::AreEqual(100.0 * prof::GetSecondsPerTick(), outer->m_seconds, 1e-9, nullptr, LINE_INFO());
+
+			const std::string trace = ReadTraceFile();
+			Assert::AreEqual(size_t(1), CountOccurrences(trace, "\"args\":{\"name\":\"GPU\"}"), nullptr, LINE_INFO());
+		}
+	};
+}
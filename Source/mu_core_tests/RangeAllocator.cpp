@@ -0,0 +1,136 @@
+#include "CppUnitTest.h"
+#include "../mu/RangeAllocator.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_range_allocator
+{
+	using namespace mu;
+
+	TEST_CLASS(RangeAllocatorTests)
+	{
+	public:
+		TEST_METHOD(AllocateAligned)
+		{
+			RangeAllocator allocator(4096);
+			const RangeAllocator::Allocation a = allocator.Allocate(10, 1);
+			const RangeAllocator::Allocation b = allocator.Allocate(100, 256);
+			const RangeAllocator::Allocation c = allocator.Allocate(3, 64);
+			Assert::AreNotEqual(RangeAllocator::InvalidRange, a.m_range, nullptr, LINE_INFO());
+			Assert::AreNotEqual(RangeAllocator::InvalidRange, b.m_range, nullptr, LINE_INFO());
+			Assert::AreNotEqual(RangeAllocator::InvalidRange, c.m_range, nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(0), b.m_offset % 256, nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(0), c.m_offset % 64, nullptr, LINE_INFO());
+			Assert::IsTrue(a.m_offset + 10 <= b.m_offset || b.m_offset + 100 <= a.m_offset, nullptr, LINE_INFO());
+			Assert::IsTrue(b.m_offset + 100 <= c.m_offset || c.m_offset + 3 <= b.m_offset, nullptr, LINE_INFO());
+			Assert::AreEqual(3u, allocator.GetNumAllocations(), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(4096 - 113), allocator.GetFreeBytes(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(AllocateWholeSpace)
+		{
+			// Alignment padding mustn't stop an exact fit
+			RangeAllocator allocator(1024);
+			const RangeAllocator::Allocation a = allocator.Allocate(1024, 256);
+			Assert::AreNotEqual(RangeAllocator::InvalidRange, a.m_range, nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(0), a.m_offset, nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(0), allocator.GetFreeBytes(), nullptr, LINE_INFO());
+			Assert::AreEqual(RangeAllocator::InvalidRange, allocator.Allocate(1, 1).m_range, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(AllocateFailsWhenFull)
+		{
+			RangeAllocator allocator(1000);
+			Assert::AreEqual(RangeAllocator::InvalidRange, allocator.Allocate(1001, 1).m_range, nullptr, LINE_INFO());
+			Assert::AreNotEqual(RangeAllocator::InvalidRange, allocator.Allocate(600, 1).m_range, nullptr, LINE_INFO());
+			Assert::AreEqual(RangeAllocator::InvalidRange, allocator.Allocate(600, 1).m_range, nullptr, LINE_INFO());
+			Assert::AreEqual(1u, allocator.GetNumAllocations(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(FreeMergesNeighbours)
+		{
+			RangeAllocator allocator(1024);
+			uint32_t ranges[8];
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				ranges[i] = allocator.Allocate(128, 128).m_range;
+				Assert::AreNotEqual(RangeAllocator::InvalidRange, ranges[i], nullptr, LINE_INFO());
+			}
+
+			// Every other range free leaves the space fragmented
+			for (uint32_t i = 0; i < 8; i += 2)
+			{
+				allocator.Free(ranges[i]);
+			}
+			Assert::AreEqual(uint64_t(512), allocator.GetFreeBytes(), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(128), allocator.GetLargestFreeRange(), nullptr, LINE_INFO());
+			Assert::AreEqual(RangeAllocator::InvalidRange, allocator.Allocate(256, 1).m_range, nullptr, LINE_INFO());
+
+			for (uint32_t i = 1; i < 8; i += 2)
+			{
+				allocator.Free(ranges[i]);
+			}
+			Assert::IsTrue(allocator.IsEmpty(), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(1024), allocator.GetLargestFreeRange(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(RandomAllocateAndFree)
+		{
+			struct Live
+			{
+				uint64_t m_offset;
+				uint64_t m_size;
+				uint32_t m_range;
+			};
+
+			const uint64_t size = 1 << 24;
+			RangeAllocator allocator(size);
+			std::vector<Live> live;
+			std::mt19937 rng(1234);
+			uint64_t used = 0;
+			for (uint32_t i = 0; i < 20000; ++i)
+			{
+				if (live.size() > 0 && rng() % 3 == 0)
+				{
+					const size_t index = rng() % live.size();
+					allocator.Free(live[index].m_range);
+					used -= live[index].m_size;
+					live[index] = live.back();
+					live.pop_back();
+				}
+				else
+				{
+					const uint64_t alloc_size = 1 + rng() % (1 << (rng() % 16));
+					const uint64_t alignment = uint64_t(1) << (rng() % 9);
+					const RangeAllocator::Allocation a = allocator.Allocate(alloc_size, alignment);
+					if (a.m_range != RangeAllocator::InvalidRange)
+					{
+						Assert::AreEqual(uint64_t(0), a.m_offset % alignment, nullptr, LINE_INFO());
+						Assert::IsTrue(a.m_offset + alloc_size <= size, nullptr, LINE_INFO());
+						live.push_back(Live{ a.m_offset, alloc_size, a.m_range });
+						used += alloc_size;
+					}
+				}
+				Assert::AreEqual(size - used, allocator.GetFreeBytes(), nullptr, LINE_INFO());
+			}
+
+			// No two live allocations overlap
+			std::sort(live.begin(), live.end(), [](const Live& a, const Live& b) { return a.m_offset < b.m_offset; });
+			for (size_t i = 1; i < live.size(); ++i)
+			{
+				Assert::IsTrue(live[i - 1].m_offset + live[i - 1].m_size <= live[i].m_offset, nullptr, LINE_INFO());
+			}
+
+			for (const Live& l : live)
+			{
+				allocator.Free(l.m_range);
+			}
+			Assert::IsTrue(allocator.IsEmpty(), nullptr, LINE_INFO());
+			Assert::AreEqual(size, allocator.GetLargestFreeRange(), nullptr, LINE_INFO());
+		}
+	};
+}
@@ -141,6 +141,52 @@ namespace mu_core_tests_ranges
 			Assert::IsTrue(std::is_same<std::tuple<int&, const int&>, decltype(r.Front())>::value);
 		}
 
+		TEST_METHOD(RandomAccess)
+		{
+			int arr[] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+			auto r = Range(arr);
+			Assert::IsTrue(ranges::IsRandomAccessRange<decltype(r)>::value, nullptr, LINE_INFO());
+			Assert::IsTrue(ranges::IsContiguousRange<decltype(r)>::value, nullptr, LINE_INFO());
+			Assert::AreEqual(5, r[5], nullptr, LINE_INFO());
+
+			auto s = r.Slice(2, 6);
+			Assert::AreEqual(size_t(4), s.Size(), nullptr, LINE_INFO());
+			Assert::AreEqual(2, s.Front(), nullptr, LINE_INFO());
+			Assert::IsTrue(s.Data() == arr + 2, nullptr, LINE_INFO());
+
+			s.AdvanceBy(3);
+			Assert::AreEqual(size_t(1), s.Size(), nullptr, LINE_INFO());
+			Assert::AreEqual(5, s.Front(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(ZipRandomAccess)
+		{
+			int as[] = { 0, 1, 2, 3, 4, 5 };
+			float bs[] = { 5, 4, 3, 2, 1, 0 };
+			auto r = Zip(Iota(), Range(as), Range(bs));
+			Assert::IsTrue(ranges::IsRandomAccessRange<decltype(r)>::value, nullptr, LINE_INFO());
+			Assert::IsFalse(ranges::IsContiguousRange<decltype(r)>::value, nullptr, LINE_INFO());
+
+			std::tuple<size_t, int&, float&> third = r[3];
+			Assert::AreEqual(size_t(3), std::get<0>(third), nullptr, LINE_INFO());
+			Assert::AreEqual(3, std::get<1>(third), nullptr, LINE_INFO());
+			Assert::AreEqual(2.0f, std::get<2>(third), nullptr, LINE_INFO());
+
+			auto s = r.Slice(1, 4);
+			Assert::AreEqual(size_t(3), s.Size(), nullptr, LINE_INFO());
+			size_t i = 1;
+			for (; !s.IsEmpty(); s.Advance(), ++i)
+			{
+				Assert::AreEqual(i, std::get<0>(s.Front()), nullptr, LINE_INFO());
+				Assert::AreEqual(as[i], std::get<1>(s.Front()), nullptr, LINE_INFO());
+			}
+			Assert::AreEqual(size_t(4), i, nullptr, LINE_INFO());
+
+			r.AdvanceBy(4);
+			Assert::AreEqual(size_t(2), r.Size(), nullptr, LINE_INFO());
+			Assert::AreEqual(1.0f, std::get<2>(r.Front()), nullptr, LINE_INFO());
+		}
+
 		TEST_METHOD(IterateRangeBased)
 		{
 			int arr[] = { 1, 2, 3, 4 };
@@ -192,6 +238,26 @@ namespace mu_core_tests_ranges
 			}
 		}
 
+		TEST_METHOD(TransformRandomAccess)
+		{
+			int arr[] = { 1, 2, 3, 4, 5 };
+			auto r = Transform(Range(arr), [](int a) { return a * 5; });
+			Assert::IsTrue(ranges::IsRandomAccessRange<decltype(r)>::value, nullptr, LINE_INFO());
+			Assert::IsFalse(ranges::IsContiguousRange<decltype(r)>::value, nullptr, LINE_INFO());
+			Assert::AreEqual(20, r[3], nullptr, LINE_INFO());
+
+			auto s = r.Slice(1, 3);
+			Assert::AreEqual(size_t(2), s.Size(), nullptr, LINE_INFO());
+			Assert::AreEqual(10, s.Front(), nullptr, LINE_INFO());
+
+			r.AdvanceBy(4);
+			Assert::AreEqual(25, r.Front(), nullptr, LINE_INFO());
+
+			auto infinite = Transform(Iota<int>(), [](int a) { return a * 2; });
+			Assert::IsTrue(ranges::IsRandomAccessRange<decltype(infinite)>::value, nullptr, LINE_INFO());
+			Assert::AreEqual(14, infinite[7], nullptr, LINE_INFO());
+		}
+
 		TEST_METHOD(TransformConstLambda)
 		{
 			const int arr[] = { 1, 2, 3, 4, 5 };
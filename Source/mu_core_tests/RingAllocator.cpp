@@ -0,0 +1,87 @@
+#include "CppUnitTest.h"
+#include "../mu/RingAllocator.h"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_ring_allocator
+{
+	using namespace mu;
+
+	TEST_CLASS(RingAllocatorTests)
+	{
+	public:
+		TEST_METHOD(AllocateInOrder)
+		{
+			RingAllocator ring(1024);
+			Assert::AreEqual(uint64_t(0), ring.Allocate(100, 1), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(128), ring.Allocate(100, 64), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(228), ring.Allocate(10, 4), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(238), ring.GetHead(), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(238), ring.GetUsedBytes(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(AllocateFailsUntilReleased)
+		{
+			RingAllocator ring(1000);
+			Assert::AreEqual(RingAllocator::InvalidOffset, ring.Allocate(1001, 1), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(0), ring.Allocate(600, 1), nullptr, LINE_INFO());
+			const uint64_t first_end = ring.GetHead();
+			Assert::AreEqual(uint64_t(600), ring.Allocate(300, 1), nullptr, LINE_INFO());
+			Assert::AreEqual(RingAllocator::InvalidOffset, ring.Allocate(200, 1), nullptr, LINE_INFO());
+
+			ring.Release(first_end);
+			Assert::AreEqual(uint64_t(300), ring.GetUsedBytes(), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(0), ring.Allocate(200, 1), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(WrapSkipsEnd)
+		{
+			// An allocation which doesn't fit before the end starts again at the beginning
+			RingAllocator ring(1024);
+			ring.Allocate(300, 1);
+			const uint64_t first_end = ring.GetHead();
+			ring.Allocate(600, 1);
+			ring.Release(first_end);
+			Assert::AreEqual(uint64_t(0), ring.Allocate(200, 1), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(1224), ring.GetHead(), nullptr, LINE_INFO());
+			Assert::AreEqual(uint64_t(924), ring.GetUsedBytes(), nullptr, LINE_INFO());
+			Assert::AreEqual(RingAllocator::InvalidOffset, ring.Allocate(101, 1), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(EmptyRingRestarts)
+		{
+			// Once everything is released the whole ring is available, wherever the last allocation ended
+			RingAllocator ring(1000);
+			ring.Allocate(600, 1);
+			ring.Release(ring.GetHead());
+			Assert::AreEqual(uint64_t(0), ring.Allocate(1000, 1), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(WrapAligned)
+		{
+			// Alignment applies to offsets into the space even when its size isn't a multiple of it
+			RingAllocator ring(1000);
+			ring.Allocate(300, 1);
+			ring.Release(ring.GetHead());
+			for (uint32_t i = 0; i < 10; ++i)
+			{
+				const uint64_t offset = ring.Allocate(200, 256);
+				Assert::AreNotEqual(RingAllocator::InvalidOffset, offset, nullptr, LINE_INFO());
+				Assert::AreEqual(uint64_t(0), offset % 256, nullptr, LINE_INFO());
+				ring.Release(ring.GetHead());
+			}
+		}
+
+		TEST_METHOD(ReleaseOutOfOrder)
+		{
+			RingAllocator ring(1000);
+			ring.Allocate(400, 1);
+			const uint64_t first_end = ring.GetHead();
+			ring.Allocate(400, 1);
+			const uint64_t second_end = ring.GetHead();
+			ring.Release(second_end);
+			ring.Release(first_end);
+			Assert::AreEqual(uint64_t(0), ring.GetUsedBytes(), nullptr, LINE_INFO());
+		}
+	};
+}
@@ -0,0 +1,130 @@
+#include "CppUnitTest.h"
+#include "../mu/ShaderArchive.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_shader_archive
+{
+	using namespace mu;
+
+	// Just enough of a SPIR-V module to pass for one, with some words to tell them apart
+	static Array<uint8_t> FakeSpirv(uint32_t id, uint32_t num_words)
+	{
+		Array<uint8_t> code = Array<uint8_t>::MakeUninitialized(num_words * 4);
+		const uint32_t magic = 0x07230203;
+		memcpy(code.Data(), &magic, 4);
+		for (uint32_t i = 1; i < num_words; ++i)
+		{
+			const uint32_t word = id * 1000 + i;
+			memcpy(code.Data() + i * 4, &word, 4);
+		}
+		return std::move(code);
+	}
+
+	static ranges::PointerRange<const uint8_t> ConstRange(const Array<uint8_t>& a)
+	{
+		return Range(a);
+	}
+
+	static bool SameCode(ranges::PointerRange<const uint8_t> code, const Array<uint8_t>& expected)
+	{
+		return code.Size() == expected.Num() && memcmp(code.Data(), expected.Data(), expected.Num()) == 0;
+	}
+
+	TEST_CLASS(ShaderArchiveTests)
+	{
+	public:
+		TEST_METHOD(FindByName)
+		{
+			Array<Array<uint8_t>> codes;
+			ShaderArchiveWriter writer;
+			for (uint32_t i = 0; i < 50; ++i)
+			{
+				codes.Add(FakeSpirv(i, 5 + i));
+				writer.Add(("shader" + std::to_string(i) + ".vert").c_str(), ConstRange(codes[i]));
+			}
+			const Array<uint8_t> data = writer.Build();
+
+			ShaderArchive archive;
+			Assert::IsTrue(archive.Open(ConstRange(data)), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(50), archive.GetNumShaders(), nullptr, LINE_INFO());
+			for (uint32_t i = 0; i < 50; ++i)
+			{
+				const std::string name = "shader" + std::to_string(i) + ".vert";
+				ShaderArchive::Shader shader;
+				Assert::IsTrue(archive.Find(name.c_str(), shader), nullptr, LINE_INFO());
+				Assert::IsTrue(shader.m_name == StringView(name.c_str()), nullptr, LINE_INFO());
+				Assert::IsTrue(SameCode(shader.m_code, codes[i]), nullptr, LINE_INFO());
+				Assert::AreEqual(size_t(0), size_t(shader.m_code.Data() - data.Data()) % 4, nullptr, LINE_INFO());
+			}
+
+			ShaderArchive::Shader missing;
+			Assert::IsFalse(archive.Find("shader50.vert", missing), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(IdenticalCodeStoredOnce)
+		{
+			const Array<uint8_t> shared = FakeSpirv(1, 64);
+			const Array<uint8_t> other = FakeSpirv(2, 64);
+			ShaderArchiveWriter writer;
+			writer.Add("a.frag", ConstRange(shared));
+			writer.Add("b.frag", ConstRange(other));
+			writer.Add("c.frag", ConstRange(shared));
+			Assert::AreEqual(size_t(3), writer.GetNumShaders(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(2), writer.GetNumBlobs(), nullptr, LINE_INFO());
+			const Array<uint8_t> data = writer.Build();
+
+			ShaderArchive archive;
+			Assert::IsTrue(archive.Open(ConstRange(data)), nullptr, LINE_INFO());
+			ShaderArchive::Shader a, b, c;
+			Assert::IsTrue(archive.Find("a.frag", a), nullptr, LINE_INFO());
+			Assert::IsTrue(archive.Find("b.frag", b), nullptr, LINE_INFO());
+			Assert::IsTrue(archive.Find("c.frag", c), nullptr, LINE_INFO());
+			Assert::IsTrue(a.m_code.Data() == c.m_code.Data(), nullptr, LINE_INFO());
+			Assert::AreEqual(a.m_content_hash, c.m_content_hash, nullptr, LINE_INFO());
+			Assert::AreNotEqual(a.m_content_hash, b.m_content_hash, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(RejectsBadInput)
+		{
+			ShaderArchiveWriter writer;
+			const Array<uint8_t> code = FakeSpirv(1, 8);
+			writer.Add("a.vert", ConstRange(code));
+			bool threw = false;
+			try
+			{
+				writer.Add("a.vert", ConstRange(code));
+			}
+			catch (const std::runtime_error&)
+			{
+				threw = true;
+			}
+			Assert::IsTrue(threw, nullptr, LINE_INFO());
+
+			Array<uint8_t> not_spirv = FakeSpirv(2, 8);
+			not_spirv[0] = 0;
+			threw = false;
+			try
+			{
+				writer.Add("b.vert", ConstRange(not_spirv));
+			}
+			catch (const std::runtime_error&)
+			{
+				threw = true;
+			}
+			Assert::IsTrue(threw, nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(1), writer.GetNumShaders(), nullptr, LINE_INFO());
+
+			// A truncated archive is rejected rather than read past its end
+			const Array<uint8_t> data = writer.Build();
+			ShaderArchive archive;
+			Assert::IsFalse(archive.Open(Range(data.Data(), data.Num() - 4)), nullptr, LINE_INFO());
+			Assert::IsFalse(archive.Open(Range(code.Data(), code.Num())), nullptr, LINE_INFO());
+			Assert::IsTrue(archive.Open(ConstRange(data)), nullptr, LINE_INFO());
+		}
+	};
+}
@@ -0,0 +1,103 @@
+#include "CppUnitTest.h"
+#include "../mu/StreamRange.h"
+#include "../mu/Algorithms.h"
+
+#include <cstdio>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace mu_core_tests_stream_range
+{
+	using namespace mu;
+
+	static const char* TestFilePath = "mu_core_tests_stream_range.bin";
+
+	static void WriteTestFile(size_t size)
+	{
+		FILE* f = fopen(TestFilePath, "wb");
+		for (size_t i = 0; i < size; ++i)
+		{
+			fputc(int(i % 251), f);
+		}
+		fclose(f);
+	}
+
+	TEST_CLASS(StreamRangeTests)
+	{
+	public:
+		TEST_METHOD_CLEANUP(MethodCleanup)
+		{
+			remove(TestFilePath);
+		}
+
+		TEST_METHOD(ChunkContents)
+		{
+			const size_t size = 1000000 + 123;
+			WriteTestFile(size);
+
+			size_t offset = 0;
+			size_t num_chunks = 0;
+			Map(StreamRange::Open(TestFilePath, 65536), [&](ranges::PointerRange<const uint8_t> chunk)
+			{
+				Assert::IsTrue(chunk.Size() == 65536 || offset + chunk.Size() == size, nullptr, LINE_INFO());
+				for (uint8_t b : chunk)
+				{
+					Assert::AreEqual(uint8_t(offset % 251), b, nullptr, LINE_INFO());
+					++offset;
+				}
+				++num_chunks;
+			});
+			Assert::AreEqual(size, offset, nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(16), num_chunks, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(TransformChunks)
+		{
+			WriteTestFile(10000);
+
+			size_t total = 0;
+			for (size_t chunk_size : Transform(StreamRange::Open(TestFilePath, 4096), [](ranges::PointerRange<const uint8_t> chunk) { return chunk.Size(); }))
+			{
+				total += chunk_size;
+			}
+			Assert::AreEqual(size_t(10000), total, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(SmallAndEmptyFiles)
+		{
+			WriteTestFile(10);
+			StreamRange small = StreamRange::Open(TestFilePath);
+			Assert::IsFalse(small.IsEmpty(), nullptr, LINE_INFO());
+			Assert::AreEqual(size_t(10), small.Front().Size(), nullptr, LINE_INFO());
+			small.Advance();
+			Assert::IsTrue(small.IsEmpty(), nullptr, LINE_INFO());
+
+			WriteTestFile(0);
+			Assert::IsTrue(StreamRange::Open(TestFilePath).IsEmpty(), nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(MissingFile)
+		{
+			bool threw = false;
+			try
+			{
+				StreamRange::Open("mu_core_tests_no_such_file.bin");
+			}
+			catch (const std::runtime_error&)
+			{
+				threw = true;
+			}
+			Assert::IsTrue(threw, nullptr, LINE_INFO());
+		}
+
+		TEST_METHOD(StopEarly)
+		{
+			// Destroying the range mid file stops the read ahead thread
+			WriteTestFile(100000);
+			StreamRange stream = StreamRange::Open(TestFilePath, 1000);
+			auto found = Find(stream, [](ranges::PointerRange<const uint8_t> chunk) { return chunk[0] == 3000 % 251; });
+			Assert::IsFalse(found.IsEmpty(), nullptr, LINE_INFO());
+			Assert::AreEqual(uint8_t(3999 % 251), found.Front()[999], nullptr, LINE_INFO());
+		}
+	};
+}
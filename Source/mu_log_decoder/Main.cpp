@@ -0,0 +1,33 @@
+#include "../mu/BinaryLog.h"
+#include "../mu/MappedFile.h"
+
+#include <cstdio>
+
+// Prints a binary log written by mu::dbg::OpenBinaryLog as text, one message per line:
+//	<seconds since the log was opened> <file>:<line> <message>
+int main(int argc, char** argv)
+{
+	if (argc != 2)
+	{
+		fprintf(stderr, "Usage: mu_log_decoder <log file>\n");
+		return 1;
+	}
+
+	MappedFile file = MappedFile::Open(argv[1], FileAccessHint::Sequential);
+	if (!file.IsValidFile())
+	{
+		fprintf(stderr, "Failed to open %s\n", argv[1]);
+		return 1;
+	}
+
+	bool ok = mu::dbg::DecodeBinaryLog(file.GetRange(), [](const mu::dbg::DecodedLogMessage& message)
+	{
+		printf("%.6f %s:%u %s\n", message.m_seconds, message.m_file.c_str(), message.m_line, message.m_text.c_str());
+	});
+	if (!ok)
+	{
+		fprintf(stderr, "%s is not a binary log\n", argv[1]);
+		return 1;
+	}
+	return 0;
+}
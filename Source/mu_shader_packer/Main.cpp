@@ -0,0 +1,64 @@
+#include "../mu/FileReader.h"
+#include "../mu/ShaderArchive.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// The name ShaderLibrary finds a shader by, its file name without the .spv extension,
+//	so ../Shaders/Bin/shader.vert.spv is shader.vert
+static mu::StringView ShaderName(const char* path)
+{
+	const char* name = path;
+	for (const char* c = path; *c; ++c)
+	{
+		if (*c == '/' || *c == '\\')
+		{
+			name = c + 1;
+		}
+	}
+	size_t size = strlen(name);
+	if (size > 4 && strcmp(name + size - 4, ".spv") == 0)
+	{
+		size -= 4;
+	}
+	return mu::StringView(name, size);
+}
+
+// Packs compiled SPIR-V files into one archive for mu::vk::ShaderLibrary, run by the shader build
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: mu_shader_packer <archive> <spv files...>\n");
+		return 1;
+	}
+
+	try
+	{
+		mu::ShaderArchiveWriter writer;
+		for (int i = 2; i < argc; ++i)
+		{
+			Array<uint8_t> code;
+			try
+			{
+				code = LoadFileToArray(argv[i]);
+			}
+			catch (const std::runtime_error& e)
+			{
+				throw std::runtime_error(std::string(argv[i]) + ": " + e.what());
+			}
+			writer.Add(ShaderName(argv[i]), mu::Range(code));
+		}
+		const Array<uint8_t> archive = writer.Build();
+		SaveFileAtomically(argv[1], mu::Range(archive));
+		printf("Packed %zu shaders, %zu unique, into %s\n", writer.GetNumShaders(), writer.GetNumBlobs(), argv[1]);
+	}
+	catch (const std::exception& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+	return 0;
+}